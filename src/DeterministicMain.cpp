@@ -51,7 +51,19 @@ int solveDeterministic(InputPaths inputPaths, double timeout) {
 	//
 	std::cout << "# SOLVE THE INSTANCE" << std::endl;
 	DeterministicSolver* pSolver = new DeterministicSolver(pScenario,inputPaths);
-	double objValue = pSolver->solve();
+
+	// load the solution of a previous run if requested: the solution process
+	// then directly improves it
+	//
+	vector<Roster> initialSolution;
+	if (!inputPaths.initialSolutionPath().empty()) {
+		vector<string> initialSolutionFiles;
+		for (int w=0; w < inputPaths.nbWeeks(); w++) {
+			initialSolutionFiles.push_back(inputPaths.initialSolutionWeek(w));
+		}
+		initialSolution = ReadWrite::readSolutionMultipleWeeks(initialSolutionFiles, pScenario);
+	}
+	double objValue = pSolver->solve(initialSolution);
 	std::cout << std::endl;
 
 	// Display the solution and write the files for the validator
@@ -71,11 +83,13 @@ int solveDeterministic(InputPaths inputPaths, double timeout) {
 	string statPath = inputPaths.solutionPath().empty() ? "" : inputPaths.solutionPath()+"/stat.txt";
 	Tools::LogOutput statStream(statPath);
 	statStream << pSolver->getGlobalStat().toString() << std::endl;
+	pSolver->logStats();
 
 	if (pSolver->getOptions().withLNS_) {
 		string lnsStatPath = inputPaths.solutionPath().empty() ? "" : inputPaths.solutionPath()+"/lns_stat.txt";
 		Tools::LogOutput lnsStatStream(lnsStatPath);
 		lnsStatStream << pSolver->getGlobalStat().lnsStatsToString() << std::endl;
+		lnsStatStream << pSolver->getGlobalStat().lnsThroughputToString() << std::endl;
 		lnsStatStream.close();
 	}
 
@@ -121,6 +135,30 @@ int main(int argc, char** argv)
 		if (!strcmp(argv[2], "divide")) {
 			testDivideIntoConnexComponents();
 		}
+		else if (!strcmp(argv[2], "parse")) {
+			return benchmarkInstanceParser() ? 0 : 1;
+		}
+		else if (!strcmp(argv[2], "graph")) {
+			return benchmarkSubProblemGraphs() ? 0 : 1;
+		}
+		else if (!strcmp(argv[2], "screening")) {
+			return testGreedyScreening() ? 0 : 1;
+		}
+		else if (!strcmp(argv[2], "localsearch")) {
+			return testLocalSearch() ? 0 : 1;
+		}
+		else if (!strcmp(argv[2], "solutionlog")) {
+			return testSolutionLog() ? 0 : 1;
+		}
+		else if (!strcmp(argv[2], "demands")) {
+			return testDemandGenerator() ? 0 : 1;
+		}
+		else if (!strcmp(argv[2], "costs")) {
+			return testCostEvaluator() ? 0 : 1;
+		}
+		else if (!strcmp(argv[2], "rosterbits")) {
+			return testRosterBits() ? 0 : 1;
+		}
 
 		return 0;
 	}
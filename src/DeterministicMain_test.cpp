@@ -8,7 +8,13 @@
 
 #include "solvers/InitializeSolver.h"
 #include "tools/ReadWrite.h"
+#include "tools/InstanceParser.h"
+#include "tools/SolutionLog.h"
+#include "tools/DemandGenerator.h"
 #include "solvers/DeterministicSolver.h"
+#include "solvers/StochasticSolver.h"
+#include "solvers/Greedy.h"
+#include "solvers/mp/rcspp/SubProblemShort.h"
 #include "tools/MyTools.h"
 
 // some include files to go through the files of an input directory
@@ -16,6 +22,12 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <sstream>
 
 
 using std::string;
@@ -57,3 +69,1264 @@ bool testDivideIntoConnexComponents() {
 
 	return true;
 }
+
+// Read the scenario file with the file streams
+// This is the reader that was used before the instance parser: it is kept as
+// a reference for the tests of the parser
+//
+static PScenario readScenarioWithStreams(string fileName) {
+	// open the file
+	std::fstream file;
+	file.open(fileName.c_str(), std::fstream::in);
+	if (!file.is_open()) {
+		std::cout << "While trying to read the file " << fileName << std::endl;
+		std::cout << "The input file was not opened properly!" << std::endl;
+
+		throw Tools::myException("The input file was not opened properly!",__LINE__);
+	}
+
+	string title;
+	string strTmp;
+	int intTmp;
+	// declare the attributes that will initialize the Scenario instance
+	//
+	string name;
+	int nbWeeks=-1, nbSkills=-1, nbShifts=-1, nbShiftsType=-1, nbContracts=-1, nbNurses=-1;
+	vector<string> intToSkill, intToShift, intToShiftType, intToContract;
+	map<string,int> skillToInt, shiftToInt, shiftTypeToInt, nurseNameToInt;
+	vector<int> minConsShiftType, maxConsShiftType, nbForbiddenSuccessors, hoursInShift, shiftIDToShiftTypeID;
+        vector2D<int> shiftTypeIDToShiftID;
+	vector2D<int> forbiddenSuccessors;
+	map<string,PConstContract> contracts;
+	vector<PNurse> theNurses;
+
+	bool  foundShift = false;
+
+	// fill the attributes of the scenario structure
+	//
+	while(file.good()){
+		ReadWrite::readUntilChar(file, '=', title);
+
+		// Read the name of the scenario
+		//
+		if(ReadWrite::strEndsWith(title, "SCENARIO ")){
+			file >> name;
+		}
+
+		// Read the number of weeks in scenario
+		//
+		else if (ReadWrite::strEndsWith(title, "WEEKS ")) {
+			file >> nbWeeks;
+		}
+
+		// Read the number of weeks in scenario
+		//
+		else if (ReadWrite::strEndsWith(title, "SKILLS ")) {
+			file >> nbSkills;
+			for(int i=0; i<nbSkills; i++){
+				file >> strTmp;
+				intToSkill.push_back(strTmp);
+				skillToInt.insert(pair<string,int>(strTmp,i));
+			}
+		}
+
+		// Read the different shift types and forbidden successions
+		//
+		else if (ReadWrite::strEndsWith(title, "SHIFT_TYPES ")) {
+
+			// Number of shifts : Given number + REST_SHIFT
+			file >> intTmp;
+			nbShiftsType = intTmp+1;
+
+			// IMPORTANT : INSERT REST SHIFT !!!!!!
+			// It is given 0 and 99 as bounds so that they never perturbate the cost
+			//
+			intToShiftType.push_back(REST_SHIFT);
+			shiftTypeToInt.insert(pair<string,int>(REST_SHIFT,0));
+			minConsShiftType.push_back(0);
+			maxConsShiftType.push_back(99);
+
+			// Other shift types
+			//
+			for(int i=1; i<nbShiftsType; i++){
+				// Name
+				file >> strTmp;
+				intToShiftType.push_back(strTmp);
+				shiftTypeToInt.insert(pair<string,int>(strTmp,i));
+				ReadWrite::readUntilChar(file,'(',strTmp);
+				// Min consecutive
+				file >> intTmp;
+				minConsShiftType.push_back(intTmp);
+				ReadWrite::readUntilChar(file, ',', strTmp);
+				// Max consecutive
+				file >> intTmp;
+				maxConsShiftType.push_back(intTmp);
+				ReadWrite::readUntilChar(file,'\n',strTmp);
+			}
+
+
+			// Forbidden successions
+			//
+			for(int i=0; i<nbShiftsType; i++){
+				vector<int> v;
+				forbiddenSuccessors.push_back(v);
+				nbForbiddenSuccessors.push_back(0);
+			}
+			while(!ReadWrite::strEndsWith(title,"FORBIDDEN_SHIFT_TYPES_SUCCESSIONS"))
+				file >> title;
+			// Reading all lines
+			for(int i=1; i<nbShiftsType; i++){
+				// Which current shift type ?
+				string currentShiftType;
+				file >> currentShiftType;
+				int currentShiftTypeId = shiftTypeToInt.at(currentShiftType);
+				// How many forbidden after it ?
+				file >> intTmp;
+				nbForbiddenSuccessors[currentShiftTypeId] = intTmp;
+				// Which ones are forbidden ?
+				for(int j=0; j<nbForbiddenSuccessors[currentShiftTypeId]; j++){
+					file >> strTmp;
+					forbiddenSuccessors[currentShiftTypeId].push_back(shiftTypeToInt.at(strTmp));
+				}
+				ReadWrite::readUntilChar(file,'\n',strTmp);
+
+			}
+		}
+
+		// Read the different shifts
+		//
+		else if (ReadWrite::strEndsWith(title, "SHIFTS ")) {
+		  foundShift = true;
+
+			// IMPORTANT : INSERT REST SHIFT !!!!!!
+			//
+			intToShift.push_back(REST_SHIFT);
+			shiftToInt.insert(pair<string,int>(REST_SHIFT,0));
+			hoursInShift.push_back(0);
+			int currentShiftTypeId = shiftTypeToInt.at(REST_SHIFT);
+			shiftIDToShiftTypeID.push_back(currentShiftTypeId);
+
+			shiftTypeIDToShiftID.resize(nbShiftsType);
+			shiftTypeIDToShiftID[0].push_back(0);
+	
+			// Number of shifts 
+			file >> intTmp;
+			nbShifts = intTmp+1;
+
+			// Shifts
+			//
+			for(int i=1; i<nbShifts; i++){
+				// Name
+				file >> strTmp;
+				intToShift.push_back(strTmp);
+				shiftToInt.insert(pair<string,int>(strTmp,i));
+
+				int hours;
+				file >> hours;
+				hoursInShift.push_back(hours);
+
+				string  currentShiftType;
+				file >> currentShiftType;
+
+				int currentShiftTypeId = shiftTypeToInt.at(currentShiftType);
+				shiftIDToShiftTypeID.push_back(currentShiftTypeId);
+				shiftTypeIDToShiftID[currentShiftTypeId].push_back(i);
+			}
+		}
+
+		// Read the different contracts type
+		//
+		else if (ReadWrite::strEndsWith(title, "CONTRACTS ")) {
+			file >> intTmp;
+			nbContracts = intTmp;
+			// Read each contract type
+			for(int i=0; i<nbContracts; i++){
+				string contractName;
+				int minDays, maxDays, minConsWork, maxConsWork, minConsRest, maxConsRest, maxWeekends, isTotalWeekend;
+				file >> contractName;
+				ReadWrite::readUntilChar(file,'(',strTmp);
+				file >> minDays;
+				ReadWrite::readUntilChar(file,',',strTmp);
+				file >> maxDays;
+				ReadWrite::readUntilChar(file,'(',strTmp);
+				file >> minConsWork;
+				ReadWrite::readUntilChar(file,',',strTmp);
+				file >> maxConsWork;
+				ReadWrite::readUntilChar(file,'(',strTmp);
+				file >> minConsRest;
+				ReadWrite::readUntilChar(file,',',strTmp);
+				file >> maxConsRest;
+				ReadWrite::readUntilChar(file,' ',strTmp);
+				file >> maxWeekends;
+				ReadWrite::readUntilChar(file,' ',strTmp);
+				file >> isTotalWeekend;
+				ReadWrite::readUntilChar(file,'\n',strTmp);
+
+        PConstContract pContract =
+            std::make_shared<Contract>(i, contractName, minDays, maxDays, minConsWork, maxConsWork,
+                minConsRest, maxConsRest, maxWeekends, isTotalWeekend);
+				contracts[contractName] = pContract;
+				intToContract.push_back(contractName);
+			}
+		}
+
+		// Read all nurses
+		//
+		else if (ReadWrite::strEndsWith(title, "NURSES ")) {
+			file >> nbNurses;
+			for(int i=0; i<nbNurses; i++){
+				string nurseName, contractName;
+				int nbSkills;
+				vector<int> skills;
+				// Read everything on the line
+				file >> nurseName;
+				file >> contractName;
+				file >> nbSkills;
+				for(int j=0; j<nbSkills; j++){
+					file >> strTmp;
+					skills.push_back(skillToInt.at(strTmp));
+				}
+				// sort the skill indices before initializing the nurse
+				std::sort (skills.begin(), skills.end());
+
+				theNurses.emplace_back(std::make_shared<Nurse>(i, nurseName, nbSkills, skills, contracts.at(contractName)));
+				nurseNameToInt.insert(pair<string,int>(nurseName,i));
+			}
+
+		}
+	}
+
+	//  to be backward compatible with old style of input file (without the SHIFTS section)
+	//  set default shifts
+	
+	if (!foundShift) {
+	  nbShifts=nbShiftsType;
+    intToShift = intToShiftType;
+    shiftToInt = shiftTypeToInt;
+    shiftTypeIDToShiftID.resize(nbShiftsType);
+    for(int i=0; i<nbShiftsType; i++){
+	    hoursInShift.push_back(1); // 1 as default (could be days, hours, ...)
+	    shiftIDToShiftTypeID.push_back(i);
+      shiftTypeIDToShiftID[i].push_back(i);
+	  }
+	}
+
+	// Check that all fields were initialized before initializing the scenario
+	//
+	if ( nbWeeks==-1 || nbSkills==-1 || nbShifts==-1 || nbContracts==-1 || nbNurses==-1 ) {
+		Tools::throwError("In readScenario: missing fields in the initialization");
+	}
+
+	return std::make_shared<Scenario>(name, nbWeeks, nbSkills, intToSkill, skillToInt, nbShifts,
+			    intToShift, shiftToInt, hoursInShift, shiftIDToShiftTypeID,
+			    nbShiftsType, intToShiftType, shiftTypeToInt, shiftTypeIDToShiftID, 
+			    minConsShiftType, maxConsShiftType, nbForbiddenSuccessors,forbiddenSuccessors,
+			    nbContracts, intToContract, contracts, nbNurses, theNurses, nurseNameToInt) ;
+}
+
+// Read the Week file with the file streams (reference for the tests of the parser)
+//
+static void readWeekWithStreams(std::string strWeekFile, PScenario pScenario,
+  PDemand* pDemand, PPreferences* pPref){
+	// open the file
+	std::fstream file;
+	file.open(strWeekFile.c_str(), std::fstream::in);
+	if (!file.is_open()) {
+		std::cout << "While trying to read the file " << strWeekFile << std::endl;
+		std::cout << "The input file was not opened properly!" << std::endl;
+		throw Tools::myException("The input file was not opened properly!",__LINE__);
+	}
+
+	string title;
+	string strTmp;
+	int intTmp;
+
+	// declare the attributes to be updated in the PScenario
+	//
+	string weekName;
+	vector3D<int> minWeekDemand;
+	vector3D<int> optWeekDemand;
+
+
+	// fill the attributes when reading the week file
+	//
+	while(file.good()){
+		ReadWrite::readUntilOneOfTwoChar(file, '\n', '=', title);
+
+		// Read the name of the week
+		//
+		if(ReadWrite::strEndsWith(title, "WEEK_DATA")){
+			file >> weekName;
+		}
+
+		// Read the requirements
+		//
+		else if (ReadWrite::strEndsWith(title, "REQUIREMENTS")) {
+			string shiftName, skillName;
+			int shiftId, skillId;
+			// init the vectors
+			Tools::initVector3D(minWeekDemand, 7, pScenario->nbShifts_, pScenario->nbSkills_, 0);
+			Tools::initVector3D(optWeekDemand, 7, pScenario->nbShifts_, pScenario->nbSkills_, 0);
+
+			// Do not take the rest shift into account here (by initialization, requirements already at 0
+			for(int i=1; i<pScenario->nbShifts_; i++){
+				for(int j=0; j<pScenario->nbSkills_; j++){
+					// Read shift and skill
+					file >> shiftName;
+					file >> skillName;
+					shiftId = pScenario->shiftToInt_.at(shiftName);
+					skillId = pScenario->skillToInt_.at(skillName);
+					// For every day in the week, read min and opt values
+					for (int day = 0; day<7; day++){
+						ReadWrite::readUntilChar(file,'(',strTmp);
+						file >> intTmp;
+						minWeekDemand[day][shiftId][skillId] = intTmp;
+						ReadWrite::readUntilChar(file,',',strTmp);
+						file >> intTmp;
+						optWeekDemand[day][shiftId][skillId] = intTmp;
+					}
+					ReadWrite::readUntilChar(file,')',strTmp);
+				}
+			}
+		}
+
+		// Read the shift off requests
+		//
+		else if(ReadWrite::strEndsWith(title,"SHIFT_OFF_REQUESTS ")){
+      if(!*pPref)
+        *pPref = std::make_shared<Preferences>(pScenario->nbNurses_, 7, pScenario->nbShifts_);
+			// Temporary vars
+			string nurseName, shift, day, strLevel;
+			int nbShifts, nurseId, dayId;
+			PREF_LEVEL level = WEAK;
+			file >> nbShifts;
+			for (int i=0; i<nbShifts; i++){
+				if(nurseName.empty())
+				  file >> nurseName;
+        nurseId = pScenario->nurseNameToInt_.at(nurseName);
+        nurseName.clear();
+				file >> shift;
+				file >> day;
+        dayId = Tools::dayToInt(day);
+				// in case there is no level defined for the preferences
+        file >> strLevel;
+        try {
+          level = (PREF_LEVEL) std::stoi(strLevel);
+        } catch (const std::invalid_argument&) { // has read the next line: strLevel contains the next nurse name
+          nurseName = strLevel;
+        }
+
+				if(shift == "Any")
+				  (*pPref)->addDayOff(nurseId, dayId, level);
+				else {
+					// shiftId = pScenario->shiftTypeToInt_.at(shift);
+					int shiftId = pScenario->shiftToInt_.at(shift);
+					(*pPref)->addShiftOff(nurseId, dayId, shiftId, level);
+				}
+			}
+		}
+
+		// Read the shift on requests
+		//
+		else if(ReadWrite::strEndsWith(title,"SHIFT_ON_REQUESTS ")){
+			if(!*pPref)
+			  *pPref = std::make_shared<Preferences>(pScenario->nbNurses_, 7, pScenario->nbShifts_);
+			// Temporary vars
+      string nurseName, shift, day, strLevel;
+      int nbShifts, nurseId, dayId;
+      PREF_LEVEL level = WEAK;
+      file >> nbShifts;
+      for (int i=0; i<nbShifts; i++){
+        if(nurseName.empty())
+          file >> nurseName;
+        nurseId = pScenario->nurseNameToInt_.at(nurseName);
+        nurseName.clear();
+        file >> shift;
+        file >> day;
+        dayId = Tools::dayToInt(day);
+        // in case there is no level defined for the preferences
+        file >> strLevel;
+        try {
+          level = (PREF_LEVEL) std::stoi(strLevel);
+        } catch (const std::invalid_argument&) { // has read the next line: strLevel contains the next nurse name
+          nurseName = strLevel;
+        }
+
+				if(shift == "Any")
+				  (*pPref)->addDayOn(nurseId, dayId, level);
+				else {
+					// shiftId = pScenario->shiftTypeToInt_.at(shift);
+					int shiftId = pScenario->shiftToInt_.at(shift);
+					(*pPref)->addShiftOn(nurseId, dayId, shiftId, level);
+				}
+			}
+		}
+	}
+
+	// Define a new instance of demand
+	*pDemand = std::make_shared<Demand>(7, 0, pScenario->nbShifts_,pScenario->nbSkills_, weekName,
+		minWeekDemand, optWeekDemand);
+
+	// Now, add all these objects to the Scenario
+  //  pScenario->linkWithDemand(pDemand);
+  //  pScenario->linkWithPreferences(weekPreferences);
+
+	// return the demand
+  //  return pDemand;
+
+}
+
+// Read the history file with the file streams (reference for the tests of the parser)
+//
+static void readHistoryWithStreams(std::string strHistoryFile, PScenario pScenario){
+	// open the file
+	std::fstream file;
+	file.open(strHistoryFile.c_str(), std::fstream::in);
+	if (!file.is_open()) {
+		std::cout << "While trying to read " << strHistoryFile << std::endl;
+		Tools::throwError("The input file was not opened properly!");
+	}
+
+	string title;
+	string strTmp;
+
+	// declare the attributes to be updated in the PScenario
+	//
+	int thisWeek;
+	string weekName;
+	vector<State> initialState;
+
+
+	// fill the attributes of the week structure
+	//
+	while(file.good()){
+		ReadWrite::readUntilChar(file,'\n', title);
+
+		// Read the index and name of the week
+		//
+		if(!strcmp(title.c_str(), "HISTORY")){
+			file >> thisWeek;
+			file >> weekName;
+			// Raise exception if it does not match the week previously read !
+			if (strcmp(weekName.c_str(),(pScenario->weekName()).c_str())) {
+				std::cout << "The given history file requires week " << weekName << std::endl;
+				std::cout << " but a different one (" << pScenario->weekName() << ") has been given!" << std::endl;
+				Tools::throwError("History file and week data file do not match!");
+			}
+		}
+
+		// Read each nurse's initial state
+		//
+		else if (ReadWrite::strEndsWith(title, "NURSE_HISTORY")) {
+			for(int n=0; n<pScenario->nbNurses_; n++){
+				string nurseName, shiftTypeName;
+				// int nurseId;
+				int shiftTypeId, totalTimeWorked, totalWeekendsWorked, consDaysWorked, consShiftWorked, consRest, consShifts;
+				file >> nurseName;
+				// nurseId = pScenario->nurseNameToInt_.at(nurseName);
+				file >> totalTimeWorked;
+				file >> totalWeekendsWorked;
+				file >> shiftTypeName;
+				shiftTypeId = pScenario->shiftTypeToInt_.at(shiftTypeName);
+				file >> consShiftWorked;
+				file >> consDaysWorked;
+				file >> consRest;
+
+				if(consRest == 0 && consDaysWorked == 0)
+                    Tools::throwError("History of nurse " + nurseName + " is invalid as one must either work or rest.");
+
+				int  shiftID = pScenario->shiftTypeIDToShiftID_[shiftTypeId].front();
+				consShifts = (shiftTypeId == 0) ? consRest : consShiftWorked;
+				State nurseState (0, totalTimeWorked, totalWeekendsWorked,
+						  consDaysWorked, consShifts, consRest, shiftTypeId, shiftID);
+				initialState.push_back(nurseState);
+			}
+		}
+	}
+	pScenario->setThisWeek(thisWeek);
+	pScenario->setInitialState(initialState);
+}
+
+// Read all the files of an instance directory and return a description of
+// everything that was read, so that two readers can be compared
+// The files are read with the instance parser or with the file streams
+//
+string readInstanceDirectory(string inputDir, string instanceName, bool withStreams) {
+	// retrieve the week and history files of the directory
+	vector<string> weekFiles, historyFiles;
+	DIR *dp = opendir(inputDir.c_str());
+	if (dp == NULL) Tools::throwError("readInstanceDirectory: cannot open "+inputDir);
+	struct dirent *dirp;
+	while ((dirp = readdir(dp))) {
+		string filename(dirp->d_name);
+		if (!filename.compare(0, 2, "WD")) weekFiles.push_back(inputDir+"/"+filename);
+		else if (!filename.compare(0, 1, "H")) historyFiles.push_back(inputDir+"/"+filename);
+	}
+	closedir(dp);
+	std::sort(weekFiles.begin(), weekFiles.end());
+	std::sort(historyFiles.begin(), historyFiles.end());
+
+	std::stringstream rep;
+	string scenFile = inputDir+"/Sc-"+instanceName+".txt";
+	PScenario pScen = withStreams ? readScenarioWithStreams(scenFile) : InstanceParser().readScenario(scenFile);
+	InstanceParser parser(pScen);
+
+	for (const string& weekFile: weekFiles) {
+		PDemand pDemand;
+		PPreferences pPref;
+		if (withStreams) readWeekWithStreams(weekFile, pScen, &pDemand, &pPref);
+		else parser.readWeek(weekFile, &pDemand, &pPref);
+		rep << pDemand->toString(true) << pPref->toString(pScen);
+
+		// the history files are checked against the name of the linked week
+		if (weekFile == weekFiles.front()) {
+			pScen->linkWithDemand(pDemand);
+			pScen->linkWithPreferences(pPref);
+		}
+	}
+	rep << pScen->toString();
+
+	for (const string& historyFile: historyFiles) {
+		if (withStreams) readHistoryWithStreams(historyFile, pScen);
+		else parser.readHistory(historyFile);
+		rep << pScen->thisWeek() << std::endl;
+		for (State& state: *pScen->pInitialState()) rep << state.toString() << std::endl;
+	}
+
+	return rep.str();
+}
+
+// Compare the instance parser with the readers based on the file streams on
+// all the instances of the datasets and measure the time taken by each reader
+//
+bool benchmarkInstanceParser() {
+
+	string dataDir = "datasets/";
+	int nbRepetitions = 10;
+
+	// retrieve the instance directories
+	vector<string> instances;
+	DIR *dp = opendir(dataDir.c_str());
+	if (dp == NULL) Tools::throwError("benchmarkInstanceParser: cannot open "+dataDir);
+	struct dirent *dirp;
+	while ((dirp = readdir(dp))) {
+		string name(dirp->d_name);
+		if (name[0] != '.') instances.push_back(name);
+	}
+	closedir(dp);
+	std::sort(instances.begin(), instances.end());
+
+	bool isSame = true;
+	double totalStreams = 0, totalParser = 0;
+	for (const string& instanceName: instances) {
+		string inputDir = dataDir+instanceName;
+
+		// both readers must read exactly the same objects
+		string withStreams = readInstanceDirectory(inputDir, instanceName, true);
+		string withParser = readInstanceDirectory(inputDir, instanceName, false);
+		if (withStreams != withParser) {
+			std::cout << "The instance parser does not read the same objects as the streams for "
+				<< instanceName << std::endl;
+			isSame = false;
+		}
+
+		Tools::Timer timerStreams, timerParser;
+		timerStreams.init();
+		timerStreams.start();
+		for (int i = 0; i < nbRepetitions; i++) readInstanceDirectory(inputDir, instanceName, true);
+		timerStreams.stop();
+		timerParser.init();
+		timerParser.start();
+		for (int i = 0; i < nbRepetitions; i++) readInstanceDirectory(inputDir, instanceName, false);
+		timerParser.stop();
+
+		double timeStreams = timerStreams.dSinceInit()/nbRepetitions;
+		double timeParser = timerParser.dSinceInit()/nbRepetitions;
+		totalStreams += timeStreams;
+		totalParser += timeParser;
+		std::cout << instanceName << ": streams " << 1000*timeStreams << " ms, parser "
+			<< 1000*timeParser << " ms, speedup " << timeStreams/timeParser << std::endl;
+	}
+
+	std::cout << "TOTAL: streams " << 1000*totalStreams << " ms, parser " << 1000*totalParser
+		<< " ms, speedup " << totalStreams/totalParser << std::endl;
+	if (isSame) std::cout << "The instance parser reads the same objects as the streams" << std::endl;
+
+	return isSame;
+}
+
+// Copy of the input scenario with nbShiftTypes working shift types of
+// nbShiftsPerType shifts each: as in the instances of the INRC-II, a shift type
+// cannot be followed by the previous shift types
+//
+PScenario buildScenarioWithManyShifts(PScenario pScenario, int nbShiftTypes, int nbShiftsPerType) {
+	vector<string> intToShiftType = {REST_SHIFT}, intToShift = {REST_SHIFT};
+	map<string,int> shiftTypeToInt = {{REST_SHIFT, 0}}, shiftToInt = {{REST_SHIFT, 0}};
+	vector<int> hoursToWork = {0}, shiftIDToShiftTypeID = {0};
+	vector2D<int> shiftTypeIDToShiftID = {{0}};
+	vector<int> minConsShiftType = {0}, maxConsShiftType = {99};
+	vector<int> nbForbiddenSuccessors = {0};
+	vector2D<int> forbiddenSuccessors = {{}};
+
+	for (int t = 1; t <= nbShiftTypes; t++) {
+		string shiftType = "T"+std::to_string(t);
+		shiftTypeToInt[shiftType] = t;
+		intToShiftType.push_back(shiftType);
+		minConsShiftType.push_back(2);
+		maxConsShiftType.push_back(5);
+		nbForbiddenSuccessors.push_back(t-1);
+		forbiddenSuccessors.push_back(vector<int>());
+		for (int prev = 1; prev < t; prev++) forbiddenSuccessors.back().push_back(prev);
+
+		shiftTypeIDToShiftID.push_back(vector<int>());
+		for (int i = 0; i < nbShiftsPerType; i++) {
+			string shift = shiftType+"_"+std::to_string(i);
+			shiftToInt[shift] = intToShift.size();
+			shiftTypeIDToShiftID.back().push_back(intToShift.size());
+			intToShift.push_back(shift);
+			hoursToWork.push_back(1);
+			shiftIDToShiftTypeID.push_back(t);
+		}
+	}
+
+	vector<PNurse> theNurses = pScenario->theNurses_;
+	return std::make_shared<Scenario>(pScenario->name_, pScenario->nbWeeks_,
+		pScenario->nbSkills_, pScenario->intToSkill_, pScenario->skillToInt_,
+		intToShift.size(), intToShift, shiftToInt, hoursToWork, shiftIDToShiftTypeID,
+		intToShiftType.size(), intToShiftType, shiftTypeToInt, shiftTypeIDToShiftID,
+		minConsShiftType, maxConsShiftType, nbForbiddenSuccessors, forbiddenSuccessors,
+		pScenario->nbContracts_, pScenario->intToContract_, pScenario->contracts_,
+		pScenario->nbNurses_, theNurses, pScenario->nurseNameToInt_);
+}
+
+// Measure the time taken to build the graphs of the short subproblems of every
+// contract when the number of shifts increases
+//
+bool benchmarkSubProblemGraphs() {
+
+	string dataDir = "datasets/", instanceName = "n030w4";
+	vector<int> weekIndices = {6, 2, 9, 1};
+	int nbRepetitions = 5;
+
+	PScenario pScenario = initializeMultipleWeeks(dataDir, instanceName, 1, weekIndices);
+	int nbDays = 7*weekIndices.size();
+
+	for (int nbShiftTypes: {3, 5, 8, 12}) {
+		PScenario pScenarioShifts = buildScenarioWithManyShifts(pScenario, nbShiftTypes, 2);
+
+		Tools::Timer timer;
+		timer.init();
+		timer.start();
+		int nbArcs = 0;
+		for (int i = 0; i < nbRepetitions; i++) {
+			for (const pair<const string,PConstContract>& contract: pScenarioShifts->contracts_) {
+				SubProblemShort subProblem(pScenarioShifts, nbDays, contract.second, pScenario->pInitialState());
+				subProblem.build();
+				nbArcs += subProblem.g().arcsSize();
+			}
+		}
+		timer.stop();
+
+		std::cout << nbShiftTypes << " shift types, " << pScenarioShifts->nbShifts_-1 << " shifts: "
+			<< 1000*timer.dSinceInit()/nbRepetitions << " ms to build the graphs of "
+			<< pScenarioShifts->nbContracts_ << " contracts (" << nbArcs/nbRepetitions << " arcs)" << std::endl;
+	}
+
+	return true;
+}
+
+// Check the decision of the greedy screening of the stochastic solver, and
+// that the greedy evaluations give the same costs when they share a single
+// copy of the scenario as when each of them gets its own copy
+//
+bool testGreedyScreening() {
+
+	bool success = true;
+	auto check = [&success](bool result, bool expected, const string& name) {
+		if (result != expected) {
+			std::cout << "Greedy screening: wrong decision when " << name << std::endl;
+			success = false;
+		}
+	};
+
+	// decision of the screening with a tolerance of 10%
+	check(StochasticSolver::isGreedyCostScreenedOut(1000.0, LARGE_SCORE, 0.1), false, "no schedule has a greedy cost yet");
+	check(StochasticSolver::isGreedyCostScreenedOut(1000.0, 1000.0, 0.1), false, "the costs are equal");
+	check(StochasticSolver::isGreedyCostScreenedOut(1100.0, 1000.0, 0.1), false, "the cost is at the tolerance");
+	check(StochasticSolver::isGreedyCostScreenedOut(1101.0, 1000.0, 0.1), true, "the cost exceeds the tolerance");
+	check(StochasticSolver::isGreedyCostScreenedOut(900.0, 1000.0, 0.0), false, "the cost is better than the best one");
+	check(StochasticSolver::isGreedyCostScreenedOut(-85.0, -100.0, 0.1), true, "the best cost is negative");
+	check(StochasticSolver::isGreedyCostScreenedOut(LARGE_SCORE, 1000.0, 0.1), true, "the greedy is infeasible");
+
+	// greedy evaluations over the demands of several weeks
+	string dataDir = "datasets/", instanceName = "n030w4";
+	string scenFile = dataDir + instanceName + "/Sc-" + instanceName + ".txt";
+	string historyFile = dataDir + instanceName + "/H0-" + instanceName + "-0.txt";
+	PScenario pScenario;
+	vector<PDemand> demands;
+	for (int w: {0, 3, 6, 9}) {
+		pScenario = initializeScenario(scenFile, dataDir + instanceName + "/WD-" + instanceName + "-" + std::to_string(w) + ".txt", historyFile);
+		demands.push_back(pScenario->pWeekDemand());
+	}
+	vector<State> initialStates = *pScenario->pInitialState();
+	PPreferences pEmptyPref = std::make_shared<Preferences>(pScenario->nbNurses(), 7, pScenario->nbShifts());
+
+	PScenario pShared = std::make_shared<Scenario>(*pScenario);
+	for (PDemand pDemand: demands) {
+		PScenario pOwn = std::make_shared<Scenario>(*pScenario);
+		pOwn->updateNewWeek(pDemand, pEmptyPref, initialStates);
+		Greedy greedyOwn(pOwn, pDemand, pEmptyPref, &initialStates);
+		double costOwn = greedyOwn.solve();
+
+		pShared->updateNewWeek(pDemand, pEmptyPref, initialStates);
+		pShared->setThisWeek(pScenario->thisWeek()+1);
+		Greedy greedyShared(pShared, pDemand, pEmptyPref, &initialStates);
+		double costShared = greedyShared.solve();
+
+		if (fabs(costOwn - costShared) > EPSILON) {
+			std::cout << "Greedy screening: the cost with the shared scenario is " << costShared
+				<< " instead of " << costOwn << std::endl;
+			success = false;
+		}
+	}
+
+	std::cout << "Greedy screening: " << (success ? "OK" : "FAILED") << std::endl;
+	return success;
+}
+
+// Greedy solver that gives access to the moves of the local search
+//
+class LocalSearchTester: public Greedy {
+public:
+	LocalSearchTester(PScenario pScenario, PDemand pDemand, PPreferences pPreferences, vector<State>* pInitState):
+		Greedy(pScenario, pDemand, pPreferences, pInitState) {}
+
+	// check that the variation of cost of the best move of every pair of nurses
+	// is the variation observed when the move is applied, and that the solution
+	// is restored by the reverse move
+	bool checkMoveEvaluation(int maxSegmentLength) {
+		bool withTotalCosts = true;
+		double cost = costEvaluator_.cost(withTotalCosts);
+		int nbNurses = theLiveNurses_.size(), nbMoves = 0;
+		vector<int> nbMovesPerType(LS_CHANGE_TASK+1, 0);
+		bool success = true;
+
+		for (int n1 = 0; n1 < nbNurses; n1++) {
+			for (int n2 = n1; n2 < nbNurses; n2++) {
+				LocalSearchMove move = bestLocalSearchMove(n1, n2, maxSegmentLength, withTotalCosts);
+				if (n1 == n2 && !checkReversals(move, maxSegmentLength, withTotalCosts)) success = false;
+				if (move.delta >= 0) continue;
+				nbMoves++;
+				nbMovesPerType[move.type]++;
+
+				LocalSearchMove reverseMove = applyLocalSearchMove(move);
+				double newCost = costEvaluator_.cost(withTotalCosts);
+				if (fabs(newCost-cost-move.delta) > EPSILON) {
+					std::cout << "Local search: move of type " << move.type << " of nurses " << n1 << " and " << n2
+						<< " from day " << move.firstDay << " to day " << move.lastDay << " is evaluated to "
+						<< move.delta << " instead of " << newCost-cost << std::endl;
+					success = false;
+				}
+				applyLocalSearchMove(reverseMove);
+				if (fabs(costEvaluator_.cost(withTotalCosts)-cost) > EPSILON) {
+					std::cout << "Local search: the reverse move does not restore the cost" << std::endl;
+					success = false;
+				}
+			}
+		}
+
+		std::cout << "Local search: " << nbMoves << " improving moves checked (swaps of nurses: "
+			<< nbMovesPerType[LS_SWAP_NURSES] << ", swaps of days: " << nbMovesPerType[LS_SWAP_DAYS]
+			<< ", reversals: " << nbMovesPerType[LS_REVERSE_DAYS] << ", changes of task: "
+			<< nbMovesPerType[LS_CHANGE_TASK] << ")" << std::endl;
+		return success && nbMoves > 0;
+	}
+
+	// load the solution and reverse a random segment of the roster of each
+	// nurse, so that reversing it back is an improving move
+	void loadPerturbedSolution(int maxSegmentLength) {
+		loadSolution(solution_);
+		computeSolutionCost();
+		std::minstd_rand rdm(0);
+		int nbDays = pDemand_->nbDays_;
+		for (unsigned int n = 0; n < theLiveNurses_.size(); n++) {
+			LocalSearchMove move;
+			move.type = LS_REVERSE_DAYS;
+			move.nurse1 = move.nurse2 = n;
+			move.firstDay = rdm() % (nbDays-2);
+			move.lastDay = std::min(nbDays-1, move.firstDay + 2 + (int) (rdm() % (maxSegmentLength-2)));
+			Roster roster = theLiveNurses_[n]->roster_;
+			reverseTasks(roster, move.firstDay, move.lastDay);
+			if (isFeasibleSegment(theLiveNurses_[n], roster, move.firstDay, move.lastDay)) applyLocalSearchMove(move);
+		}
+	}
+
+	// check that no reversal of the tasks of the nurse of the move is better
+	// than the move, by applying each of them to the solution
+	bool checkReversals(const LocalSearchMove& bestMove, int maxSegmentLength, bool withTotalCosts) {
+		double cost = costEvaluator_.cost(withTotalCosts);
+		PLiveNurse pNurse = theLiveNurses_[bestMove.nurse1];
+		int nbDays = pDemand_->nbDays_;
+		LocalSearchMove move = bestMove;
+		move.type = LS_REVERSE_DAYS;
+		for (move.firstDay = 0; move.firstDay < nbDays; move.firstDay++) {
+			for (move.lastDay = move.firstDay+2; move.lastDay < std::min(nbDays, move.firstDay+maxSegmentLength); move.lastDay++) {
+				reverseTasks(pNurse->roster_, move.firstDay, move.lastDay);
+				bool isFeasible = isFeasibleSegment(pNurse, pNurse->roster_, move.firstDay, move.lastDay);
+				reverseTasks(pNurse->roster_, move.firstDay, move.lastDay);
+				if (!isFeasible) continue;
+
+				applyLocalSearchMove(move);
+				double delta = costEvaluator_.cost(withTotalCosts)-cost;
+				applyLocalSearchMove(move);
+				if (delta < bestMove.delta-EPSILON) {
+					std::cout << "Local search: the reversal of nurse " << bestMove.nurse1 << " from day " << move.firstDay
+						<< " to day " << move.lastDay << " improves the cost by " << -delta << " but the best move only by "
+						<< -bestMove.delta << std::endl;
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// check that the feasibility test of the local search agrees with the
+	// violations of the hard constraints on random rosters
+	bool checkFeasibility(int nbRosters) {
+		std::minstd_rand rdm(0);
+		int nbDays = pDemand_->nbDays_, nbShifts = pScenario_->nbShifts_, nbSkills = pScenario_->nbSkills_;
+		int nbFeasible = 0;
+		bool success = true;
+
+		for (int r = 0; r < nbRosters; r++) {
+			PLiveNurse pNurse = theLiveNurses_[r % theLiveNurses_.size()];
+			Roster roster = pNurse->roster_;
+			int firstDay = rdm() % nbDays, lastDay = std::min(nbDays-1, firstDay + (int) (rdm() % 3));
+			for (int day = firstDay; day <= lastDay; day++) {
+				int shift = rdm() % nbShifts;
+				roster.assignTask(day, shift, shift ? rdm() % nbSkills : 0);
+			}
+
+			// the feasibility of the segment is compared with the violations of the
+			// days whose succession or skill may have changed
+			RosterBits bits;
+			bits.build(roster, pNurse->states_[0], pScenario_);
+			StatCtNurse stat = pNurse->statCt_;
+			pNurse->checkConstraints(roster, bits, stat);
+			bool isViolated = false;
+			for (int day = firstDay; day <= std::min(lastDay+1, nbDays-1); day++) {
+				if ((day <= lastDay && stat.violSkill_[day]) || stat.violSuccShifts_[day]) isViolated = true;
+			}
+
+			bool isFeasible = isFeasibleSegment(pNurse, roster, firstDay, lastDay);
+			if (isFeasible == isViolated) {
+				std::cout << "Local search: the segment of nurse " << pNurse->id_ << " from day " << firstDay
+					<< " to day " << lastDay << " is wrongly considered " << (isFeasible ? "feasible" : "infeasible")
+					<< std::endl;
+				success = false;
+			}
+			nbFeasible += isFeasible;
+		}
+
+		std::cout << "Local search: " << nbRosters << " random segments checked (" << nbFeasible << " feasible)" << std::endl;
+		return success;
+	}
+};
+
+// Check the evaluation of the moves of the local search on the final rosters
+// and its feasibility test, starting from a greedy solution whose rosters are
+// partly reversed
+//
+bool testLocalSearch() {
+	string dataDir = "datasets/", instanceName = "n030w4";
+	PScenario pScenario = initializeScenario(dataDir + instanceName + "/Sc-" + instanceName + ".txt",
+		dataDir + instanceName + "/WD-" + instanceName + "-1.txt", dataDir + instanceName + "/H0-" + instanceName + "-0.txt");
+
+	// the greedy does not always satisfy the minimum demand, which would make
+	// every solution cost LARGE_SCORE: only the optimal demand is kept
+	PDemand pDemand = pScenario->pWeekDemand();
+	for (int day = 0; day < pDemand->nbDays_; day++)
+		for (int sh = 0; sh < pDemand->nbShifts_; sh++)
+			for (int sk = 0; sk < pDemand->nbSkills_; sk++)
+				pDemand->setDemand(day, sh, sk, 0, pDemand->optDemand_[day][sh][sk]);
+
+	LocalSearchTester solver(pScenario, pDemand, pScenario->pWeekPreferences(), pScenario->pInitialState());
+	solver.solve();
+	solver.loadPerturbedSolution(7);
+
+	bool success = solver.checkMoveEvaluation(7);
+	success = solver.checkFeasibility(10000) && success;
+
+	std::cout << "Local search: " << (success ? "OK" : "FAILED") << std::endl;
+	return success;
+}
+
+// Greedy solver whose rosters are modified at random to write a solution log
+//
+class SolutionLogTester: public Greedy {
+public:
+	SolutionLogTester(PScenario pScenario, PDemand pDemand, PPreferences pPreferences, vector<State>* pInitState):
+		Greedy(pScenario, pDemand, pPreferences, pInitState) {}
+
+	// change the task of a random nurse on a random day
+	void changeRandomTask(std::minstd_rand& rdm) {
+		PLiveNurse pNurse = theLiveNurses_[rdm() % theLiveNurses_.size()];
+		int shift = rdm() % pScenario_->nbShifts_;
+		int skill = pNurse->skills_[rdm() % pNurse->skills_.size()];
+		pNurse->roster_.assignTask(rdm() % pDemand_->nbDays_, shift, shift ? skill : 0);
+		pNurse->buildStates();
+	}
+
+	vector<Roster> rosters() const {
+		vector<Roster> solution;
+		for (PLiveNurse pNurse: theLiveNurses_) solution.push_back(pNurse->roster_);
+		return solution;
+	}
+};
+
+// Write a solution log with a series of solutions and the statistics, read it
+// back and compare the records, then check that a log truncated in its last
+// record is read until the last complete record
+//
+bool testSolutionLog() {
+	string dataDir = "datasets/", instanceName = "n030w4", fileName = "test_solutions.bin";
+	PScenario pScenario = initializeScenario(dataDir + instanceName + "/Sc-" + instanceName + ".txt",
+		dataDir + instanceName + "/WD-" + instanceName + "-1.txt", dataDir + instanceName + "/H0-" + instanceName + "-0.txt");
+	PDemand pDemand = pScenario->pWeekDemand();
+
+	SolutionLogTester solver(pScenario, pDemand, pScenario->pWeekPreferences(), pScenario->pInitialState());
+	solver.solve();
+
+	// write the log: the solutions only differ by a few tasks
+	int nbSolutions = 20;
+	vector<vector<Roster> > solutions;
+	vector<CostBreakdown> costs;
+	std::minstd_rand rdm(0);
+	{
+		SolutionLogWriter writer(fileName, pScenario, pDemand->firstDay_, pDemand->nbDays_);
+		for (int k = 0; k < nbSolutions; k++) {
+			if (k) solver.changeRandomTask(rdm);
+			solutions.push_back(solver.rosters());
+			costs.push_back(solver.computeCostBreakdown());
+			writer.appendSolution(solutions.back(), costs.back(), 0.5*k, k ? "lns" : "initial", k);
+		}
+		GlobalStats stats;
+		stats.bestUB_ = costs.back().totalCost;
+		stats.lnsNbIterations_ = nbSolutions-1;
+		writer.appendStats(stats);
+	}
+
+	// read the log back and count the records that differ from the written ones
+	auto readLog = [&](int& nbSolutionsRead, bool& isStatsRead) {
+		int nbErrors = 0;
+		nbSolutionsRead = 0;
+		isStatsRead = false;
+		SolutionLogReader reader(fileName);
+		if (reader.nbNurses_ != pScenario->nbNurses_ || reader.nbDays_ != pDemand->nbDays_) nbErrors++;
+		SolutionLogRecord record;
+		while (reader.next(record)) {
+			if (record.type == LOG_STATS) {
+				isStatsRead = true;
+				if (record.stats.bestUB_ != costs.back().totalCost || record.stats.lnsNbIterations_ != nbSolutions-1) nbErrors++;
+				continue;
+			}
+			int k = nbSolutionsRead++;
+			if (k >= nbSolutions || record.index != k || record.iteration != k
+				|| record.costs.totalCost != costs[k].totalCost || record.costs.costPref != costs[k].costPref) {
+				nbErrors++;
+				continue;
+			}
+			for (int n = 0; n < reader.nbNurses_; n++) {
+				for (int day = 0; day < reader.nbDays_; day++) {
+					if (record.shifts[n][day] != solutions[k][n].shift(day)
+						|| record.skills[n][day] != solutions[k][n].skill(day)) nbErrors++;
+				}
+			}
+		}
+		return nbErrors;
+	};
+
+	bool success = true;
+	int nbSolutionsRead;
+	bool isStatsRead;
+	if (readLog(nbSolutionsRead, isStatsRead) || nbSolutionsRead != nbSolutions || !isStatsRead) {
+		std::cout << "Solution log: the log is not read as it was written" << std::endl;
+		success = false;
+	}
+
+	// cut the log in the middle of the record of the statistics
+	std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+	std::stringstream content;
+	content << file.rdbuf();
+	file.close();
+	string log = content.str();
+	std::ofstream truncatedFile(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	truncatedFile.write(log.data(), log.size()-10);
+	truncatedFile.close();
+	if (readLog(nbSolutionsRead, isStatsRead) || nbSolutionsRead != nbSolutions || isStatsRead) {
+		std::cout << "Solution log: the truncated log is not read until its last complete record" << std::endl;
+		success = false;
+	}
+	std::remove(fileName.c_str());
+
+	std::cout << "Solution log: " << (success ? "OK" : "FAILED") << std::endl;
+	return success;
+}
+
+// Demand generator that gives access to the draws of the batches
+//
+class DemandGeneratorTester: public DemandGenerator {
+public:
+	DemandGeneratorTester(int nbDemands, int nbDays, vector<PDemand> demands, PScenario pScenario, int rdmSeed):
+		DemandGenerator(nbDemands, nbDays, demands, pScenario, rdmSeed) {}
+
+	using DemandGenerator::drawRandomInts;
+	std::minstd_rand& rdm() {return rdm_;}
+};
+
+// Check that the batch generator and the sequential generator of the demands
+// draw from the same distribution, that the batch demands are views on one
+// buffer and that the draws of the batches are those of the random generator
+//
+bool testDemandGenerator() {
+	string dataDir = "datasets/", instanceName = "n030w4";
+	string scenFile = dataDir + instanceName + "/Sc-" + instanceName + ".txt";
+	string historyFile = dataDir + instanceName + "/H0-" + instanceName + "-0.txt";
+	PScenario pScenario;
+	vector<PDemand> demandHistory;
+	for (int w = 0; w < 10; w++) {
+		pScenario = initializeScenario(scenFile, dataDir + instanceName + "/WD-" + instanceName + "-" + std::to_string(w) + ".txt", historyFile);
+		demandHistory.push_back(pScenario->pWeekDemand());
+	}
+	bool success = true;
+
+	// the draws of a batch continue the sequence of the random generator
+	for (int nbDraws: {1, 7, 8, 9, 100}) {
+		DemandGeneratorTester generator(1, 7, demandHistory, pScenario, nbDraws);
+		std::minstd_rand rdm(nbDraws);
+		vector<int> draws;
+		generator.drawRandomInts(draws, nbDraws, -3, 11);
+		int nbErrors = 0;
+		for (int i = 0; i < nbDraws; i++) nbErrors += draws[i] != -3+(int)(rdm()%15);
+		nbErrors += generator.rdm()() != rdm();
+		if (nbErrors) {
+			std::cout << "Demand generator: the batch of " << nbDraws << " draws differs from the random generator" << std::endl;
+			success = false;
+		}
+	}
+
+	// totals of the minimum demand in the two weeks of the demands
+	int nbDemands = 2000, nbDays = 14;
+	auto computeStats = [](const vector<PDemand>& demands, double& mean1, double& mean2, double& correlation) {
+		vector<double> totals1, totals2;
+		for (PDemand pDemand: demands) {
+			double total1 = 0, total2 = 0;
+			for (int day = 0; day < 7; day++) total1 += pDemand->minPerDay_[day];
+			for (int day = 7; day < 14; day++) total2 += pDemand->minPerDay_[day];
+			totals1.push_back(total1);
+			totals2.push_back(total2);
+		}
+		double n = demands.size();
+		mean1 = std::accumulate(totals1.begin(), totals1.end(), 0.0)/n;
+		mean2 = std::accumulate(totals2.begin(), totals2.end(), 0.0)/n;
+		double cov = 0, var1 = 0, var2 = 0;
+		for (unsigned int k = 0; k < demands.size(); k++) {
+			cov += (totals1[k]-mean1)*(totals2[k]-mean2);
+			var1 += (totals1[k]-mean1)*(totals1[k]-mean1);
+			var2 += (totals2[k]-mean2)*(totals2[k]-mean2);
+		}
+		correlation = cov/sqrt(var1*var2);
+	};
+
+	DemandGenerator sequentialGenerator(nbDemands, nbDays, demandHistory, pScenario, 1);
+	vector<PDemand> sequentialDemands = sequentialGenerator.generatePerturbedDemands();
+	DemandGenerator batchGenerator(nbDemands, nbDays, demandHistory, pScenario, 2);
+	vector<PDemand> batchDemands = batchGenerator.generatePerturbedDemandsBatch();
+
+	double seqMean1, seqMean2, seqCorrelation, batchMean1, batchMean2, batchCorrelation;
+	computeStats(sequentialDemands, seqMean1, seqMean2, seqCorrelation);
+	computeStats(batchDemands, batchMean1, batchMean2, batchCorrelation);
+	std::cout << "Demand generator: mean totals of the weeks " << seqMean1 << " " << seqMean2
+		<< " (sequential) " << batchMean1 << " " << batchMean2 << " (batch), correlation of the weeks "
+		<< seqCorrelation << " (sequential) " << batchCorrelation << " (batch)" << std::endl;
+
+	// the weeks are drawn independently, and the mean totals are the same
+	// with the two generators
+	if (fabs(seqCorrelation) > 0.1 || fabs(batchCorrelation) > 0.1) {
+		std::cout << "Demand generator: the two weeks of the demands are correlated" << std::endl;
+		success = false;
+	}
+	if (fabs(seqMean1-batchMean1) > 0.02*seqMean1 || fabs(seqMean2-batchMean2) > 0.02*seqMean2) {
+		std::cout << "Demand generator: the mean totals differ between the generators" << std::endl;
+		success = false;
+	}
+
+	// the batch demands are views on one buffer
+	int dayStride = pScenario->nbShifts_*pScenario->nbSkills_;
+	for (int k = 0; k < nbDemands; k++) {
+		if (batchDemands[k]->minDemand_.data() != batchDemands[0]->minDemand_.data()+k*nbDays*dayStride
+			|| batchDemands[k]->optDemand_.data() != batchDemands[0]->optDemand_.data()+k*nbDays*dayStride) {
+			std::cout << "Demand generator: the batch demand " << k << " is not a view on the buffer of the batch" << std::endl;
+			success = false;
+			break;
+		}
+	}
+
+	std::cout << "Demand generator: " << (success ? "OK" : "FAILED") << std::endl;
+	return success;
+}
+
+// Greedy solver that compares the incremental evaluation of the cost with an
+// evaluation from scratch
+//
+class CostEvaluatorTester: public SolutionLogTester {
+public:
+	CostEvaluatorTester(PScenario pScenario, PDemand pDemand, PPreferences pPreferences, vector<State>* pInitState):
+		SolutionLogTester(pScenario, pDemand, pPreferences, pInitState) {}
+
+	// true if the incremental cost is the cost evaluated from scratch, with and
+	// without the costs of the global constraints
+	bool isSameCostAsFromScratch() {
+		computeSolutionCost();
+		CostEvaluator evaluator;
+		evaluator.init(pScenario_, pDemand_, pPreferences_, theLiveNurses_, pDemand_->nbDays_);
+		bool isSame = true;
+		for (bool withTotalCosts: {false, true}) {
+			if (fabs(costEvaluator_.cost(withTotalCosts)-evaluator.cost(withTotalCosts)) > EPSILON) {
+				std::cout << "Cost evaluator: the incremental cost is " << costEvaluator_.cost(withTotalCosts)
+					<< " instead of " << evaluator.cost(withTotalCosts) << std::endl;
+				isSame = false;
+			}
+		}
+		return isSame;
+	}
+};
+
+// Compare the incremental cost with the cost evaluated from scratch after a
+// series of random changes of the rosters, of the demand and of the wishes,
+// the demand and the wishes being modified in place
+//
+bool testCostEvaluator() {
+	string dataDir = "datasets/", instanceName = "n030w4";
+	PScenario pScenario = initializeScenario(dataDir + instanceName + "/Sc-" + instanceName + ".txt",
+		dataDir + instanceName + "/WD-" + instanceName + "-1.txt", dataDir + instanceName + "/H0-" + instanceName + "-0.txt");
+
+	// as in the test of the local search, only the optimal demand is kept so
+	// that the cost is not LARGE_SCORE
+	PDemand pDemand = pScenario->pWeekDemand();
+	PPreferences pPreferences = pScenario->pWeekPreferences();
+	int nbDays = pDemand->nbDays_, nbShifts = pDemand->nbShifts_, nbSkills = pDemand->nbSkills_;
+	for (int day = 0; day < nbDays; day++)
+		for (int sh = 0; sh < nbShifts; sh++)
+			for (int sk = 0; sk < nbSkills; sk++)
+				pDemand->setDemand(day, sh, sk, 0, pDemand->optDemand_[day][sh][sk]);
+
+	CostEvaluatorTester solver(pScenario, pDemand, pPreferences, pScenario->pInitialState());
+	solver.solve();
+
+	std::minstd_rand rdm(0);
+	int nbUpdates = 2000, nbErrors = 0;
+	vector<int> nbUpdatesPerType(3, 0);
+	for (int u = 0; u < nbUpdates; u++) {
+		int type = rdm() % 4;
+		if (type == 0) {
+			pDemand->setDemand(rdm() % nbDays, 1+rdm() % (nbShifts-1), rdm() % nbSkills, 0, rdm() % 5);
+		}
+		else if (type == 1) {
+			int nurse = rdm() % pScenario->nbNurses(), day = rdm() % nbDays, shift = 1+rdm() % (nbShifts-1);
+			PREF_LEVEL level = (PREF_LEVEL) (rdm() % (COMPULSORY+1));
+			if (rdm() % 2) pPreferences->addShiftOff(nurse, day, shift, level);
+			else pPreferences->addShiftOn(nurse, day, shift, level);
+		}
+		else {
+			type = 2;
+			solver.changeRandomTask(rdm);
+		}
+		nbUpdatesPerType[type]++;
+		if (!solver.isSameCostAsFromScratch() && ++nbErrors >= 10) break;
+	}
+
+	std::cout << "Cost evaluator: " << std::accumulate(nbUpdatesPerType.begin(), nbUpdatesPerType.end(), 0)
+		<< " random updates (demand: " << nbUpdatesPerType[0]
+		<< ", wishes: " << nbUpdatesPerType[1] << ", rosters: " << nbUpdatesPerType[2] << ")" << std::endl;
+	std::cout << "Cost evaluator: " << (nbErrors ? "FAILED" : "OK") << std::endl;
+	return nbErrors == 0;
+}
+
+// true if all the counters of the two states are equal
+//
+static bool isSameState(const State& s1, const State& s2) {
+	return s1.dayId_ == s2.dayId_ && s1.totalTimeWorked_ == s2.totalTimeWorked_
+		&& s1.totalWeekendsWorked_ == s2.totalWeekendsWorked_ && s1.consDaysWorked_ == s2.consDaysWorked_
+		&& s1.consShifts_ == s2.consShifts_ && s1.consDaysOff_ == s2.consDaysOff_
+		&& s1.shiftType_ == s2.shiftType_ && s1.shift_ == s2.shift_;
+}
+
+// Compare the states computed from the images of random rosters, some longer
+// than a word of 64 days, with the states built day by day, once the image is
+// built and once a random segment of the roster has been updated
+//
+bool testRosterBits() {
+	string dataDir = "datasets/", instanceName = "n030w4";
+	PScenario pScenario = initializeScenario(dataDir + instanceName + "/Sc-" + instanceName + ".txt",
+		dataDir + instanceName + "/WD-" + instanceName + "-1.txt", dataDir + instanceName + "/H0-" + instanceName + "-0.txt");
+	const vector<State>& initialStates = *pScenario->pInitialState();
+	int nbShifts = pScenario->nbShifts_;
+
+	std::minstd_rand rdm(0);
+	int nbRosters = 2000, nbErrors = 0;
+	for (int r = 0; r < nbRosters && nbErrors < 10; r++) {
+		// the rosters alternate sequences of rests and of worked shifts
+		int nbDays = 1+rdm() % 200;
+		Roster roster(nbDays, 0);
+		for (int day = 0; day < nbDays; day++) {
+			int shift = (day && rdm() % 3) ? roster.shift(day-1) : rdm() % nbShifts;
+			roster.assignTask(day, shift);
+		}
+		State stateIni = initialStates[r % initialStates.size()];
+		stateIni.dayId_ = rdm() % 7;
+
+		RosterBits bits;
+		bits.build(roster, stateIni, pScenario);
+		for (int update = 0; update < 2; update++) {
+			// the states are built day by day with the day ids of the roster
+			vector<State> states(1, stateIni);
+			for (int day = 0; day < nbDays; day++) {
+				State state;
+				state.dayId_ = stateIni.dayId_+day+1;
+				int shift = roster.shift(day);
+				state.addDayToState(states[day], pScenario->shiftIDToShiftTypeID_[shift], shift,
+					pScenario->timeDurationToWork_[shift]);
+				states.push_back(state);
+			}
+
+			for (int k = 0; k <= nbDays; k++) {
+				if (!isSameState(bits.state(roster, k), states[k])) {
+					std::cout << "Roster bits: the state after " << k << " days of the roster " << r
+						<< " is " << bits.state(roster, k).toString() << " instead of " << states[k].toString() << std::endl;
+					nbErrors++;
+					break;
+				}
+			}
+			for (int day = 0; day < nbDays; day++) {
+				int lastDay = day;
+				while (lastDay+1 < nbDays && bits.isWorked(lastDay+1) == bits.isWorked(day)) lastDay++;
+				if (bits.lastDayOfSequence(day) != lastDay) {
+					std::cout << "Roster bits: the sequence of day " << day << " of the roster " << r << " ends on day "
+						<< bits.lastDayOfSequence(day) << " instead of " << lastDay << std::endl;
+					nbErrors++;
+					break;
+				}
+			}
+
+			// change a random segment of the roster and update its image
+			int firstDay = rdm() % nbDays, lastDay = std::min(nbDays-1, firstDay + (int) (rdm() % 10));
+			for (int day = firstDay; day <= lastDay; day++) roster.assignTask(day, rdm() % nbShifts);
+			bits.update(roster, firstDay, lastDay);
+		}
+	}
+
+	std::cout << "Roster bits: " << nbRosters << " random rosters checked" << std::endl;
+	std::cout << "Roster bits: " << (nbErrors ? "FAILED" : "OK") << std::endl;
+	return nbErrors == 0;
+}
@@ -9,3 +9,34 @@
 
 // Test the result of the method that divides the scenario according to the connex components of positions
 bool testDivideIntoConnexComponents();
+
+// Compare the instance parser with the readers based on the file streams on
+// all the instances of the datasets and measure their speed
+bool benchmarkInstanceParser();
+
+// Measure the time taken to build the graphs of the short subproblems on
+// scenarios with more and more shifts
+bool benchmarkSubProblemGraphs();
+
+// Check the decision of the greedy screening of the stochastic solver and the
+// greedy evaluations on a shared copy of the scenario
+bool testGreedyScreening();
+
+// Check the evaluation of the moves of the local search on the final rosters
+// and its feasibility test
+bool testLocalSearch();
+
+// Write a solution log, read it back and read it again once truncated
+bool testSolutionLog();
+
+// Compare the batch generator of the demands with the sequential generator
+// and check that the batch demands are views on one buffer
+bool testDemandGenerator();
+
+// Compare the incremental evaluation of the cost with an evaluation from
+// scratch after random changes of the rosters, the demand and the wishes
+bool testCostEvaluator();
+
+// Compare the states computed from the bit-parallel images of random rosters
+// with the states built day by day
+bool testRosterBits();
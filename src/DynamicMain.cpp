@@ -6,7 +6,14 @@
 //  Copyright (c) 2014 J������r������my Omer. All rights reserved.
 //
 
+#include <atomic>
 #include <exception>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 #include "tools/ReadWrite.h"
 #include "tools/DemandGenerator.h"
@@ -22,20 +29,14 @@ using std::pair;
 
 
 /******************************************************************************
-* Solve one week inside the stochastic process
+* Set the options of the stochastic solver for the week whose solution is
+* written in solPath
 ******************************************************************************/
-void solveOneWeek(string scenPath, string demandPath, string historyPath, string customInputFile,
-	string solPath, double timeout) {
+StochasticSolverOptions readOptions(PScenario pScen, string solPath, double timeout,
+	Tools::LogOutput& logStream) {
 
   unsigned found = solPath.find_last_of(".");
-	string logPathIni = solPath.substr(0,found),
-    logPath = logPathIni+"Log.txt";
-	Tools::LogOutput logStream(logPath);
-
-
-	// set the scenario
-	logStream << "# Initialize the scenario" << std::endl;
-	PScenario pScen = initializeScenario(scenPath,demandPath,historyPath);
+	string logPathIni = solPath.substr(0,found);
 
 	// set the options of the stochastic solver
 	// (the corresponding method needs to be change manually for tests)
@@ -64,6 +65,28 @@ void solveOneWeek(string scenPath, string demandPath, string historyPath, string
       ReadWrite::readSolverOptions(evaluationOptions, options.evaluationParameters_) << std::endl;
 	} catch(const std::string& ex) {}
 
+	return options;
+}
+
+/******************************************************************************
+* Solve one week inside the stochastic process
+******************************************************************************/
+void solveOneWeek(string scenPath, string demandPath, string historyPath, string customInputFile,
+	string solPath, double timeout) {
+
+  unsigned found = solPath.find_last_of(".");
+	string logPathIni = solPath.substr(0,found),
+    logPath = logPathIni+"Log.txt";
+	Tools::LogOutput logStream(logPath);
+
+
+	// set the scenario
+	logStream << "# Initialize the scenario" << std::endl;
+	PScenario pScen = initializeScenario(scenPath,demandPath,historyPath);
+
+	// set the options of the stochastic solver
+	StochasticSolverOptions options = readOptions(pScen, solPath, timeout, logStream);
+
 	// get history demands by reading the custom file
 	//
 	vector<PDemand> demandHistory;
@@ -89,13 +112,132 @@ void solveOneWeek(string scenPath, string demandPath, string historyPath, string
 }
 
 /******************************************************************************
-* Test a solution on multiple weeks
-* In this method, the weeks are solved sequentially without knowledge of future
-* demand
+* Persistent dynamic mode: the weeks are received through a pipe instead of
+* starting a new process for every week
+* The scenario and the history of the demands are kept in memory, and the
+* initial states of a week are the final states of the previous one
+*
+* Each request is a line with the same arguments as the executable, e.g.:
+*   --sce Sc.txt --his H0.txt --week WD-0.txt --sol sol-week0.txt --timeout 10
+*   --week WD-1.txt --sol sol-week1.txt --timeout 10
+* --sce and --his are only needed for the first week of a scenario (they reset
+* the process). The line QUIT stops the process.
+* Each answer starts with "SOLVED status cost" or "ERROR message", followed
+* by the final state of each nurse in the format of the history files and "END"
 ******************************************************************************/
+void solveWeeksFromPipe(string pipeIn, string pipeOut) {
 
-pair<double, int> testMultipleWeeksStochastic(string dataDir, string instanceName, int historyIndex,
-		vector<int> weekIndices, StochasticSolverOptions stochasticSolverOptions, string outdir, std::vector<int> seeds) {
+	// the FIFOs must be opened in the same order by the client
+	std::ifstream requests(pipeIn.c_str());
+	std::ofstream answers(pipeOut.c_str());
+	if (!requests.is_open() || !answers.is_open()) {
+		Tools::throwError("solveWeeksFromPipe: the pipes were not opened properly!");
+	}
+
+	PScenario pScen(nullptr);
+	vector<PDemand> demandHistory;
+	vector<State> finalStates;
+	double costPreviousWeeks = 0;
+	// columns of the generation of the last week that start in the next week
+	vector2D<double> nextWeekColumns;
+
+	string line;
+	while (std::getline(requests, line)) {
+		if (line.empty()) continue;
+		if (line == "QUIT") break;
+
+		// parse the arguments of the request
+		std::map<string,string> args;
+		std::istringstream lineStream(line);
+		string key, value;
+		while (lineStream >> key >> value) args[key] = value;
+
+		try {
+			if (args["--week"].empty() || args["--sol"].empty()) {
+				Tools::throwError("A necessary file name is missing!");
+			}
+			double timeout = args["--timeout"].empty() ? 0.0 : std::stod(args["--timeout"]);
+			Tools::initializeRandomGenerator(args["--rand"].empty() ? 0 : std::stoi(args["--rand"]));
+
+			unsigned found = args["--sol"].find_last_of(".");
+			Tools::LogOutput logStream(args["--sol"].substr(0,found)+"Log.txt");
+
+			// a new scenario resets the process
+			if (!args["--sce"].empty()) {
+				logStream << "# Initialize the scenario" << std::endl;
+				pScen = initializeScenario(args["--sce"], args["--week"], args["--his"]);
+				costPreviousWeeks = 0;
+				nextWeekColumns.clear();
+				// the demand of the week comes first in the history, as in solveOneWeek
+				demandHistory = {pScen->pWeekDemand()};
+				if (!args["--cusIn"].empty()) {
+					ReadWrite::readCustom(args["--cusIn"], pScen, demandHistory);
+				}
+			}
+			// otherwise, start the new week from the final states of the last one
+			else {
+				if (!pScen) Tools::throwError("The first request must define the scenario!");
+				logStream << "# Update the scenario with the new week" << std::endl;
+				PDemand pDemand(nullptr);
+				PPreferences pPref(nullptr);
+				ReadWrite::readWeek(args["--week"], pScen, &pDemand, &pPref);
+				for (State& state: finalStates) state.dayId_ = 0;
+				pScen->updateNewWeek(pDemand, pPref, finalStates);
+				demandHistory.push_back(pScen->pWeekDemand());
+			}
+
+			StochasticSolverOptions options = readOptions(pScen, args["--sol"], timeout, logStream);
+			std::unique_ptr<StochasticSolver> pSolver(new StochasticSolver(pScen, options, demandHistory, costPreviousWeeks));
+
+			// the rotations priced on the extra days of the last generation start
+			// the generation of this week
+			pSolver->setInitialGenerationColumns(nextWeekColumns);
+
+			logStream << "# Solve the week" << std::endl;
+			costPreviousWeeks += pSolver->solve();
+			int solutionStatus = pSolver->getStatus();
+			logStream << "# Solution status = " << solutionStatus <<  std::endl;
+
+			Tools::LogOutput solStream(args["--sol"]);
+			solStream << pSolver->solutionToString() << std::endl;
+			finalStates = pSolver->getStatesOfDay(6);
+			nextWeekColumns = pSolver->getNextWeekColumnPatterns();
+			pSolver.reset();
+
+			if (!args["--cusOut"].empty()) {
+				ReadWrite::writeCustom(args["--cusOut"], args["--week"], args["--cusIn"]);
+			}
+
+			answers << "SOLVED " << solutionStatus << " " << costPreviousWeeks << std::endl;
+			for (int n = 0; n < pScen->nbNurses_; n++) {
+				answers << pScen->theNurses_[n]->name_ << " " << finalStates[n].toString();
+			}
+		} catch (const std::string& ex) {
+			answers << "ERROR " << ex << std::endl;
+		} catch (const std::exception& ex) {
+			// e.g. std::invalid_argument thrown by std::stod on a bad timeout
+			answers << "ERROR " << ex.what() << std::endl;
+		}
+		answers << "END" << std::endl;
+	}
+}
+
+/******************************************************************************
+* Solve a sequence of weeks with the stochastic solver
+* The weeks are solved sequentially without knowledge of future demand
+* The seeds that are missing are drawn with the input random generator
+******************************************************************************/
+
+struct WeekSequenceResult {
+	double cost = 0;
+	int nbSched = 0;
+	int nbWeeksSolved = 0;
+	Status status = UNSOLVED;
+};
+
+WeekSequenceResult solveWeekSequence(string dataDir, string instanceName, int historyIndex,
+		vector<int> weekIndices, StochasticSolverOptions stochasticSolverOptions, std::vector<int>& seeds,
+		std::minstd_rand& rdm, bool verbose) {
 
 	// build the paths of the input files
 	InputPaths inputPaths(dataDir, instanceName,historyIndex,weekIndices);
@@ -111,11 +253,12 @@ pair<double, int> testMultipleWeeksStochastic(string dataDir, string instanceNam
 	vector<PDemand> demandHistory;
 	double currentCost = 0;
 	int nbSched = 0;
+	WeekSequenceResult result;
 
 	for (int week = 0; week < nbWeeks; week++) {
 	   if(week >= seeds.size())
-	      seeds.push_back(std::rand());
-	   std::srand(seeds[week]);
+	      seeds.push_back(rdm()%RAND_MAX);
+	   Tools::initializeRandomGenerator(seeds[week]);
 
 		demandHistory.push_back(pScen->pWeekDemand());
 
@@ -123,12 +266,14 @@ pair<double, int> testMultipleWeeksStochastic(string dataDir, string instanceNam
 
 		currentCost += pSolver->solve();
 		nbSched += pSolver->getNbSchedules();
-		printf( "Current cost = %.2f \n", currentCost);
+		if (verbose) printf( "Current cost = %.2f \n", currentCost);
 		solutionStatus = pSolver->getStatus();
+		result.status = solutionStatus;
 		if (solutionStatus == INFEASIBLE) {
 			delete pSolver;
 			break;
 		}
+		result.nbWeeksSolved++;
 
 		// update the overall solution with the solution of the week that was just
 		// treated
@@ -142,7 +287,7 @@ pair<double, int> testMultipleWeeksStochastic(string dataDir, string instanceNam
 			}
 		}
 
-		std::cout << pSolver->solutionToLogString() << std::endl;
+		if (verbose) std::cout << pSolver->solutionToLogString() << std::endl;
 
 		// prepare the scenario for next week if we did not reach the last week yet
 		if (week < nbWeeks-1) {
@@ -169,6 +314,26 @@ pair<double, int> testMultipleWeeksStochastic(string dataDir, string instanceNam
 		delete pSolver;
 	}
 
+	result.cost = currentCost;
+	result.nbSched = nbSched;
+	return result;
+}
+
+/******************************************************************************
+* Test a solution on multiple weeks
+* In this method, the weeks are solved sequentially without knowledge of future
+* demand
+******************************************************************************/
+
+pair<double, int> testMultipleWeeksStochastic(string dataDir, string instanceName, int historyIndex,
+		vector<int> weekIndices, StochasticSolverOptions stochasticSolverOptions, string outdir, std::vector<int> seeds) {
+
+	std::minstd_rand rdm = Tools::getANewRandomGenerator();
+	WeekSequenceResult result = solveWeekSequence(dataDir, instanceName, historyIndex, weekIndices,
+		stochasticSolverOptions, seeds, rdm, true);
+	double currentCost = result.cost;
+	int nbSched = result.nbSched;
+
 	printf( "Total cost = %.2f \n", currentCost);
 
    string seedOutfile = outdir+"seeds.txt";
@@ -191,6 +356,135 @@ pair<double, int> testMultipleWeeksStochastic(string dataDir, string instanceNam
 * Main method
 ******************************************************************************/
 
+/******************************************************************************
+* Solve a batch of independent week sequences concurrently
+* Each line of the batch file is either a parameter of the batch:
+*   dataDir datasets/
+*   outdir outfiles/batch/
+*   threads 4
+*   timeout 40
+*   options paramfiles/stochastic.txt
+* or a run given by the instance, the history index, the indices of the weeks
+* and the seeds (the missing seeds are drawn from the first one):
+*   run n030w4 1 6-2-9-1 22-36-96-5
+* The runs are solved by a pool of threads, each run having its own scenario
+* and random generator. The logs of the solvers are written in outdir, and the
+* results are gathered in one report with one line per run and one summary
+* line per instance
+******************************************************************************/
+
+struct WeekSequenceRun {
+	string instanceName;
+	int historyIndex;
+	vector<int> weekIndices;
+	vector<int> seeds;
+	WeekSequenceResult result;
+	string error;
+};
+
+vector<int> readIndices(string str) {
+	vector<int> indices;
+	std::istringstream stream(str);
+	string index;
+	while (std::getline(stream, index, '-')) indices.push_back(std::stoi(index));
+	return indices;
+}
+
+void solveWeekSequencesBatch(string batchFile, string reportFile) {
+
+	// read the batch file
+	std::ifstream file(batchFile.c_str());
+	if (!file.is_open()) {
+		Tools::throwError("solveWeekSequencesBatch: the batch file was not opened properly!");
+	}
+	string dataDir = "datasets/", outdir = "", optionsFile = "";
+	int nThreads = 1;
+	double timeout = 40.0;
+	vector<WeekSequenceRun> runs;
+	string line;
+	while (std::getline(file, line)) {
+		std::istringstream lineStream(line);
+		string title;
+		if (!(lineStream >> title) || title[0] == '#') continue;
+		if (title == "dataDir") lineStream >> dataDir;
+		else if (title == "outdir") lineStream >> outdir;
+		else if (title == "threads") lineStream >> nThreads;
+		else if (title == "timeout") lineStream >> timeout;
+		else if (title == "options") lineStream >> optionsFile;
+		else if (title == "run") {
+			WeekSequenceRun run;
+			string weeks, seeds;
+			lineStream >> run.instanceName >> run.historyIndex >> weeks >> seeds;
+			run.weekIndices = readIndices(weeks);
+			run.seeds = readIndices(seeds);
+			if (run.seeds.empty()) run.seeds.push_back(0);
+			runs.push_back(run);
+		}
+		else Tools::throwError("solveWeekSequencesBatch: unknown parameter " + title);
+	}
+	nThreads = std::max(1, std::min(nThreads, (int) runs.size()));
+
+	// the time limits of the solvers are measured on the wall clock, so each
+	// run gets the same time whatever the number of runs solved concurrently
+
+	// each thread solves the next run that has not been solved yet
+	std::atomic<int> nextRun(0);
+	std::mutex coutMutex;
+	auto solveRuns = [&]() {
+		for (int r = nextRun++; r < (int) runs.size(); r = nextRun++) {
+			WeekSequenceRun& run = runs[r];
+			string logPathIni = outdir.empty() ? "" : outdir + run.instanceName + "_" +
+				std::to_string(run.historyIndex) + "_run" + std::to_string(r);
+			try {
+				StochasticSolverOptions options;
+				setStochasticSolverOptions(options, nullptr, "", logPathIni, timeout);
+				if (!optionsFile.empty()) ReadWrite::readStochasticSolverOptions(optionsFile, options);
+				options.totalTimeLimitSeconds_ = timeout;
+				std::minstd_rand rdm = Tools::getANewRandomGenerator(run.seeds[0]);
+				run.result = solveWeekSequence(dataDir, run.instanceName, run.historyIndex,
+					run.weekIndices, options, run.seeds, rdm, false);
+			} catch (const std::string& ex) {
+				run.error = ex;
+			} catch (const std::exception& ex) {
+				run.error = ex.what();
+			}
+			std::lock_guard<std::mutex> lock(coutMutex);
+			std::cout << "# Run " << r << " done: cost = " << run.result.cost << std::endl;
+		}
+	};
+	vector<std::thread> threads;
+	for (int t = 0; t < nThreads; t++) threads.emplace_back(solveRuns);
+	for (std::thread& thread: threads) thread.join();
+
+	// write the report: one line per run, then the statistics per instance
+	Tools::LogOutput report(reportFile);
+	report << "run;instance;history;weeks;seeds;status;weeksSolved;cost;nbSched;error" << std::endl;
+	std::map<string, vector<double>> costsPerInstance;
+	for (unsigned int r = 0; r < runs.size(); r++) {
+		const WeekSequenceRun& run = runs[r];
+		string weeks, seeds;
+		for (int w: run.weekIndices) weeks += (weeks.empty() ? "" : "-") + std::to_string(w);
+		for (int s: run.seeds) seeds += (seeds.empty() ? "" : "-") + std::to_string(s);
+		report << r << ";" << run.instanceName << ";" << run.historyIndex << ";" << weeks << ";" << seeds << ";"
+			<< statusToString.at(run.result.status) << ";" << run.result.nbWeeksSolved << ";"
+			<< run.result.cost << ";" << run.result.nbSched << ";" << run.error << std::endl;
+		if (run.error.empty() && run.result.nbWeeksSolved == (int) run.weekIndices.size())
+			costsPerInstance[run.instanceName].push_back(run.result.cost);
+	}
+	report << "instance;nbRuns;mean;stdDev;min;max" << std::endl;
+	for (const pair<const string, vector<double>>& p: costsPerInstance) {
+		const vector<double>& costs = p.second;
+		double mean = 0, variance = 0;
+		for (double cost: costs) mean += cost;
+		mean /= costs.size();
+		for (double cost: costs) variance += (cost-mean)*(cost-mean);
+		if (costs.size() > 1) variance /= (costs.size()-1);
+		report << p.first << ";" << costs.size() << ";" << mean << ";" << sqrt(variance) << ";"
+			<< *std::min_element(costs.begin(), costs.end()) << ";"
+			<< *std::max_element(costs.begin(), costs.end()) << std::endl;
+	}
+}
+
 int main(int argc, char** argv)
 {
   std::cout << "Number of arguments= " << argc << std::endl;
@@ -200,7 +494,7 @@ int main(int argc, char** argv)
   if (argc%2 != 1) {
     Tools::throwError("main: There should be an even number of arguments!");
   }
-  else if (argc > 1 && (argc < 9 || argc > 17)) {
+  else if (argc > 1 && argc != 5 && (argc < 9 || argc > 17)) {
     Tools::throwError("main: There is either too many or not enough arguments!");
   }
 
@@ -227,6 +521,8 @@ int main(int argc, char** argv)
     int narg = 1;
     string scenarioFile="", initialHistoryFile="", weekDataFile="", solutionFile="";
     string customInputFile="", customOutputFile="";
+    string pipeIn="", pipeOut="";
+    string batchFile="", reportFile="";
     int randSeed=0;
     double timeout =0.0;
 
@@ -275,18 +571,46 @@ int main(int argc, char** argv)
         randSeed = std::stoi(str);
         narg += 2;
      }
+     else if (!strcmp(argv[narg],"--pipeIn")) {
+        pipeIn = str;
+        narg += 2;
+     }
+     else if (!strcmp(argv[narg],"--pipeOut")) {
+        pipeOut = str;
+        narg += 2;
+     }
+     else if (!strcmp(argv[narg],"--batch")) {
+        batchFile = str;
+        narg += 2;
+     }
+     else if (!strcmp(argv[narg],"--report")) {
+        reportFile = str;
+        narg += 2;
+     }
      else {
         Tools::throwError("main: the argument does not match the expected list!");
      }
    }
 
+    // Persistent mode: the weeks are received through the pipes
+    if (!pipeIn.empty() && !pipeOut.empty()) {
+       solveWeeksFromPipe(pipeIn, pipeOut);
+       return 0;
+    }
+
+    // Batch mode: many week sequences are solved concurrently
+    if (!batchFile.empty() && !reportFile.empty()) {
+       solveWeekSequencesBatch(batchFile, reportFile);
+       return 0;
+    }
+
     // Throw an error if a necessary input file is missing
     if ( scenarioFile.empty() || initialHistoryFile.empty()
           || weekDataFile.empty() || solutionFile.empty() ) {
        throw Tools::myException("A necessary file name is missing!",__LINE__);
     }
 
-    srand(randSeed);
+    Tools::initializeRandomGenerator(randSeed);
 
     // Solve the week
     solveOneWeek(scenarioFile, weekDataFile, initialHistoryFile, customInputFile, solutionFile, timeout);
@@ -0,0 +1,114 @@
+/*
+ * NurseScheduler.cpp
+ *
+ *  Created on: October 7, 2020
+ */
+
+#include "NurseScheduler.h"
+#include "tools/InputPaths.h"
+
+using std::string;
+using std::vector;
+
+// Link the scenario with the demand, the preferences and the initial states
+// of the period to solve
+void linkScenarioWithWeek(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+	const vector<State>& initialStates) {
+
+	if ((int) initialStates.size() != pScenario->nbNurses_) {
+		Tools::throwError("linkScenarioWithWeek: there is not one initial state per nurse!");
+	}
+
+	vector<State> states = initialStates;
+	for (State& state: states) state.dayId_ = 0;
+
+	pScenario->linkWithDemand(pDemand);
+	pScenario->linkWithPreferences(pPreferences);
+	pScenario->setInitialState(states);
+}
+
+// Get the rosters and the final states of the nurses from a solver that has
+// just been solved
+ScheduleResult getScheduleResult(Solver* pSolver, double cost) {
+	ScheduleResult result;
+	result.status = pSolver->getStatus();
+	result.cost = cost;
+	result.rosters = pSolver->getSolution();
+
+	// the rosters are loaded again to be sure that the states of the live
+	// nurses are those of the returned solution
+	if ((int) result.rosters.size() == pSolver->getScenario()->nbNurses_) {
+		pSolver->loadSolution(result.rosters);
+		result.finalStates = pSolver->getFinalStates();
+	}
+	return result;
+}
+
+// Solve one week with the stochastic solver
+ScheduleResult solveWeekInMemory(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+	const vector<State>& initialStates, StochasticSolverOptions options,
+	vector<PDemand> demandHistory, double costPreviousWeeks) {
+
+	linkScenarioWithWeek(pScenario, pDemand, pPreferences, initialStates);
+	if (demandHistory.empty() || demandHistory.back() != pDemand) {
+		demandHistory.push_back(pDemand);
+	}
+
+	StochasticSolver* pSolver = new StochasticSolver(pScenario, options, demandHistory, costPreviousWeeks);
+	double cost = pSolver->solve();
+	ScheduleResult result = getScheduleResult(pSolver, cost);
+
+	//  release memory
+	delete pSolver;
+
+	return result;
+}
+
+ScheduleResult solveWeekInMemory(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+	const vector<State>& initialStates, double timeout, string solPath) {
+
+	// the logs are written next to the solution, if any
+	string logPathIni = "";
+	if (!solPath.empty()) {
+		unsigned found = solPath.find_last_of(".");
+		logPathIni = solPath.substr(0,found);
+	}
+
+	linkScenarioWithWeek(pScenario, pDemand, pPreferences, initialStates);
+	StochasticSolverOptions options;
+	setStochasticSolverOptions(options, pScenario, solPath, logPathIni, timeout);
+
+	// the stochastic solver writes the best schedule in solPath each time it is
+	// updated
+	return solveWeekInMemory(pScenario, pDemand, pPreferences, initialStates, options);
+}
+
+// Solve the whole horizon of the demand with the deterministic solver
+ScheduleResult solveDeterministicInMemory(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+	const vector<State>& initialStates, double timeout, int randSeed,
+	string paramFile, string solPath) {
+
+	linkScenarioWithWeek(pScenario, pDemand, pPreferences, initialStates);
+
+	// the deterministic solver reads its settings in the input paths, but no
+	// input file is read here
+	InputPaths inputPaths;
+	inputPaths.timeOut(timeout);
+	inputPaths.randSeed(randSeed);
+	inputPaths.paramFile(paramFile);
+	inputPaths.solutionPath(solPath);
+
+	DeterministicSolver* pSolver = new DeterministicSolver(pScenario, inputPaths);
+	double cost = pSolver->solve();
+	ScheduleResult result = getScheduleResult(pSolver, cost);
+
+	if (!solPath.empty() && !result.rosters.empty()) {
+		Tools::LogOutput solStream(solPath+"/sol.txt");
+		solStream << pSolver->solutionToString() << std::endl;
+	}
+
+	//  release memory
+	delete pSolver;
+
+	return result;
+}
@@ -0,0 +1,68 @@
+/*
+ * NurseScheduler.h
+ *
+ *  Created on: October 7, 2020
+ */
+
+#ifndef __NurseScheduler__
+#define __NurseScheduler__
+
+#include "solvers/StochasticSolver.h"
+#include "solvers/DeterministicSolver.h"
+#include "solvers/Solver.h"
+
+//-----------------------------------------------------------------------------
+//
+//  In-memory interface of the nurse scheduler library
+//
+//  The scenario, the demand, the preferences and the initial states are
+//  built by the caller (e.g. a simulator or a tuning loop) and the rosters and
+//  the final states are returned directly, so that no file needs to be written
+//  and parsed between two calls
+//  The solution and the logs are written only if the corresponding paths are
+//  given
+//
+//-----------------------------------------------------------------------------
+
+// Result of a call to the scheduler
+//
+struct ScheduleResult {
+	Status status = UNSOLVED;
+
+	// cost of the solution (LARGE_SCORE if no feasible solution was found)
+	double cost = LARGE_SCORE;
+
+	// one roster per nurse, in the order of the nurses of the scenario
+	std::vector<Roster> rosters;
+
+	// states of the nurses at the end of the horizon, which are the initial
+	// states of the next call in a rolling simulation
+	std::vector<State> finalStates;
+};
+
+// Link the scenario with the demand, the preferences and the initial states
+// of the period to solve
+// The day ids of the states are reset, so that the final states of a previous
+// call can be given as input
+void linkScenarioWithWeek(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+	const std::vector<State>& initialStates);
+
+// Solve one week with the stochastic solver
+// The demand history is used to generate the demand of the future weeks, the
+// demand of the week is appended to it if it is not its last element
+// The solution and the logs are written only if solPath is not empty, the
+// other options are those of setStochasticSolverOptions
+ScheduleResult solveWeekInMemory(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+	const std::vector<State>& initialStates, StochasticSolverOptions options,
+	std::vector<PDemand> demandHistory = {}, double costPreviousWeeks = 0);
+ScheduleResult solveWeekInMemory(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+	const std::vector<State>& initialStates, double timeout, std::string solPath = "");
+
+// Solve the whole horizon of the demand with the deterministic solver
+// The options are read from paramFile if it is not empty, and the solution
+// files are written in solPath if it is not empty
+ScheduleResult solveDeterministicInMemory(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+	const std::vector<State>& initialStates, double timeout, int randSeed = 0,
+	std::string paramFile = "", std::string solPath = "");
+
+#endif
@@ -0,0 +1,315 @@
+/*
+ * ValidatorMain.cpp
+ *
+ *  Created on: October 9, 2020
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+#include "solvers/InitializeSolver.h"
+#include "solvers/Solver.h"
+#include "tools/MyTools.h"
+#include "tools/ReadWrite.h"
+
+using std::string;
+using std::vector;
+
+//-----------------------------------------------------------------------------
+//
+//  Native validator of the solutions of the INRC-II
+//
+//  The solution of each run is read with the same methods as the solver, the
+//  hard constraints are checked and the cost is computed with the constraint
+//  statuses of the live nurses, so that no java virtual machine needs to be
+//  started for each solution
+//  Many solution directories can be validated in parallel and one line of
+//  summary is written for each of them
+//
+//-----------------------------------------------------------------------------
+
+// Description of a run to validate: same arguments as validator.sh
+//
+struct ValidationRun {
+	string instance;
+	string weeks;
+	int historyIndex = 0;
+	string solutionDir;
+};
+
+// Violations of the hard constraints and cost breakdown of a solution
+//
+struct ValidationResult {
+	// empty if the solution could be read and checked
+	string error;
+
+	// hard constraints: units of missing minimum staffing, forbidden
+	// successions and assignments to a skill that the nurse does not have
+	int underStaffing = 0;
+	int forbiddenSuccessions = 0;
+	int missingSkills = 0;
+
+	// soft constraints: cost of each category of the INRC-II
+	int costOptimalDemand = 0;
+	int costConsShifts = 0;
+	int costConsDays = 0;
+	int costConsDaysOff = 0;
+	int costPreferences = 0;
+	int costCompleteWeekends = 0;
+	int costTotalAssignments = 0;
+	int costTotalWeekends = 0;
+
+	bool isFeasible() const {
+		return error.empty() && !underStaffing && !forbiddenSuccessions && !missingSkills;
+	}
+	int totalCost() const {
+		return costOptimalDemand+costConsShifts+costConsDays+costConsDaysOff+costPreferences
+			+costCompleteWeekends+costTotalAssignments+costTotalWeekends;
+	}
+};
+
+/******************************************************************************
+* Check the hard constraints and compute the cost of the solution of one run
+******************************************************************************/
+
+ValidationResult validateRun(const ValidationRun& run, string dataDir) {
+	ValidationResult result;
+
+	try {
+		// read the instance and the solution files sol-week<w>.txt
+		vector<int> weekIndices = Tools::parseList(run.weeks, '-');
+		PScenario pScen = initializeMultipleWeeks(dataDir, run.instance, run.historyIndex, weekIndices);
+		vector<string> solutionFiles;
+		for (unsigned int w = 0; w < weekIndices.size(); w++) {
+			solutionFiles.push_back(run.solutionDir+"/sol-week"+std::to_string(w)+".txt");
+		}
+		vector<Roster> solution = ReadWrite::readSolutionMultipleWeeks(solutionFiles, pScen);
+
+		// load the solution in the live nurses to build their states
+		std::unique_ptr<Solver> pSolver(
+			new Solver(pScen, pScen->pWeekDemand(), pScen->pWeekPreferences(), pScen->pInitialState()));
+		pSolver->loadSolution(solution);
+
+		PDemand pDemand = pScen->pWeekDemand();
+		int nbDays = pDemand->nbDays_;
+		vector3D<int> staffing;
+		Tools::initVector3D(staffing, nbDays, pScen->nbShifts_, pScen->nbSkills_, 0);
+
+		// the costs of the global constraints are only paid at the end of the horizon
+		bool isLastWeek = pScen->thisWeek()+pScen->nbWeeksLoaded() == pScen->nbWeeks();
+
+		for (const PLiveNurse& pNurse: pSolver->getLiveNurses()) {
+			StatCtNurse& stat = pNurse->statCt_;
+			RosterBits bits;
+			bits.build(pNurse->roster_, pNurse->states_[0], pScen);
+			pNurse->checkConstraints(pNurse->roster_, bits, stat);
+
+			for (int day = 0; day < nbDays; day++) {
+				result.forbiddenSuccessions += stat.violSuccShifts_[day];
+				result.missingSkills += stat.violSkill_[day];
+				result.costConsShifts += stat.costConsShifts_[day];
+				result.costConsDays += stat.costConsDays_[day];
+				result.costConsDaysOff += stat.costConsDaysOff_[day];
+				result.costPreferences += stat.costPref_[day];
+				result.costCompleteWeekends += stat.costWeekEnd_[day];
+
+				int shift = pNurse->roster_.shift(day), skill = pNurse->roster_.skill(day);
+				if (shift > 0 && skill >= 0) staffing[day][shift][skill]++;
+			}
+			if (isLastWeek) {
+				result.costTotalAssignments += stat.costTotalDays_;
+				result.costTotalWeekends += stat.costTotalWeekEnds_;
+			}
+		}
+
+		// coverage of the minimum and optimal demands
+		for (int day = 0; day < nbDays; day++) {
+			for (int sh = 1; sh < pScen->nbShifts_; sh++) {
+				for (int sk = 0; sk < pScen->nbSkills_; sk++) {
+					result.underStaffing += std::max(0, pDemand->minDemand_[day][sh][sk]-staffing[day][sh][sk]);
+					result.costOptimalDemand += WEIGHT_OPTIMAL_DEMAND
+						* std::max(0, pDemand->optDemand_[day][sh][sk]-staffing[day][sh][sk]);
+				}
+			}
+		}
+	}
+	catch (const string& ex) {
+		result.error = ex;
+	}
+	catch (const std::exception& ex) {
+		result.error = ex.what();
+	}
+
+	return result;
+}
+
+/******************************************************************************
+* Read the list of runs to validate: one run per line with the same arguments
+* as validator.sh, i.e. instance, weeks, history index and solution directory
+* (the lines starting with # are ignored)
+******************************************************************************/
+
+vector<ValidationRun> readRunList(string listFile) {
+	std::fstream file(listFile.c_str(), std::fstream::in);
+	if (!file.is_open()) {
+		std::cout << "While trying to read " << listFile << std::endl;
+		Tools::throwError("The input file was not opened properly!");
+	}
+
+	vector<ValidationRun> runs;
+	string line;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#') continue;
+		std::istringstream lineStream(line);
+		ValidationRun run;
+		if (!(lineStream >> run.instance >> run.weeks >> run.historyIndex >> run.solutionDir)) {
+			Tools::throwError("readRunList: the line \""+line+"\" does not describe a run!");
+		}
+		runs.push_back(run);
+	}
+	return runs;
+}
+
+/******************************************************************************
+* Write one line of summary per run (csv format)
+******************************************************************************/
+
+void writeSummary(Tools::LogOutput& outStream, const vector<ValidationRun>& runs,
+	const vector<ValidationResult>& results) {
+
+	outStream << "solution_dir,instance,weeks,history,status,total_cost,"
+		<< "under_staffing,forbidden_successions,missing_skills,"
+		<< "optimal_coverage,consecutive_shifts,consecutive_days,consecutive_days_off,"
+		<< "preferences,complete_weekends,total_assignments,total_weekends,error" << std::endl;
+
+	for (unsigned int i = 0; i < runs.size(); i++) {
+		const ValidationRun& run = runs[i];
+		const ValidationResult& result = results[i];
+		string status = !result.error.empty() ? "ERROR" : (result.isFeasible() ? "FEASIBLE" : "INFEASIBLE");
+
+		// the commas of the error messages would break the columns
+		string error = result.error;
+		std::replace(error.begin(), error.end(), ',', ';');
+		std::replace(error.begin(), error.end(), '\n', ' ');
+
+		std::stringstream rep;
+		rep << run.solutionDir << "," << run.instance << "," << run.weeks << "," << run.historyIndex
+			<< "," << status << "," << result.totalCost()
+			<< "," << result.underStaffing << "," << result.forbiddenSuccessions << "," << result.missingSkills
+			<< "," << result.costOptimalDemand << "," << result.costConsShifts << "," << result.costConsDays
+			<< "," << result.costConsDaysOff << "," << result.costPreferences << "," << result.costCompleteWeekends
+			<< "," << result.costTotalAssignments << "," << result.costTotalWeekends << "," << error;
+		outStream << rep.str() << std::endl;
+	}
+}
+
+/******************************************************************************
+* Main method
+******************************************************************************/
+
+int main(int argc, char** argv)
+{
+	// Detect errors in the number of arguments
+	//
+	if (argc%2 != 1) {
+		Tools::throwError("main: There should be an even number of arguments!");
+	}
+
+	// Default arguments
+	//
+	string dataDir = "datasets/", listFile = "", outFile = "";
+	ValidationRun singleRun;
+	int nbThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	int narg = 1;
+	while (narg < argc) {
+		const char* arg = argv[narg];
+		string str(argv[narg+1]);
+
+		if (!strcmp(arg,"--dir")) {
+			dataDir = str;
+		}
+		else if (!strcmp(arg,"--instance")) {
+			singleRun.instance = str;
+		}
+		else if (!strcmp(arg,"--weeks")) {
+			singleRun.weeks = str;
+		}
+		else if (!strcmp(arg,"--his")) {
+			singleRun.historyIndex = std::stoi(str);
+		}
+		else if (!strcmp(arg,"--sol")) {
+			singleRun.solutionDir = str;
+		}
+		else if (!strcmp(arg,"--list")) {
+			listFile = str;
+		}
+		else if (!strcmp(arg,"--threads")) {
+			nbThreads = std::max(1, std::stoi(str));
+		}
+		else if (!strcmp(arg,"--out")) {
+			outFile = str;
+		}
+		else {
+			Tools::throwError("main: the argument does not match the expected list!");
+		}
+		narg += 2;
+	}
+
+	vector<ValidationRun> runs;
+	if (!listFile.empty()) {
+		runs = readRunList(listFile);
+	}
+	else if (!singleRun.solutionDir.empty()) {
+		runs.push_back(singleRun);
+	}
+	else {
+		Tools::throwError("main: a solution directory (--sol) or a list of runs (--list) is required!");
+	}
+
+	// validate the runs in parallel: each thread takes the next run that has not
+	// been validated yet
+	// the readers and the errors are logged on the standard output, which is sent
+	// to the standard error in the meantime so that the summary can be piped
+	// (the file descriptor is redirected, as some messages are printed with printf)
+	//
+	std::cout.flush();
+	fflush(stdout);
+	int stdoutFd = dup(STDOUT_FILENO);
+	dup2(STDERR_FILENO, STDOUT_FILENO);
+	vector<ValidationResult> results(runs.size());
+	std::atomic<unsigned int> nextRun(0);
+	auto validateRuns = [&]() {
+		for (unsigned int i = nextRun++; i < runs.size(); i = nextRun++) {
+			results[i] = validateRun(runs[i], dataDir);
+		}
+	};
+	vector<std::thread> threads;
+	for (int t = 0; t < std::min(nbThreads, (int) runs.size()); t++) {
+		threads.push_back(std::thread(validateRuns));
+	}
+	for (std::thread& thread: threads) thread.join();
+	std::cout.flush();
+	fflush(stdout);
+	dup2(stdoutFd, STDOUT_FILENO);
+	close(stdoutFd);
+
+	// write the summary
+	//
+	Tools::LogOutput outStream(outFile);
+	writeSummary(outStream, runs, results);
+	outStream.close();
+
+	// 1 if one of the solutions is not feasible, 0 otherwise
+	for (const ValidationResult& result: results) {
+		if (!result.isFeasible()) return 1;
+	}
+	return 0;
+}
@@ -5,6 +5,77 @@
 #include <math.h>
 
 
+//-----------------------------------------------------------------------------
+//
+//	C l a s s  D e m a n d T a b l e
+//
+// Demand of each day, shift and skill stored in one contiguous buffer
+//
+//-----------------------------------------------------------------------------
+
+DemandTable::DemandTable(int nbDays, int nbShifts, int nbSkills, int val):
+   nbDays_(nbDays), nbShifts_(nbShifts), nbSkills_(nbSkills), first_(0),
+   buffer_(std::make_shared<std::vector<int>>(nbDays*nbShifts*nbSkills, val))
+{}
+
+DemandTable::DemandTable(const vector3D<int>& demand):
+   nbDays_(demand.size()), nbShifts_(demand.empty() ? 0 : demand[0].size()),
+   nbSkills_(nbShifts_ == 0 ? 0 : demand[0][0].size()), first_(0),
+   buffer_(std::make_shared<std::vector<int>>())
+{
+   buffer_->reserve(nbDays_*dayStride());
+   for (const vector2D<int>& dayDemand: demand)
+      for (const std::vector<int>& shiftDemand: dayDemand)
+         buffer_->insert(buffer_->end(), shiftDemand.begin(), shiftDemand.end());
+}
+
+// pointer on the first element of the view, the view gets its own buffer
+// if it shared it
+//
+int* DemandTable::mutableData() {
+   if (buffer_.use_count() > 1) {
+      const int* pData = data();
+      buffer_ = std::make_shared<std::vector<int>>(pData, pData+nbDays_*dayStride());
+      first_ = 0;
+   }
+   return buffer_->data()+first_;
+}
+
+void DemandTable::swapDays(int day1, int day2) {
+   if (day1 == day2) return;
+   int* pData = mutableData();
+   std::swap_ranges(pData+day1*dayStride(), pData+(day1+1)*dayStride(), pData+day2*dayStride());
+}
+
+// view on the days in [begin,end) without copy
+//
+DemandTable DemandTable::slice(int begin, int end) const {
+   DemandTable table(*this);
+   table.first_ += begin*dayStride();
+   table.nbDays_ = end-begin;
+   return table;
+}
+
+// add the days of another table at the end of this one
+//
+void DemandTable::append(const DemandTable& table) {
+   int size = nbDays_*dayStride();
+   // the buffer is extended in place only if the view is its last part and
+   // nobody else uses it
+   if (!buffer_ || buffer_.use_count() > 1 || first_+size != (int) buffer_->size()) {
+      std::shared_ptr<std::vector<int>> pBuffer = std::make_shared<std::vector<int>>();
+      pBuffer->reserve(size+table.nbDays_*table.dayStride());
+      if (buffer_) pBuffer->insert(pBuffer->end(), data(), data()+size);
+      buffer_ = pBuffer;
+      first_ = 0;
+   }
+   buffer_->insert(buffer_->end(), table.data(), table.data()+table.nbDays_*table.dayStride());
+   nbDays_ += table.nbDays_;
+   nbShifts_ = table.nbShifts_;
+   nbSkills_ = table.nbSkills_;
+}
+
+
 //-----------------------------------------------------------------------------
 //
 //	C l a s s  D e m a n d
@@ -16,7 +87,12 @@
 // constructor and destructor
 //
 Demand::Demand(int nbDays, int firstDay, int nbShifts, int nbSkills, std::string name,
-   vector3D<int> minDemand, vector3D<int> optDemand): name_(name),
+   vector3D<int> minDemand, vector3D<int> optDemand):
+   Demand(nbDays, firstDay, nbShifts, nbSkills, name, DemandTable(minDemand), DemandTable(optDemand))
+{}
+
+Demand::Demand(int nbDays, int firstDay, int nbShifts, int nbSkills, std::string name,
+   DemandTable minDemand, DemandTable optDemand): name_(name),
    nbDays_(nbDays), firstDay_(firstDay), nbShifts_(nbShifts), nbSkills_(nbSkills),
    minDemand_(minDemand), optDemand_(optDemand),
    minTotal_(0), optTotal_(0), isPreprocessed_(false)
@@ -25,6 +101,13 @@ Demand::Demand(int nbDays, int firstDay, int nbShifts, int nbSkills, std::string
    this->preprocessDemand();
 }
 
+Demand::Demand(int nbDays, int firstDay, int nbShifts, int nbSkills, std::string name,
+   DemandTable minDemand, DemandTable optDemand, bool isPreprocessed): name_(name),
+   nbDays_(nbDays), firstDay_(firstDay), nbShifts_(nbShifts), nbSkills_(nbSkills),
+   minDemand_(minDemand), optDemand_(optDemand),
+   minTotal_(0), optTotal_(0), isPreprocessed_(isPreprocessed)
+{}
+
 Demand::~Demand()
 {}
 
@@ -33,6 +116,8 @@ Demand::~Demand()
 //
 void Demand::preprocessDemand() {
    // initialize the preprocessed vectors
+   minTotal_ = 0;
+   optTotal_ = 0;
    Tools::initVector(minPerDay_, nbDays_, 0);
    Tools::initVector(optPerDay_, nbDays_, 0);
    Tools::initVector(minPerShift_, nbShifts_, 0);
@@ -44,43 +129,140 @@ void Demand::preprocessDemand() {
 
    for (int day = 0; day < nbDays_; day++)	{
       for (int shift = 1; shift < nbShifts_; shift++) {
+         const int* minDemand = minDemand_[day][shift];
+         const int* optDemand = optDemand_[day][shift];
          for (int skill = 0; skill < nbSkills_; skill++)	{
             // update the total demand
-            minTotal_ += minDemand_[day][shift][skill];
-            optTotal_ += optDemand_[day][shift][skill];
+            minTotal_ += minDemand[skill];
+            optTotal_ += optDemand[skill];
 
             // update the demand per day
-            minPerDay_[day] += minDemand_[day][shift][skill];
-            optPerDay_[day] += optDemand_[day][shift][skill];
+            minPerDay_[day] += minDemand[skill];
+            optPerDay_[day] += optDemand[skill];
 
             // update the demand per shift
-            minPerShift_[shift] += minDemand_[day][shift][skill];
-            optPerShift_[shift] += optDemand_[day][shift][skill];
+            minPerShift_[shift] += minDemand[skill];
+            optPerShift_[shift] += optDemand[skill];
 
             // update the demand per skill
-            minPerSkill_[skill] += minDemand_[day][shift][skill];
-            optPerSkill_[skill] += optDemand_[day][shift][skill];
+            minPerSkill_[skill] += minDemand[skill];
+            optPerSkill_[skill] += optDemand[skill];
 
             // update the demand per day
-            minHighestPerSkill_[skill] =
-               std::max(minDemand_[day][shift][skill],minHighestPerSkill_[skill]);
-            optHighestPerSkill_[skill] =
-               std::max(optDemand_[day][shift][skill],optHighestPerSkill_[skill]);
+            minHighestPerSkill_[skill] = std::max(minDemand[skill],minHighestPerSkill_[skill]);
+            optHighestPerSkill_[skill] = std::max(optDemand[skill],optHighestPerSkill_[skill]);
          }
       }
    }
    isPreprocessed_ = true;
 }
 
+// set the minimum and optimal demand of a day, shift and skill and update
+// the aggregated attributes
+//
+void Demand::setDemand(int day, int shift, int skill, int minDemand, int optDemand) {
+   version_++;
+   int oldMinDemand = minDemand_.get(day, shift, skill);
+   int oldOptDemand = optDemand_.get(day, shift, skill);
+   minDemand_.set(day, shift, skill, minDemand);
+   optDemand_.set(day, shift, skill, optDemand);
+
+   // the demand of the rest shift is not aggregated
+   if (shift == 0 || !isPreprocessed_) return;
+
+   int deltaMin = minDemand-oldMinDemand, deltaOpt = optDemand-oldOptDemand;
+   minTotal_ += deltaMin;
+   optTotal_ += deltaOpt;
+   minPerDay_[day] += deltaMin;
+   optPerDay_[day] += deltaOpt;
+   minPerShift_[shift] += deltaMin;
+   optPerShift_[shift] += deltaOpt;
+   minPerSkill_[skill] += deltaMin;
+   optPerSkill_[skill] += deltaOpt;
+
+   // the highest demand needs to be computed again only if it was reached by
+   // the demand that decreased
+   if ((deltaMin < 0 && oldMinDemand == minHighestPerSkill_[skill])
+      || (deltaOpt < 0 && oldOptDemand == optHighestPerSkill_[skill])) {
+      computeHighestOfSkill(skill);
+   }
+   else {
+      minHighestPerSkill_[skill] = std::max(minDemand, minHighestPerSkill_[skill]);
+      optHighestPerSkill_[skill] = std::max(optDemand, optHighestPerSkill_[skill]);
+   }
+}
+
+// add (sign=1) or remove (sign=-1) the demand of the days in [begin,end) to
+// the totals per shift and per skill
+//
+void Demand::addDaysToTotals(int begin, int end, int sign, std::vector<bool>& isHighestReached) {
+   for (int day = begin; day < end; day++)	{
+      minTotal_ += sign*minPerDay_[day];
+      optTotal_ += sign*optPerDay_[day];
+      for (int shift = 1; shift < nbShifts_; shift++) {
+         const int* minDemand = minDemand_[day][shift];
+         const int* optDemand = optDemand_[day][shift];
+         for (int skill = 0; skill < nbSkills_; skill++)	{
+            minPerShift_[shift] += sign*minDemand[skill];
+            optPerShift_[shift] += sign*optDemand[skill];
+            minPerSkill_[skill] += sign*minDemand[skill];
+            optPerSkill_[skill] += sign*optDemand[skill];
+            if (minDemand[skill] == minHighestPerSkill_[skill]
+               || optDemand[skill] == optHighestPerSkill_[skill]) {
+               isHighestReached[skill] = true;
+            }
+         }
+      }
+   }
+}
+
+// compute the highest demand of a skill over the considered period
+//
+void Demand::computeHighestOfSkill(int skill) {
+   minHighestPerSkill_[skill] = 0;
+   optHighestPerSkill_[skill] = 0;
+   for (int day = 0; day < nbDays_; day++)	{
+      for (int shift = 1; shift < nbShifts_; shift++) {
+         minHighestPerSkill_[skill] = std::max(minDemand_[day][shift][skill],minHighestPerSkill_[skill]);
+         optHighestPerSkill_[skill] = std::max(optDemand_[day][shift][skill],optHighestPerSkill_[skill]);
+      }
+   }
+}
+
+// keep only the days in [begin,end) and update the aggregated attributes
+//
+void Demand::restrictToDays(int begin, int end) {
+   version_++;
+   if (!isPreprocessed_) this->preprocessDemand();
+
+   // remove the demand of the other days from the totals
+   std::vector<bool> isHighestReached(nbSkills_, false);
+   addDaysToTotals(0, begin, -1, isHighestReached);
+   addDaysToTotals(end, nbDays_, -1, isHighestReached);
+
+   minDemand_ = minDemand_.slice(begin, end);
+   optDemand_ = optDemand_.slice(begin, end);
+   minPerDay_ = std::vector<int>(minPerDay_.begin()+begin, minPerDay_.begin()+end);
+   optPerDay_ = std::vector<int>(optPerDay_.begin()+begin, optPerDay_.begin()+end);
+   nbDays_ = end-begin;
+
+   for (int skill = 0; skill < nbSkills_; skill++) {
+      if (isHighestReached[skill]) computeHighestOfSkill(skill);
+   }
+}
+
 
 // add another week demand at the end of the current one
 // update all the parameters
 void Demand::push_back(PDemand pDemand){
+   version_++;
    // check if same scenario
    if( (nbShifts_ != pDemand->nbShifts_) || (nbSkills_ != pDemand->nbSkills_) ){
      std::string error = "Demands are not compatible";
       Tools::throwError(error.c_str());
    }
+   if (!isPreprocessed_) this->preprocessDemand();
+   if (!pDemand->isPreprocessed_) pDemand->preprocessDemand();
 
    /*
     * Build new demand
@@ -91,75 +273,65 @@ void Demand::push_back(PDemand pDemand){
    nbDays_ += pDemand->nbDays_;
 
    //pushes back the second demand on the first
-   for(const vector2D<int>& vector: pDemand->minDemand_)
-      minDemand_.push_back(vector);
-   for(const vector2D<int>& vector: pDemand->optDemand_)
-      optDemand_.push_back(vector);
-
-   // run the preprocessing
-   this->preprocessDemand();
+   minDemand_.append(pDemand->minDemand_);
+   optDemand_.append(pDemand->optDemand_);
+
+   // the aggregated attributes are those of the two demands
+   minTotal_ += pDemand->minTotal_;
+   optTotal_ += pDemand->optTotal_;
+   minPerDay_.insert(minPerDay_.end(), pDemand->minPerDay_.begin(), pDemand->minPerDay_.end());
+   optPerDay_.insert(optPerDay_.end(), pDemand->optPerDay_.begin(), pDemand->optPerDay_.end());
+   for (int shift = 0; shift < nbShifts_; shift++) {
+      minPerShift_[shift] += pDemand->minPerShift_[shift];
+      optPerShift_[shift] += pDemand->optPerShift_[shift];
+   }
+   for (int skill = 0; skill < nbSkills_; skill++) {
+      minPerSkill_[skill] += pDemand->minPerSkill_[skill];
+      optPerSkill_[skill] += pDemand->optPerSkill_[skill];
+      minHighestPerSkill_[skill] = std::max(pDemand->minHighestPerSkill_[skill],minHighestPerSkill_[skill]);
+      optHighestPerSkill_[skill] = std::max(pDemand->optHighestPerSkill_[skill],optHighestPerSkill_[skill]);
+   }
 }
 
 // Returns a new demand that appends pDemand to the current one
 PDemand Demand::append(PDemand pDemand){
 
+  // the copy shares the tables of this demand until they are extended
   PDemand bigDemand = std::make_shared<Demand>(*this);
+  bigDemand->push_back(pDemand);
 
-   // check if same scenario
-   if( (nbShifts_ != pDemand->nbShifts_) || (nbSkills_ != pDemand->nbSkills_) ){
-     std::string error = "Demands are not compatible";
-      Tools::throwError(error.c_str());
-   }
-
-   // number of days covered by the demand and index of the first day
-   //
-   bigDemand->nbDays_ += pDemand->nbDays_;
-
-   //pushes back the second demand on the first
-   for(const vector2D<int>& vector: pDemand->minDemand_) {
-      bigDemand->minDemand_.push_back(vector);
-   }
-
-   for(const vector2D<int>& vector: pDemand->optDemand_) {
-	   bigDemand->optDemand_.push_back(vector);
-   }
-
-   // run the preprocessing
-   bigDemand->preprocessDemand();
-
-   return bigDemand;
+  return bigDemand;
 }
 
 // modify the demand by randomly swapping the demand of nnSwaps days
 //
-void Demand::swapDays(int nbSwaps) {
+void Demand::swapDays(std::minstd_rand& rdm, int nbSwaps) {
+  version_++;
 
   for (int i=0; i < nbSwaps; i++) {
-    int day1 = Tools::randomInt(0, nbDays_ - 1);
-    int day2 = Tools::randomInt(0, nbDays_ - 1);
-
-    // save the demand on day 1
-    vector2D<int> minDemandTmp = minDemand_[day1], optDemandTmp = optDemand_[day1];
+    int day1 = Tools::randomInt(rdm, 0, nbDays_ - 1);
+    int day2 = Tools::randomInt(rdm, 0, nbDays_ - 1);
 
     // make the modification in the demand
-    minDemand_[day1] = minDemand_[day2];
-    optDemand_[day1] = minDemand_[day2];
+    minDemand_.swapDays(day1, day2);
+    optDemand_.swapDays(day1, day2);
 
-    minDemand_[day2] = minDemandTmp;
-    optDemand_[day2] = optDemandTmp;
+    // only the demand per day is modified
+    std::swap(minPerDay_[day1], minPerDay_[day2]);
+    std::swap(optPerDay_[day1], optPerDay_[day2]);
   }
 }
 
 // modify the demand by randomly swapping the demand of nbSwaps shifts
 // the swapped shifts necessarily correspond to the same skill
 //
-void Demand::swapShifts(int nbSwaps) {
+void Demand::swapShifts(std::minstd_rand& rdm, int nbSwaps) {
   for (int i=0; i < nbSwaps; i++) {
-    int sk = Tools::randomInt(0, nbSkills_ - 1);
-    int day1 = Tools::randomInt(0, nbDays_ - 1);
-    int sh1 = Tools::randomInt(1, nbShifts_ - 1); // make sure shift 0 is not taken
-    int day2 = Tools::randomInt(0, nbDays_ - 1);
-    int sh2 = Tools::randomInt(1, nbShifts_ - 1);// make sure shift 0 is not taken
+    int sk = Tools::randomInt(rdm, 0, nbSkills_ - 1);
+    int day1 = Tools::randomInt(rdm, 0, nbDays_ - 1);
+    int sh1 = Tools::randomInt(rdm, 1, nbShifts_ - 1); // make sure shift 0 is not taken
+    int day2 = Tools::randomInt(rdm, 0, nbDays_ - 1);
+    int sh2 = Tools::randomInt(rdm, 1, nbShifts_ - 1);// make sure shift 0 is not taken
 
     // save the demand on day1/shift1
     int minDemandTmp, optDemandTmp;
@@ -167,13 +339,8 @@ void Demand::swapShifts(int nbSwaps) {
     optDemandTmp = optDemand_[day1][sh1][sk];
 
     // make the modification in the demand
-    minDemand_[day1][sh1][sk] = minDemand_[day2][sh2][sk];
-    optDemand_[day1][sh1][sk] = optDemand_[day2][sh2][sk];
-
-    minDemand_[day2][sh2][sk] = minDemandTmp;
-    optDemand_[day2][sh2
-
-    ][sk] = optDemandTmp;
+    setDemand(day1, sh1, sk, minDemand_[day2][sh2][sk], optDemand_[day2][sh2][sk]);
+    setDemand(day2, sh2, sk, minDemandTmp, optDemandTmp);
   }
 }
 
@@ -184,9 +351,9 @@ void Demand::swapShifts(int nbSwaps) {
 // for a given skill the demand on a shift cannot become greater than the
 // largest demand observed on the week
 //
-void Demand::perturbShifts(int minPerturb, int maxPerturb) {
+void Demand::perturbShifts(std::minstd_rand& rdm, int minPerturb, int maxPerturb) {
   // generate the number of perturbations
-  int nbPerturb = Tools::randomInt(minPerturb, maxPerturb);
+  int nbPerturb = Tools::randomInt(rdm, minPerturb, maxPerturb);
   int valPerturb = (nbPerturb>=0)? 1:-1;
   nbPerturb = fabs(nbPerturb);
 
@@ -202,53 +369,40 @@ void Demand::perturbShifts(int minPerturb, int maxPerturb) {
     bool isAtUpperBound = true;
     int day, sh, sk;
     while (isAtUpperBound && coTrials < 10*nbPerturb) {
-      day = Tools::randomInt(0, nbDays_ - 1);
-      sh = Tools::randomInt(1, nbShifts_ - 1); // make sure shift 0 is not taken
-      sk = Tools::randomInt(0, nbSkills_ - 1);
+      day = Tools::randomInt(rdm, 0, nbDays_ - 1);
+      sh = Tools::randomInt(rdm, 1, nbShifts_ - 1); // make sure shift 0 is not taken
+      sk = Tools::randomInt(rdm, 0, nbSkills_ - 1);
       isAtUpperBound = (valPerturb >= 0)? (minDemand_[day][sh][sk] >= minHighestPerSkill_[sk]):false;
       coTrials++;
     }
     if (coTrials >= 10*nbPerturb) break;
 
     // perturb the demand
-    minDemand_[day][sh][sk] += valPerturb;
-    optDemand_[day][sh][sk] += valPerturb;
+    setDemand(day, sh, sk, minDemand_[day][sh][sk]+valPerturb, optDemand_[day][sh][sk]+valPerturb);
   }
 }
 
 // copy the input demand and apply a perturbation to generate random demand
 //
-PDemand Demand::randomPerturbation() {
+PDemand Demand::randomPerturbation(std::minstd_rand& rdm) {
   PDemand pDemand = std::make_shared<Demand>(*this);
+  if (!pDemand->isPreprocessed_) pDemand->preprocessDemand();
 
   // three different types of perturbations are made
   // the order does not seem to be important
-  pDemand->swapDays(nbDays_/2);
-  pDemand->swapShifts(nbDays_*nbSkills_);
-  pDemand->perturbShifts(-nbDays_,nbDays_);
-
-  // get the main characteristics of the new demand
-  pDemand->preprocessDemand();
+  // the main characteristics of the new demand are updated along the way
+  pDemand->swapDays(rdm, nbDays_/2);
+  pDemand->swapShifts(rdm, nbDays_*nbSkills_);
+  pDemand->perturbShifts(rdm, -nbDays_,nbDays_);
 
   return pDemand;
 }
 
 // Keep the preferences relative to the days in [begin,end)
 PDemand Demand::keep(int begin, int end){
+   // the new demand is a view on the days of this one
    PDemand pDemand = std::make_shared<Demand>(*this);
-
-   pDemand->minDemand_.erase(pDemand->minDemand_.begin()+end,pDemand->minDemand_.end());
-	pDemand->optDemand_.erase(pDemand->optDemand_.begin()+end,pDemand->optDemand_.end());
-
-	if (begin > 0) {
-		pDemand->minDemand_.erase(pDemand->minDemand_.begin(),pDemand->minDemand_.begin()+begin);
-		pDemand->optDemand_.erase(pDemand->optDemand_.begin(),pDemand->optDemand_.begin()+begin);
-	}
-
-   // update the number of days and indicate that this particular demand has not
-   // been preprocessed
-   pDemand->nbDays_ = end-begin;
-   pDemand->isPreprocessed_ = false;
+   pDemand->restrictToDays(begin, end);
 
    return pDemand;
 }
@@ -256,42 +410,25 @@ PDemand Demand::keep(int begin, int end){
 // shorten the demand by keeping only the nbDays first days
 //
 void Demand::keepFirstNDays(int nbDays) {
-
-  minDemand_.erase(minDemand_.begin()+nbDays,minDemand_.end());
-  optDemand_.erase(optDemand_.begin()+nbDays,optDemand_.end());
-
-  // update the number of days and indicate that this particular demand has not
-  // been preprocessed
-  nbDays_ = nbDays;
-  isPreprocessed_ = false;
+  restrictToDays(0, nbDays);
 }
 
 // shorten the demand by removing the nbDays first days
 //
 void Demand::removeFirstNDays(int nbDays) {
-
-  minDemand_.erase(minDemand_.begin(),minDemand_.begin()+nbDays);
-  optDemand_.erase(optDemand_.begin(),optDemand_.begin()+nbDays);
-
-  // update the number of days and indicate that this particular demand has not
-  // been preprocessed
-  nbDays_ = nbDays_-nbDays;
-  isPreprocessed_ = false;
+  restrictToDays(nbDays, nbDays_);
 }
 
 // remove a list of skills from the demand
 //
 void Demand::removeSkills(std::vector<int> skills) {
+  if (!isPreprocessed_) this->preprocessDemand();
 
-  // make sure that the indices of skills are ordered
-  std::stable_sort(skills.begin(),skills.end());
-
-  // erase the skills for each day/shift
+  // set the demand of the skills to zero for each day/shift
   for (int day = 0; day < nbDays_; day++) {
     for (int shift = 0; shift < nbShifts_; shift++) {
-      for (int skill= skills.size()-1; skill >= 0; skill--) {
-        minDemand_[day][shift].erase(minDemand_[day][shift].begin()+skill);
-        optDemand_[day][shift].erase(optDemand_[day][shift].begin()+skill);
+      for (int skill: skills) {
+        setDemand(day, shift, skill, 0, 0);
       }
     }
   }
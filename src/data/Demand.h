@@ -16,6 +16,79 @@
 class Demand;
 typedef std::shared_ptr<Demand> PDemand;
 
+//-----------------------------------------------------------------------------
+//
+//	C l a s s  D e m a n d T a b l e
+//
+// Demand of each day, shift and skill stored in one contiguous buffer
+// The days are the outer dimension, so that a range of days is a slice of the
+// buffer: the slices share the buffer of the table they come from and the
+// buffer is copied only when a shared slice is modified
+//
+//-----------------------------------------------------------------------------
+
+class DemandTable {
+
+public:
+
+  DemandTable(): nbDays_(0), nbShifts_(0), nbSkills_(0), first_(0) {}
+  DemandTable(int nbDays, int nbShifts, int nbSkills, int val = 0);
+  explicit DemandTable(const vector3D<int>& demand);
+
+  // strided view on the demand of one day: view[shift][skill]
+  //
+  class DayView {
+  public:
+    DayView(const int* pDay, int nbSkills): pDay_(pDay), nbSkills_(nbSkills) {}
+    const int* operator[](int shift) const {return pDay_+shift*nbSkills_;}
+  private:
+    const int* pDay_;
+    int nbSkills_;
+  };
+
+  // read access: table[day][shift][skill]
+  // the demand is modified only through set, add and swapDays
+  //
+  DayView operator[](int day) const {return DayView(data()+day*dayStride(), nbSkills_);}
+  int get(int day, int shift, int skill) const {return data()[index(day, shift, skill)];}
+
+  int nbDays() const {return nbDays_;}
+  int nbShifts() const {return nbShifts_;}
+  int nbSkills() const {return nbSkills_;}
+  int dayStride() const {return nbShifts_*nbSkills_;}
+  int index(int day, int shift, int skill) const {return day*dayStride()+shift*nbSkills_+skill;}
+  const int* data() const {return buffer_ ? buffer_->data()+first_ : nullptr;}
+
+  // modify the demand
+  //
+  void set(int day, int shift, int skill, int val) {mutableData()[index(day, shift, skill)] = val;}
+  void add(int day, int shift, int skill, int val) {mutableData()[index(day, shift, skill)] += val;}
+  void swapDays(int day1, int day2);
+
+  // view on the days in [begin,end) without copy
+  //
+  DemandTable slice(int begin, int end) const;
+
+  // add the days of another table at the end of this one
+  //
+  void append(const DemandTable& table);
+
+protected:
+
+  // dimensions of the view
+  int nbDays_, nbShifts_, nbSkills_;
+
+  // index of the first element of the view in the buffer
+  int first_;
+
+  // buffer that may be shared with other views
+  std::shared_ptr<std::vector<int>> buffer_;
+
+  // pointer on the first element of the view, the view gets its own buffer
+  // if it shared it
+  int* mutableData();
+};
+
 //-----------------------------------------------------------------------------
 //
 //	C l a s s  D e m a n d
@@ -26,12 +99,17 @@ typedef std::shared_ptr<Demand> PDemand;
 
 class Demand {
 
+  // the snapshots restore the demand with its aggregated attributes
+  friend class ScenarioSnapshot;
+
 public:
 
   // generic constructor and destructor
 	Demand(): name_(""), nbDays_(0), firstDay_(0), nbShifts_(0), nbSkills_(0){}
   Demand(int nbDays, int firstDay, int nbShifts, int nbSkills, std::string name,
   vector3D<int> minDemand, vector3D<int> optDemand);
+  Demand(int nbDays, int firstDay, int nbShifts, int nbSkills, std::string name,
+  DemandTable minDemand, DemandTable optDemand);
   ~Demand();
 
   // constant attributes of the demand
@@ -51,9 +129,11 @@ public:
   const int nbShifts_, nbSkills_;
 
   // minimum and optimal demand for each day, shift and skill
+  // the tables are modified with setDemand so that the aggregated attributes
+  // below remain up to date
   //
-  vector3D<int> minDemand_;
-  vector3D<int> optDemand_;
+  DemandTable minDemand_;
+  DemandTable optDemand_;
 
 public:
 
@@ -62,6 +142,8 @@ public:
   int minTotal_, optTotal_;
 
   // preprocessed attributes aggregating the information of the demand
+  // they are computed at the construction and then updated incrementally by
+  // every method that modifies the demand
   //
   bool isPreprocessed_;
 
@@ -81,16 +163,29 @@ public:
   //
   std::vector<int> minHighestPerSkill_, optHighestPerSkill_;
 
+  // number of modifications of the demand since its construction: the data
+  // cached from a demand is up to date if the demand has the same version
+  //
+  int version() const {return version_;}
+
 protected:
 
+  // incremented by every method that modifies the demand
+  int version_ = 0;
+
+  // constructor of a demand whose aggregated attributes are set afterwards:
+  // the demand is not preprocessed
+  Demand(int nbDays, int firstDay, int nbShifts, int nbSkills, std::string name,
+  DemandTable minDemand, DemandTable optDemand, bool isPreprocessed);
+
   // modify the demand by randomly swapping the demand of nnSwaps days
   //
-  void swapDays(int nbSwaps);
+  void swapDays(std::minstd_rand& rdm, int nbSwaps);
 
   // modify the demand by randomly swapping the demand of nbSwaps shifts
   // the swapped shifts necessarily correspond to the same skill
   //
-  void swapShifts(int nbSwaps);
+  void swapShifts(std::minstd_rand& rdm, int nbSwaps);
 
   // perturb the demand by adding demand in a number of shifts randomly chosen
   // in the interval [minPerturb,maxPerturb]
@@ -98,7 +193,22 @@ protected:
   // for a given skill the demand on a shift cannot become greater than the
   // largest demand observed on the week
   //
-  void perturbShifts(int minPerturb, int maxPerturb);
+  void perturbShifts(std::minstd_rand& rdm, int minPerturb, int maxPerturb);
+
+  // add (sign=1) or remove (sign=-1) the demand of the days in [begin,end) to
+  // the totals per shift and per skill
+  // the skills whose highest demand is reached on one of these days are
+  // flagged in isHighestReached
+  //
+  void addDaysToTotals(int begin, int end, int sign, std::vector<bool>& isHighestReached);
+
+  // compute the highest demand of a skill over the considered period
+  //
+  void computeHighestOfSkill(int skill);
+
+  // keep only the days in [begin,end) and update the aggregated attributes
+  //
+  void restrictToDays(int begin, int end);
 
 public:
 
@@ -109,6 +219,10 @@ public:
   // this includes the total demand per skill, per shift,
   void preprocessDemand();
 
+  // set the minimum and optimal demand of a day, shift and skill and update
+  // the aggregated attributes
+  void setDemand(int day, int shift, int skill, int minDemand, int optDemand);
+
   // add another week demand at the end of the current one
   // update all the parameters
   void push_back(PDemand pDemand);
@@ -122,8 +236,9 @@ public:
   std::string toString(bool withPreprocessedInfo);
 
   // copy the input demand and apply a perturbation to generate random demand
+  // the draws are made with the input random generator
   //
-  PDemand randomPerturbation();
+  PDemand randomPerturbation(std::minstd_rand& rdm);
 
   // shorten the demand by keeping only the nbDays in [begin, end)
   // return a new demand
@@ -138,6 +253,8 @@ public:
   void removeFirstNDays(int nbDays);
 
 	// remove a list of skills from the demand
+	// the skills are kept in the tables with a null demand, so that the indices
+	// of the skills of the scenario remain valid
 	//
 	void removeSkills(std::vector<int> skills);
 
@@ -209,6 +209,8 @@ Preferences::Preferences(int nbNurses, int nbDays, int nbShifts) :
     wishesOff_[i];
     wishesOn_[i];
 	}
+	Tools::initVector2D(levelsOff_, nbNurses_, nbDays_*nbShifts_, (int8_t) -1);
+	Tools::initVector2D(levelsOn_, nbNurses_, nbDays_*nbShifts_, (int8_t) -1);
 }
 
 // Initialization with a map corresponding to the input nurses and no wished Shift-Off.
@@ -219,6 +221,16 @@ Preferences::Preferences(const vector<PNurse>& nurses, int nbDays, int nbShifts)
     wishesOff_[pNurse->id_];
     wishesOn_[pNurse->id_];
 	}
+	// the tables are indexed by the ids of the nurses, which may not be
+	// consecutive (e.g. nurses of a connex component)
+	for(PNurse pNurse: nurses){
+	  if (pNurse->id_ >= (int) levelsOff_.size()) {
+	    levelsOff_.resize(pNurse->id_+1);
+	    levelsOn_.resize(pNurse->id_+1);
+	  }
+	  levelsOff_[pNurse->id_].assign(nbDays_*nbShifts_, -1);
+	  levelsOn_[pNurse->id_].assign(nbDays_*nbShifts_, -1);
+	}
 }
 
 
@@ -236,17 +248,52 @@ int Preferences::wishLevel(const std::map<int, std::vector<Wish> > &wishes, int
   return -1;
 }
 
+// Set the level of a wish in a dense table
+void Preferences::setLevel(vector2D<int8_t>& levels, int nurseId, int day, int shift, PREF_LEVEL level){
+  if (nurseId < 0 || day < 0 || shift < 0 || shift >= nbShifts_) {
+    Tools::throwError("Preferences: wish of nurse " + std::to_string(nurseId) + " on day " + std::to_string(day)
+      + " for shift " + std::to_string(shift) + " is out of range");
+  }
+  version_++;
+  // both tables have a row for every nurse, so that the lookups stay in range
+  if (nurseId >= (int) levelsOff_.size()) levelsOff_.resize(nurseId+1);
+  if (nurseId >= (int) levelsOn_.size()) levelsOn_.resize(nurseId+1);
+  std::vector<int8_t>& nurseLevels = levels[nurseId];
+  unsigned int i = day*nbShifts_+shift;
+  if (i >= nurseLevels.size()) nurseLevels.resize((day+1)*nbShifts_, -1);
+  if (nurseLevels[i] == -1) nurseLevels[i] = level;
+}
+
+// Copy the days [begin,end) of each row of a dense table in newLevels
+void Preferences::copyLevels(const vector2D<int8_t>& levels, vector2D<int8_t>& newLevels,
+                             int begin, int end, int offset) const {
+  if (levels.size() > newLevels.size()) newLevels.resize(levels.size());
+  for (unsigned int n=0; n < levels.size(); n++) {
+    // the days after the end of the row have no wish
+    const std::vector<int8_t>& nurseLevels = levels[n];
+    int last = std::min((int) nurseLevels.size(), end*nbShifts_);
+    std::vector<int8_t>& nurseNewLevels = newLevels[n];
+    nurseNewLevels.resize(std::max((int) nurseNewLevels.size(), (offset+end-begin)*nbShifts_), -1);
+    if (begin*nbShifts_ < last)
+      std::copy(nurseLevels.begin()+begin*nbShifts_, nurseLevels.begin()+last,
+                nurseNewLevels.begin()+offset*nbShifts_);
+  }
+}
+
 // Add a wished day-shift off for a nurse
 void Preferences::addShiftOff(int nurseId, int day, int shift, PREF_LEVEL level){
 	// Insert the wished shift in the set
 	wishesOff_[nurseId][day].push_back({shift, level});
+	setLevel(levelsOff_, nurseId, day, shift, level);
 }
 
 // Adds the whole day to the wish-list
 void Preferences::addDayOff(int nurseId, int day, PREF_LEVEL level){
 	vector<Wish>& wishList = wishesOff_[nurseId][day];
-	for(int s=1; s<nbShifts_; s++)           // Starts from 1 because it's a rest wish
+	for(int s=1; s<nbShifts_; s++) {         // Starts from 1 because it's a rest wish
 	  wishList.push_back({s, level});
+	  setLevel(levelsOff_, nurseId, day, s, level);
+	}
 }
 
 // Returns true if the nurse wants that shift off
@@ -254,19 +301,6 @@ bool Preferences::wantsTheShiftOff(int nurseId, int day, int shift) const{
   return wantsTheShiftOffLevel(nurseId, day, shift) != -1;
 }
 
-// Returns level if the nurse wants that shift off : -1 otherwise
-int Preferences::wantsTheShiftOffLevel(int nurseId, int day, int shift) const {
-	// If the day is not in the wish-list, return -1
-	auto itM = wishesOff_.at(nurseId).find(day);
-	if(itM == wishesOff_.at(nurseId).end())
-	  return -1;
-	// If the shift is not in the wish-list for that day, return -1
-	const std::vector<Wish> &wishes = itM->second;
-	for(const Wish &wish: wishes)
-	  if(wish.shift == shift) return wish.level;
-  return -1;
-}
-
 // True if the nurse wants the whole day off
 bool Preferences::wantsTheDayOff(int nurseId, int day) const{
 	// If the day is not in the wish-list, return false
@@ -304,13 +338,16 @@ int Preferences::howManyDaysOff(int nurseId, int dayMin, int dayMax) const {
 void Preferences::addShiftOn(int nurseId, int day, int shift, PREF_LEVEL level){
   // Insert the wished shift in the set
   wishesOn_[nurseId][day].push_back({shift, level});
+  setLevel(levelsOn_, nurseId, day, shift, level);
 }
 
 // Adds the whole day to the wish-list
 void Preferences::addDayOn(int nurseId, int day, PREF_LEVEL level){
   vector<Wish>& wishList = wishesOn_[nurseId][day];
-  for(int s=1; s<nbShifts_; s++)           // Starts from 1 because it's a rest wish
+  for(int s=1; s<nbShifts_; s++) {         // Starts from 1 because it's a rest wish
     wishList.push_back({s, level});
+    setLevel(levelsOn_, nurseId, day, s, level);
+  }
 }
 
 // Returns true if the nurse wants that shift on
@@ -318,18 +355,6 @@ bool Preferences::wantsTheShiftOn(int nurseId, int day, int shift) const{
   return wantsTheShiftOnLevel(nurseId, day, shift) != -1;
 }
 
-// Returns level if the nurse wants that shift on : -1 otherwise
-int Preferences::wantsTheShiftOnLevel(int nurseId, int day, int shift) const{
-  // If the day is not in the wish-list, return -1
-  auto itM = wishesOn_.at(nurseId).find(day);
-  if(itM == wishesOn_.at(nurseId).end())
-    return -1;
-  // If the shift is not in the wish-list for that day, return -1
-  for(const Wish &wish: itM->second)
-    if(wish.shift == shift) return wish.level;
-  return -1;
-}
-
 // True if the nurse wants the whole day on
 bool Preferences::wantsTheDayOn(int nurseId, int day) const{
   // If the day is not in the wish-list, return false
@@ -384,14 +409,21 @@ void Preferences::push_back(PPreferences pPref){
       wishes.insert(wishes.end(), pWishes2.second.begin(), pWishes2.second.end());
     }
 
+  // append the days of the dense tables
+  copyLevels(pPref->levelsOff_, levelsOff_, 0, pPref->nbDays_, nbDays_);
+  copyLevels(pPref->levelsOn_, levelsOn_, 0, pPref->nbDays_, nbDays_);
+
   // update the number of days
   nbDays_  += pPref->nbDays_;
+  version_++;
 }
 
 // K the preferences relative to the nbDays first days
 PPreferences Preferences::keep(int begin, int end) {
 
-   PPreferences pPref = std::make_shared<Preferences>();
+   PPreferences pPref = std::make_shared<Preferences>(nbNurses_, end-begin, nbShifts_);
+   copyLevels(levelsOff_, pPref->levelsOff_, begin, end, 0);
+   copyLevels(levelsOn_, pPref->levelsOn_, begin, end, 0);
 
    for (int i=0; i < nbNurses_; i++) {
      for(pair<int,std::vector<Wish> > pair1: wishesOff_[i]){
@@ -415,19 +447,21 @@ PPreferences Preferences::keep(int begin, int end) {
 // Remove the preferences relative to the nbDays first days
 PPreferences Preferences::removeNFirstDays(int nbDays) {
 
-	PPreferences pPref = std::make_shared<Preferences>();
+	PPreferences pPref = std::make_shared<Preferences>(nbNurses_, nbDays_-nbDays, nbShifts_);
+	copyLevels(levelsOff_, pPref->levelsOff_, nbDays, nbDays_, 0);
+	copyLevels(levelsOn_, pPref->levelsOn_, nbDays, nbDays_, 0);
 
 	for (int i=0; i < nbNurses_; i++) {
     for(pair<int,std::vector<Wish> > pair1: wishesOff_[i]){
       if (pair1.first >= nbDays) {
-        pair<int,std::vector<Wish> > pair2(pair1.first-nbDays_, pair1.second);
+        pair<int,std::vector<Wish> > pair2(pair1.first-nbDays, pair1.second);
         pPref->wishesOff_[i].insert(pair2);
       }
     }
 
 		for(pair<int,std::vector<Wish> > pair1: wishesOn_[i]){
 			if (pair1.first >= nbDays) {
-				pair<int,std::vector<Wish> > pair2(pair1.first-nbDays_, pair1.second);
+				pair<int,std::vector<Wish> > pair2(pair1.first-nbDays, pair1.second);
 				pPref->wishesOn_[i].insert(pair2);
 			}
 		}
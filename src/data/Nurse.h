@@ -6,6 +6,8 @@
 #ifndef __Nurse__
 #define __Nurse__
 
+#include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <set>
@@ -87,6 +89,9 @@ public:
 
 class Position{
 
+   // the snapshots restore the hierarchy of the positions
+   friend class ScenarioSnapshot;
+
 public:
    // Constructor and Destructor
    //
@@ -271,6 +276,9 @@ struct Wish {
 
 class Preferences{
 
+	// the snapshots save and restore the wishes
+	friend class ScenarioSnapshot;
+
 public:
 	// Constructor and destructor
 	Preferences();
@@ -300,11 +308,38 @@ protected:
 	// For each nurse, maps the day to the set of shifts that he/she wants to have off
 	//
   //	map<int, map<int,std::set<int> > > wishesOff_;
+  // These maps are only the sparse index of the wishes (printing, counts and
+  // iterations over the wishes of a nurse)
   std::map<int, std::map<int,std::vector<Wish> > > wishesOff_;
   std::map<int, std::map<int,std::vector<Wish> > > wishesOn_;
 
+  // For each nurse id, dense table of the levels of the wishes indexed by
+  // day*nbShifts_+shift (-1 if no wish), so that a lookup is a single load
+  // The days after the end of a table have no wish
+  //
+  vector2D<int8_t> levelsOff_;
+  vector2D<int8_t> levelsOn_;
+
+  // incremented by every method that modifies the wishes
+  int version_ = 0;
+
+  // Set the level of a wish in a dense table, the first wish of a day-shift is
+  // kept as in the sparse index
+  // Every wish goes through this method, which throws if its nurse, day or
+  // shift is out of range
+  void setLevel(vector2D<int8_t>& levels, int nurseId, int day, int shift, PREF_LEVEL level);
+
+  // Copy the days [begin,end) of each row of a dense table in the same row of
+  // newLevels, starting at the day offset
+  void copyLevels(const vector2D<int8_t>& levels, vector2D<int8_t>& newLevels,
+                  int begin, int end, int offset) const;
+
 public:
 
+	// number of modifications of the wishes since the construction: the data
+	// cached from the preferences is up to date if they have the same version
+	int version() const {return version_;}
+
 	// For a given day, and a given shift, adds it to the wish-list for OFF-SHIFT
   //	void addShiftOff(int nurse, int day, int shift);
         void addShiftOff(int nurse, int day, int shift, PREF_LEVEL level);
@@ -324,8 +359,22 @@ public:
   bool wantsTheShiftOn(int nurse, int day, int shift) const;
 
   // Returns level if the nurse wants that shift off : -1 otherwise
-  int wantsTheShiftOffLevel(int nurseId, int day, int shift) const;
-  int wantsTheShiftOnLevel(int nurseId, int day, int shift) const;
+  // These lookups are on the hot path of the cost evaluation: the indices are
+  // only checked by assertions, the wishes being checked when they are added
+  int wantsTheShiftOffLevel(int nurseId, int day, int shift) const {
+    assert(nurseId >= 0 && nurseId < (int) levelsOff_.size());
+    assert(day >= 0 && shift >= 0 && shift < nbShifts_);
+    const std::vector<int8_t>& levels = levelsOff_[nurseId];
+    unsigned int i = day*nbShifts_+shift;
+    return i < levels.size() ? levels[i] : -1;
+  }
+  int wantsTheShiftOnLevel(int nurseId, int day, int shift) const {
+    assert(nurseId >= 0 && nurseId < (int) levelsOn_.size());
+    assert(day >= 0 && shift >= 0 && shift < nbShifts_);
+    const std::vector<int8_t>& levels = levelsOn_[nurseId];
+    unsigned int i = day*nbShifts_+shift;
+    return i < levels.size() ? levels[i] : -1;
+  }
   
 	// True if the nurses wants the whole day off
 	bool wantsTheDayOff(int nurse, int day) const;
@@ -2,6 +2,9 @@
 #include "data/Roster.h"
 #include "tools/MyTools.h"
 
+#include <algorithm>
+#include <cstring>
+
 
 using std::vector;
 using std::map;
@@ -129,3 +132,178 @@ void Roster::copy(Roster& roster) {
     skills_.push_back(roster.skill(day));
   }
 }
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   R o s t e r B i t s
+//
+//-----------------------------------------------------------------------------
+
+// first day of the roster from the input day that is a sunday, the day ids of
+// the roster following that of the initial state
+//
+static int nextSunday(int day, int dayIdIni) {
+  return day + ((6-dayIdIni-day)%7+7)%7;
+}
+
+// Build the image of the roster that follows the input initial state
+//
+void RosterBits::build(const Roster& roster, const State& stateIni, PScenario pScenario) {
+  if (stateIni.shiftType_ < 0) {
+    Tools::throwError("RosterBits::build: the shift type of the initial state is not assigned!");
+  }
+  nbDays_ = roster.nbDays();
+  stateIni_ = stateIni;
+  pScenario_ = pScenario;
+
+  // the time worked is a popcount when all the shifts have the same duration
+  timePerShift_ = -1;
+  for (int shift = 1; shift < pScenario->nbShifts_; shift++) {
+    int time = pScenario->timeDurationToWork_[shift];
+    if (shift == 1) timePerShift_ = time;
+    else if (time != timePerShift_) {
+      timePerShift_ = -1;
+      break;
+    }
+  }
+
+  worked_.assign((nbDays_+63)/64, 0);
+  weekendsWorked_.assign((nbDays_+63)/64, 0);
+  shiftTypes_.assign((nbDays_+7)/8*8, 0);
+  timeWorked_.assign(nbDays_, 0);
+  for (int day = 0; day < nbDays_; day++) setDay(roster, day);
+  for (int sunday = nextSunday(0, stateIni.dayId_); sunday < nbDays_; sunday += 7) setWeekend(sunday);
+}
+
+// Update the image after a change of the roster from firstDay to lastDay
+// The weekend of the sunday that follows lastDay depends on its saturday
+//
+void RosterBits::update(const Roster& roster, int firstDay, int lastDay) {
+  firstDay = std::max(0, firstDay);
+  lastDay = std::min(nbDays_-1, lastDay);
+  for (int day = firstDay; day <= lastDay; day++) setDay(roster, day);
+
+  int lastSunday = std::min(nbDays_-1, lastDay+1);
+  for (int sunday = nextSunday(firstDay, stateIni_.dayId_); sunday <= lastSunday; sunday += 7) setWeekend(sunday);
+}
+
+void RosterBits::setDay(const Roster& roster, int day) {
+  int shift = roster.shift(day), shiftType = pScenario_->shiftIDToShiftTypeID_[shift];
+  uint64_t bit = 1ULL << (day&63);
+  shiftTypes_[day] = shiftType;
+  if (shiftType > 0) {
+    worked_[day>>6] |= bit;
+    timeWorked_[day] = pScenario_->timeDurationToWork_[shift];
+  }
+  else {
+    worked_[day>>6] &= ~bit;
+    timeWorked_[day] = 0;
+  }
+}
+
+// same rule as State::addDayToState
+//
+void RosterBits::setWeekend(int sunday) {
+  bool isSaturdayWorked = sunday ? isWorked(sunday-1) : stateIni_.shiftType_ > 0;
+  uint64_t bit = 1ULL << (sunday&63);
+  if (isWorked(sunday) || isSaturdayWorked) weekendsWorked_[sunday>>6] |= bit;
+  else weekendsWorked_[sunday>>6] &= ~bit;
+}
+
+// number of bits set from bit 0 to bit day (included)
+//
+static int countBitsUntil(const std::vector<uint64_t>& bits, int day) {
+  if (day < 0) return 0;
+  int count = 0, lastWord = day>>6;
+  for (int w = 0; w < lastWord; w++) count += __builtin_popcountll(bits[w]);
+  uint64_t mask = (day&63) == 63 ? ~0ULL : (1ULL << ((day&63)+1))-1;
+  return count + __builtin_popcountll(bits[lastWord] & mask);
+}
+
+int RosterBits::totalTimeWorked(int day) const {
+  int time = stateIni_.totalTimeWorked_;
+  if (timePerShift_ >= 0) return time + timePerShift_*countBitsUntil(worked_, day);
+  for (int d = 0; d <= day; d++) time += timeWorked_[d];
+  return time;
+}
+
+int RosterBits::totalWeekendsWorked(int day) const {
+  return stateIni_.totalWeekendsWorked_ + countBitsUntil(weekendsWorked_, day);
+}
+
+// The sequences are scanned by words of 64 days: the number of leading bits
+// equal to that of the input day gives the length of the sequence in a word
+// The sequences that start on the first day extend those of the initial state
+//
+int RosterBits::consDaysWorked(int day) const {
+  if (day < 0) return stateIni_.consDaysWorked_;
+  int length = 0;
+  for (int w = day>>6, b = day&63; w >= 0; w--, b = 63) {
+    uint64_t rest = ~worked_[w] << (63-b);
+    if (rest) return length+__builtin_clzll(rest);
+    length += b+1;
+  }
+  return length+stateIni_.consDaysWorked_;
+}
+
+int RosterBits::consDaysOff(int day) const {
+  if (day < 0) return stateIni_.consDaysOff_;
+  int length = 0;
+  for (int w = day>>6, b = day&63; w >= 0; w--, b = 63) {
+    uint64_t work = worked_[w] << (63-b);
+    if (work) return length+__builtin_clzll(work);
+    length += b+1;
+  }
+  return length+stateIni_.consDaysOff_;
+}
+
+// The shift types are compared by blocks of eight days: the first different
+// byte of the block is found with a bit scan
+//
+int RosterBits::consShifts(int day) const {
+  if (day < 0) return stateIni_.consShifts_;
+  int shiftType = shiftTypes_[day];
+  if (!shiftType) return 0;
+
+  uint64_t pattern = 0x0101010101010101ULL*shiftType;
+  int length = 0, last = day;
+  for (; last >= 7; last -= 8) {
+    uint64_t block;
+    memcpy(&block, &shiftTypes_[last-7], 8);
+    block ^= pattern;
+    if (block) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      return length+__builtin_ctzll(block)/8;
+#else
+      return length+__builtin_clzll(block)/8;
+#endif
+    }
+    length += 8;
+  }
+  for (; last >= 0; last--, length++) {
+    if (shiftTypes_[last] != shiftType) return length;
+  }
+  return length+(stateIni_.shiftType_ == shiftType ? stateIni_.consShifts_ : 0);
+}
+
+// The first change of the worked days after the input day is found with a
+// bit scan
+//
+int RosterBits::lastDayOfSequence(int day) const {
+  uint64_t flip = isWorked(day) ? ~0ULL : 0;
+  for (int w = day>>6, b = day&63; w < (int) worked_.size(); w++, b = 0) {
+    uint64_t change = (worked_[w] ^ flip) & (~0ULL << b);
+    if (change) return std::min(nbDays_, (w<<6)+__builtin_ctzll(change))-1;
+  }
+  return nbDays_-1;
+}
+
+// State of the nurse after the input number of days of the roster
+//
+State RosterBits::state(const Roster& roster, int nbDays) const {
+  if (nbDays == 0) return stateIni_;
+  int day = nbDays-1;
+  return State(stateIni_.dayId_+nbDays, totalTimeWorked(day), totalWeekendsWorked(day), consDaysWorked(day),
+    consShifts(day), consDaysOff(day), shiftType(day), roster.shift(day));
+}
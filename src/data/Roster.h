@@ -6,6 +6,7 @@
 #ifndef __Solver__
 #define __Solver__
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -81,8 +82,8 @@ private:
 public:
   // Basic getters
   //
-  int firstDay() {return firstDay_;}
-  int nbDays() {return nbDays_;}
+  int firstDay() const {return firstDay_;}
+  int nbDays() const {return nbDays_;}
   int shift(int day) const {return shifts_[day];}
   int skill(int day) const {return skills_[day];}
 
@@ -114,4 +115,84 @@ public:
 };
 
 
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   R o s t e r B i t s
+//
+//  Bit-parallel image of a roster: one bit per worked day and the shift type
+//  of each day packed in bytes
+//  The counters of the states (time and weekends worked, consecutive worked
+//  days, days off and shifts) are computed with popcounts and bit scans, so
+//  that the state at the end of any day is obtained without building the
+//  states of all the previous days
+//
+//-----------------------------------------------------------------------------
+
+class RosterBits {
+
+public:
+  // build the image of the roster that follows the input initial state
+  // the shift type of the initial state must not be negative
+  //
+  void build(const Roster& roster, const State& stateIni, PScenario pScenario);
+
+  // update the image after a change of the roster from firstDay to lastDay
+  //
+  void update(const Roster& roster, int firstDay, int lastDay);
+
+  int nbDays() const {return nbDays_;}
+  const State& stateIni() const {return stateIni_;}
+  bool isWorked(int day) const {return (worked_[day>>6] >> (day&63)) & 1;}
+
+  // counters of the state of the nurse at the end of the input day
+  // the day -1 is that of the initial state
+  //
+  int shiftType(int day) const {return day < 0 ? stateIni_.shiftType_ : shiftTypes_[day];}
+  int totalTimeWorked(int day) const;
+  int totalWeekendsWorked(int day) const;
+  int consDaysWorked(int day) const;
+  int consDaysOff(int day) const;
+  int consShifts(int day) const;
+
+  // last day of the sequence of worked days or of days off that contains the
+  // input day
+  //
+  int lastDayOfSequence(int day) const;
+
+  // state of the nurse after the input number of days of the roster (the
+  // initial state for 0 days)
+  //
+  State state(const Roster& roster, int nbDays) const;
+
+protected:
+  int nbDays_ = 0;
+
+  // initial state and scenario
+  //
+  State stateIni_;
+  PScenario pScenario_;
+
+  // bit d is set if day d is worked, resp. if day d is a sunday of a weekend
+  // counted as worked
+  //
+  std::vector<uint64_t> worked_, weekendsWorked_;
+
+  // shift type of each day, padded with zeros to a multiple of eight days
+  //
+  std::vector<uint8_t> shiftTypes_;
+
+  // time worked on each day and on every worked shift of the scenario
+  // (-1 if the shifts do not all have the same duration)
+  //
+  std::vector<int> timeWorked_;
+  int timePerShift_ = -1;
+
+  // set the day of the image from the roster, resp. count the weekend of a
+  // sunday as worked if the sunday or the saturday is worked
+  //
+  void setDay(const Roster& roster, int day);
+  void setWeekend(int sunday);
+};
+
+
 #endif /* defined(__ATCSolver__CftSolver__)*/
@@ -166,7 +166,8 @@ Scenario::Scenario(string name, int nbWeeks,
 		   vector2D<int> shiftTypeIDToShiftID, vector<int> minConsShiftType, vector<int> maxConsShiftType,
 		   vector<int> nbForbiddenSuccessors, vector2D<int> forbiddenSuccessors,
 		   int nbContracts, vector<string> intToContract, map<string,PConstContract> contracts,
-		   int nbNurses, vector<PNurse>& theNurses, map<string,int> nurseNameToInt) :
+		   int nbNurses, vector<PNurse>& theNurses, map<string,int> nurseNameToInt,
+		   bool preprocessNurses) :
   name_(name), nbWeeks_(nbWeeks),
   nbSkills_(nbSkills), intToSkill_(intToSkill), skillToInt_(skillToInt),
   nbShifts_(nbShifts), intToShift_(intToShift), shiftToInt_(shiftToInt),
@@ -184,10 +185,12 @@ Scenario::Scenario(string name, int nbWeeks,
 	thisWeek_ = -1;
 	nbWeeksLoaded_ = 1;
 
+	this->initForbiddenSuccessions();
+
 	// Preprocess the vector of nurses
-	// This creates the positions
+	// This creates the positions, unless they are restored from a snapshot
 	//
-	this->preprocessTheNurses();
+	if (preprocessNurses) this->preprocessTheNurses();
 }
 
 // Hybrid copy constructor : this is only called when constructing a new scenario that copies most parameters
@@ -207,6 +210,8 @@ Scenario::Scenario(PScenario pScenario, const vector<PNurse>& theNurses, PDemand
   pWeekDemand_(nullptr), nbShiftOffRequests_(0), nbShiftOnRequests_(0), pWeekPreferences_(nullptr), thisWeek_(pScenario->thisWeek()), nbWeeksLoaded_(pScenario->nbWeeksLoaded()),
   nbPositions_(0), nursesPerPosition_(0){
 
+	this->initForbiddenSuccessions();
+
 	// Preprocess the vector of nurses
 	// This creates the positions
 	//
@@ -239,48 +244,37 @@ void Scenario::setWeekPreferences(PPreferences weekPreferences){
 // 	return false;
 // }
 
-// return true if the shift shNext is a forbidden successor of shift shLast (via types)
-
-bool Scenario::isForbiddenSuccessorShift_Shift(int shNext, int shLast) {
-	if (shLast <= 0) return false;
-
-	int  shTypeNext = shiftIDToShiftTypeID_[shNext];
-	int  shTypeLast = shiftIDToShiftTypeID_[shLast];
-
-	return isForbiddenSuccessorShiftType_ShiftType(shTypeNext, shTypeLast);
-}
-
-// return true if the shift shNext is a forbidden successor of shiftType shTypeLast
-
-bool Scenario::isForbiddenSuccessorShift_ShiftType(int shNext, int shTypeLast) {
-	if (shTypeLast <= 0) return false;
-
-	int  shTypeNext = shiftIDToShiftTypeID_[shNext];
-
-	return isForbiddenSuccessorShiftType_ShiftType(shTypeNext, shTypeLast);
-}
-
-// return true if the shiftType shTypeNext is a forbidden successor of shiftType shTypeLast
-
-bool Scenario::isForbiddenSuccessorShiftType_Shift(int shTypeNext, int shLast) {
-	if (shLast <= 0) return false;
-
-	int  shTypeLast = shiftIDToShiftTypeID_[shLast];
-
-	return isForbiddenSuccessorShiftType_ShiftType(shTypeNext, shTypeLast);
-}
-
-// return true if the shiftType shTypeNext is a forbidden successor of shiftType shTypeLast
-
-bool Scenario::isForbiddenSuccessorShiftType_ShiftType(int shTypeNext, int shTypeLast) {
-	if (shTypeLast <= 0) return false;
+// Compute the matrices of the forbidden successions from the lists of
+// forbidden successors of each shift type
+//
+void Scenario::initForbiddenSuccessions() {
+	forbiddenShiftType_ShiftType_.assign(nbShiftsType_*nbShiftsType_, 0);
+	for (int shTypeLast = 1; shTypeLast < nbShiftsType_; shTypeLast++) {
+		for (int i = 0; i < nbForbiddenSuccessors_[shTypeLast]; i++) {
+			forbiddenShiftType_ShiftType_[shTypeLast*nbShiftsType_+forbiddenSuccessors_[shTypeLast][i]] = 1;
+		}
+	}
 
-	for (int i = 0; i < nbForbiddenSuccessors_[shTypeLast]; i++) {
-		if (shTypeNext == forbiddenSuccessors_[shTypeLast][i])  {
-			return true;
+	// the other matrices translate the shifts into their types
+	forbiddenShift_Shift_.assign(nbShifts_*nbShifts_, 0);
+	forbiddenShift_ShiftType_.assign(nbShiftsType_*nbShifts_, 0);
+	forbiddenShiftType_Shift_.assign(nbShifts_*nbShiftsType_, 0);
+	for (int shTypeLast = 1; shTypeLast < nbShiftsType_; shTypeLast++) {
+		for (int shNext = 0; shNext < nbShifts_; shNext++) {
+			forbiddenShift_ShiftType_[shTypeLast*nbShifts_+shNext] =
+				forbiddenShiftType_ShiftType_[shTypeLast*nbShiftsType_+shiftIDToShiftTypeID_[shNext]];
+		}
+	}
+	for (int shLast = 1; shLast < nbShifts_; shLast++) {
+		int shTypeLast = shiftIDToShiftTypeID_[shLast];
+		for (int shNext = 0; shNext < nbShifts_; shNext++) {
+			forbiddenShift_Shift_[shLast*nbShifts_+shNext] = forbiddenShift_ShiftType_[shTypeLast*nbShifts_+shNext];
+		}
+		for (int shTypeNext = 0; shTypeNext < nbShiftsType_; shTypeNext++) {
+			forbiddenShiftType_Shift_[shLast*nbShiftsType_+shTypeNext] =
+				forbiddenShiftType_ShiftType_[shTypeLast*nbShiftsType_+shTypeNext];
 		}
 	}
-	return false;
 }
 
 const int Scenario::minTotalShiftsOf(int whichNurse) const {
@@ -382,10 +376,10 @@ string Scenario::toString(){
 	}
 	rep << "# " << std::endl;
 	rep << "# FORBIDDEN        " << std::endl;
-	for(int i=0; i<nbShifts_; i++){
-		rep << "#\t\t\t" << intToShift_[i] << "\t-> ";
+	for(int i=0; i<nbShiftsType_; i++){
+		rep << "#\t\t\t" << intToShiftType_[i] << "\t-> ";
 		for(int j=0; j<nbForbiddenSuccessors_[i]; j++){
-			rep << intToShift_[forbiddenSuccessors_[i][j]] << " ";
+			rep << intToShiftType_[forbiddenSuccessors_[i][j]] << " ";
 		}
 		rep << std::endl;
 	}
@@ -610,6 +604,11 @@ bool comparePairSecond(pair<int,int> p1, pair<int,int> p2) {
 //
 void Scenario::computeConnexPositions() {
 
+	// the components are computed again from the positions, even if they were
+	// already known (e.g. restored from a snapshot)
+	componentsOfConnexPositions_.clear();
+	nursesPerConnexComponentOfPositions_.clear();
+
 	vector<PPosition> pRemainingPositions(pPositions_);
 
 	PPosition pPos = pRemainingPositions.back();
@@ -7,6 +7,9 @@
 #define __Scenario__
 
 
+#include <algorithm>
+#include <cstdint>
+
 #include "tools/MyTools.h"
 #include "Demand.h"
 
@@ -119,6 +122,9 @@ public:
 
 class Scenario {
 
+	// the snapshots save and restore the preprocessed attributes
+	friend class ScenarioSnapshot;
+
 public:
 
 	// Constructor and destructor
@@ -131,7 +137,8 @@ public:
 		 std::vector<std::vector<int> > shiftTypeIDToShiftID, std::vector<int> minConsShiftsType, std::vector<int> maxConsShiftsType,
 		 std::vector<int> nbForbiddenSuccessors, vector2D<int> forbiddenSuccessors,
 		 int nbContracts, std::vector<std::string> intToContract, std::map<std::string,PConstContract> contracts,
-		 int nbNurses, std::vector<PNurse>& theNurses, std::map<std::string,int> nurseNameToInt);
+		 int nbNurses, std::vector<PNurse>& theNurses, std::map<std::string,int> nurseNameToInt,
+		 bool preprocessNurses = true);
 
 	// Hybrid copy constructor : this is only called when constructing a new scenario that copies most parameters
 	// from the input scenario but for only a subgroup of nurses
@@ -203,6 +210,18 @@ private:
 	const std::vector<int> nbForbiddenSuccessors_;
 	const vector2D<int> forbiddenSuccessors_;
 
+	// dense matrices of the forbidden successions, one row per last shift (or
+	// shift type) and one column per next shift (or shift type)
+	// the row of the rest is empty: the negative last shift types, i.e. the days
+	// without assignment, are mapped to it
+	//
+	std::vector<uint8_t> forbiddenShift_Shift_, forbiddenShift_ShiftType_;
+	std::vector<uint8_t> forbiddenShiftType_Shift_, forbiddenShiftType_ShiftType_;
+
+	// compute the matrices of the forbidden successions
+	//
+	void initForbiddenSuccessions();
+
 	//------------------------------------------------
 	// From the Week data file
 	//------------------------------------------------
@@ -361,10 +380,18 @@ public:
 
 	// return true if the shift shNext is a forbidden successor of shLast
 	//
-	bool isForbiddenSuccessorShift_Shift(int shNext, int shLast);
-	bool isForbiddenSuccessorShift_ShiftType(int shNext, int shTypeLast);
-	bool isForbiddenSuccessorShiftType_Shift(int shTypeNext, int shLast);
-	bool isForbiddenSuccessorShiftType_ShiftType(int shTypeNext, int shTypeLast);
+	bool isForbiddenSuccessorShift_Shift(int shNext, int shLast) const {
+		return forbiddenShift_Shift_[std::max(shLast, 0)*nbShifts_+shNext];
+	}
+	bool isForbiddenSuccessorShift_ShiftType(int shNext, int shTypeLast) const {
+		return forbiddenShift_ShiftType_[std::max(shTypeLast, 0)*nbShifts_+shNext];
+	}
+	bool isForbiddenSuccessorShiftType_Shift(int shTypeNext, int shLast) const {
+		return forbiddenShiftType_Shift_[std::max(shLast, 0)*nbShiftsType_+shTypeNext];
+	}
+	bool isForbiddenSuccessorShiftType_ShiftType(int shTypeNext, int shTypeLast) const {
+		return forbiddenShiftType_ShiftType_[std::max(shTypeLast, 0)*nbShiftsType_+shTypeNext];
+	}
 
 	// update the scenario to treat a new week
 	//
@@ -10,6 +10,12 @@
 #include "solvers/InitializeSolver.h"
 #include "solvers/mp/modeler/BcpModeler.h"
 
+#include <cstdio>
+#include <exception>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
 // #define COMPARE_EVALUATIONS
 
 
@@ -19,6 +25,115 @@ using std::map;
 using std::pair;
 
 
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   L N S O p e r a t o r W e i g h t s
+//
+//  Weights of a family of operators of the adaptive LNS
+//
+//-----------------------------------------------------------------------------
+
+// Update the weights with the scores of the segment and start a new segment
+// The weights of the operators that were not used in the segment are unchanged
+//
+void LNSOperatorWeights::updateWeights(double reactionFactor) {
+	// minimum weight of an operator relatively to the largest weight
+	const double minWeightRatio = 0.05;
+
+	for (unsigned int op = 0; op < weights_.size(); op++) {
+		if (nbUses_[op] > 0) {
+			weights_[op] = (1.0-reactionFactor)*weights_[op] + reactionFactor*scores_[op]/nbUses_[op];
+		}
+		scores_[op] = 0.0;
+		nbUses_[op] = 0;
+	}
+
+	double maxWeight = *std::max_element(weights_.begin(), weights_.end());
+	if (maxWeight <= 0.0) maxWeight = 1.0;
+	for (double& w: weights_) {
+		w = std::max(w, minWeightRatio*maxWeight);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   T i m e B u d g e t
+//
+//  Central manager of the time of a deterministic solver (on the wall clock)
+//
+//-----------------------------------------------------------------------------
+
+// Start a new budget of totalTime seconds at time now
+// The observed rates are kept, since they are still good predictors
+//
+void TimeBudget::initialize(double totalTime, double now) {
+	totalTime_ = totalTime;
+	startTime_ = now;
+	lnsStartTime_ = -1.0;
+	improvements_.clear();
+}
+
+// Time allowed to a connex component with nbNurses nurses when nbNursesLeft
+// nurses are still to be scheduled
+// All the components have the same number of days, so the predicted costs are
+// in proportion of the number of nurses
+//
+double TimeBudget::componentTimeLimit(double now, int nbNurses, int nbNursesLeft) const {
+	double timeLeft = std::max(0.0, this->timeLeft(now));
+	if (nbNursesLeft <= nbNurses) return timeLeft;
+	return timeLeft*(double)nbNurses/(double)nbNursesLeft;
+}
+
+// Record the time spent in the solution of a problem with the input
+// number of free nurse-days
+//
+void TimeBudget::recordRate(BudgetPhase phase, int nbNurseDays, double seconds) {
+	if (nbNurseDays <= 0 || seconds <= 0.0) return;
+
+	double rate = seconds/(double)nbNurseDays;
+	if (nbObservations_[phase] == 0) {
+		secondsPerNurseDay_[phase] = rate;
+	}
+	else {
+		secondsPerNurseDay_[phase] = 0.5*secondsPerNurseDay_[phase]+0.5*rate;
+	}
+	nbObservations_[phase]++;
+}
+
+// Record the improvement obtained by a LNS iteration ending at time now
+//
+void TimeBudget::recordImprovement(double now, double improvement) {
+	if (improvement > EPSILON) improvements_.push_back(pair<double,double>(now,improvement));
+}
+
+// True if the improvement per wall-clock second over the last window seconds is below
+// minRate
+//
+bool TimeBudget::isImprovementTooSlow(double now, double window, double minRate) const {
+	if (minRate <= 0.0 || lnsStartTime_ < 0 || now-lnsStartTime_ < window) return false;
+
+	double improvement = 0.0;
+	for (auto it = improvements_.rbegin(); it != improvements_.rend() && it->first >= now-window; it++) {
+		improvement += it->second;
+	}
+	return improvement/window < minRate;
+}
+
+// Display the budget
+//
+string TimeBudget::toString(double now) const {
+	std::stringstream rep;
+	rep << "Time budget: " << timeLeft(now) << " s left out of " << totalTime_ << " s" << std::endl;
+	rep << "Time per free nurse-day (complete, rolling, lns):";
+	for (int p = 0; p < NB_BUDGET_PHASES; p++) {
+		rep << " " << secondsPerNurseDay_[p] << " (" << nbObservations_[p] << " obs.)";
+	}
+	rep << std::endl;
+	return rep.str();
+}
+
+
 //-----------------------------------------------------------------------------
 //
 //  C l a s s   D e t e r m i n i s t i c S o l v e r
@@ -53,6 +168,16 @@ pCompleteSolver_(0), pRollingSolver_(0), pLNSSolver_(0) {
   rollingParameters_.sp_short_ = inputPaths.shortSP();
   lnsParameters_.sp_short_ = inputPaths.shortSP();
 
+	// the checkpoints are written next to the solution
+	if (!inputPaths.solutionPath().empty()) {
+		checkpointPath_ = inputPaths.solutionPath()+"/checkpoint/";
+	}
+	if (options_.solutionLog_ && !inputPaths.solutionPath().empty()) {
+		pSolutionLog_.reset(new SolutionLogWriter(inputPaths.solutionPath()+"/solutions.bin",
+			pScenario_, pDemand_->firstDay_, pDemand_->nbDays_));
+	}
+	isNurseScheduled_.assign(pScenario_->nbNurses_, false);
+
 	if (!options_.logfile_.empty()) {
 		FILE * pFile;
 		pFile = fopen (options_.logfile_.c_str(),"w");
@@ -150,6 +275,9 @@ void DeterministicSolver::readOptionsFromFile(InputPaths& inputPaths) {
 		else if (Tools::strEndsWith(title, "rollingPredictionHorizon")) {
 			file >> options_.rollingPredictionHorizon_;
 		}
+		else if (Tools::strEndsWith(title, "rollingSpeculative")) {
+			file >> options_.rollingSpeculative_;
+		}
 		else if (Tools::strEndsWith(title, "withLNS")) {
 			file >> options_.withLNS_;
 		}
@@ -183,6 +311,39 @@ void DeterministicSolver::readOptionsFromFile(InputPaths& inputPaths) {
 		else if (Tools::strEndsWith(title, "lnsNbNursesDestroyOverAllWeeks")) {
 			file >> options_.lnsNbNursesDestroyOverAllWeeks_;
 		}
+		else if (Tools::strEndsWith(title, "lnsSegmentLength")) {
+			file >> options_.lnsSegmentLength_;
+		}
+		else if (Tools::strEndsWith(title, "lnsReactionFactor")) {
+			file >> options_.lnsReactionFactor_;
+		}
+		else if (Tools::strEndsWith(title, "lnsCheckpointInterval")) {
+			file >> options_.lnsCheckpointInterval_;
+		}
+		else if (Tools::strEndsWith(title, "solutionLog")) {
+			file >> options_.solutionLog_;
+		}
+		else if (Tools::strEndsWith(title, "lnsMinTimeFraction")) {
+			file >> options_.lnsMinTimeFraction_;
+		}
+		else if (Tools::strEndsWith(title, "lnsMinImprovementRate")) {
+			file >> options_.lnsMinImprovementRate_;
+		}
+		else if (Tools::strEndsWith(title, "lnsImprovementRateWindow")) {
+			file >> options_.lnsImprovementRateWindow_;
+		}
+		else if (Tools::strEndsWith(title, "withLocalSearch")) {
+			file >> options_.withLocalSearch_;
+		}
+		else if (Tools::strEndsWith(title, "localSearchMaxTime")) {
+			file >> options_.localSearchMaxTime_;
+		}
+		else if (Tools::strEndsWith(title, "localSearchNbThreads")) {
+			file >> options_.localSearchNbThreads_;
+		}
+		else if (Tools::strEndsWith(title, "localSearchMaxSegmentLength")) {
+			file >> options_.localSearchMaxSegmentLength_;
+		}
 		else if (Tools::strEndsWith(title, "solutionAlgorithm")) {
 			std::string algoName;
 			file >> algoName;
@@ -269,6 +430,7 @@ void DeterministicSolver::readOptionsFromFile(InputPaths& inputPaths) {
 	// parameters of the solution in the large neighborhood search
 	lnsParameters_ = param;
 	lnsParameters_.initialize(options_.verbose_,lnsOptimalityLevel);
+	options_.lnsOptimalityLevel_ = lnsOptimalityLevel;
 	lnsParameters_.performHeuristicAfterXNode_ = -1;
 
 }
@@ -344,17 +506,23 @@ double DeterministicSolver::solve(vector<Roster> initialSolution){
 	// this is absolutely necessary for reproductibility of the results
 	//
 	Tools::initializeRandomGenerator(this->options_.randomSeed_);
-	srand(this->options_.randomSeed_);
+	rdm_.seed(this->options_.randomSeed_);
 
 	// DBG
-	std::cout << "Next random : " << Tools::randomInt(0, RAND_MAX) << std::endl;
-	std::cout << "Next random : " << Tools::randomInt(0, RAND_MAX) << std::endl;
+	std::cout << "Next random : " << Tools::randomInt(rdm_, 0, RAND_MAX) << std::endl;
+	std::cout << "Next random : " << Tools::randomInt(rdm_, 0, RAND_MAX) << std::endl;
+
+	// every phase of the solution process draws its time from this budget
+	//
+	timeBudget_.initialize(options_.totalTimeLimitSeconds_, pTimerTotal_->dSinceStart());
 
 	// Always solve small problems to optimality
 	// This can actually save time
+	// (an input initial solution is rather improved with the LNS below)
 	//
-	if ( (pScenario_->nbDays() <= 28 && pScenario_->nbNurses() <= 8)
-		|| (pScenario_->nbDays() <= 56 && pScenario_->nbNurses() <= 5) ) {
+	if ( initialSolution.empty() &&
+		((pScenario_->nbDays() <= 28 && pScenario_->nbNurses() <= 8)
+		|| (pScenario_->nbDays() <= 56 && pScenario_->nbNurses() <= 5)) ) {
 		completeParameters_.setOptimalityLevel(OPTIMALITY);
 		objValue_ = this->solveCompleteHorizon();
 		if (MasterProblem* pMaster = static_cast<MasterProblem*> (pCompleteSolver_)) {
@@ -367,16 +535,25 @@ double DeterministicSolver::solve(vector<Roster> initialSolution){
 	//
 	if (options_.divideIntoConnexPositions_) {
 		options_.divideIntoConnexPositions_ = false;
-		objValue_ = this->solveByConnexPositions();
+		objValue_ = this->solveByConnexPositions(initialSolution);
 	}
 	// If the the scenario is divided into connex positions, the solution
 	// of the subproblems goes in the "else" below
 	//
 	else {
 		// Find a good feasible solution using a rolling horizon planning or
-		/// solving directly the complete horizon
+		/// solving directly the complete horizon, unless a solution is input
 		//
-		if (options_.withRollingHorizon_) {
+		if (!initialSolution.empty()) {
+			objValue_ = this->solveFromInitialSolution(initialSolution);
+			stats_.bestUBInitial_ = objValue_;
+			stats_.bestUB_ = objValue_;
+			stats_.timeInitialSol_ = pTimerTotal_->dSinceStart();
+			if (status_ == INFEASIBLE) {
+				return objValue_;
+			}
+		}
+		else if (options_.withRollingHorizon_) {
 			objValue_ = this->solveWithRollingHorizon();
 			if (MasterProblem* pMaster = static_cast<MasterProblem*> (pRollingSolver_)) {
 				this->updateInitialStats(pMaster);
@@ -393,6 +570,10 @@ double DeterministicSolver::solve(vector<Roster> initialSolution){
 			}
 		}
 
+		if (status_ == FEASIBLE || status_ == OPTIMAL) {
+			this->logIncumbent("initial");
+		}
+
 		// Improve the solution with an LNS
 		//
 		if (options_.withLNS_) {
@@ -402,6 +583,23 @@ double DeterministicSolver::solve(vector<Roster> initialSolution){
 				this->updateImproveStats(pMaster);
 			}
 		}
+
+		// Polish the solution with a local search in the time left
+		//
+		if (options_.withLocalSearch_ && (status_ == FEASIBLE || status_ == OPTIMAL)) {
+			double timeLeft = timeBudget_.timeLeft(pTimerTotal_->dSinceStart());
+			double maxTime = std::min(options_.localSearchMaxTime_, timeLeft);
+			if (maxTime > 0) {
+				double initialCost = objValue_;
+				objValue_ = this->localSearch(maxTime, options_.localSearchNbThreads_,
+					options_.localSearchMaxSegmentLength_);
+				stats_.bestUB_ = objValue_;
+				std::cout << "# Local search: " << initialCost << " -> " << objValue_ << std::endl;
+				if (objValue_ < initialCost-EPSILON) {
+					this->logIncumbent("local search");
+				}
+			}
+		}
 	}
 	return objValue_;
 }
@@ -418,13 +616,55 @@ double DeterministicSolver::solveCompleteHorizon() {
 	// Initialize solver and solve
 	//
 	pCompleteSolver_ = setSolverWithInputAlgorithm(pDemand_);
+
+	// the complete solution draws its time from the budget like the other phases
+	//
+	completeParameters_.maxSolvingTimeSeconds_ =
+		std::min(completeParameters_.maxSolvingTimeSeconds_, (int) timeBudget_.timeLeft(pTimerTotal_->dSinceStart()));
+	double timeStartSolve = pTimerTotal_->dSinceStart();
 	pCompleteSolver_->solve(completeParameters_);
+	timeBudget_.recordRate(PHASE_COMPLETE, pScenario_->nbNurses_*pDemand_->nbDays_,
+		pTimerTotal_->dSinceStart()-timeStartSolve);
 	pCompleteSolver_->printCurrentSol();
 	std::cout << pCompleteSolver_->solutionToString() << std::endl;
 	return this->treatResults(pCompleteSolver_);
 }
 
 
+//------------------------------------------------------------------------
+//
+// Load an initial solution (e.g. the solution or a checkpoint of a previous
+// run) in a new solver as if it had been found by the initial solution phase
+//
+//------------------------------------------------------------------------
+
+double DeterministicSolver::solveFromInitialSolution(vector<Roster> initialSolution) {
+
+	std::cout << "LOAD THE INITIAL SOLUTION" << std::endl << std::endl;
+
+	// The solver is stored as the complete solver, so that the LNS uses it as
+	// its repair solver
+	//
+	pCompleteSolver_ = setSolverWithInputAlgorithm(pDemand_);
+	pCompleteSolver_->initialize(lnsParameters_, {});
+	pCompleteSolver_->loadSolution(initialSolution);
+
+	// Solve the problem restricted to the rotations of the initial solution:
+	// the pricing is forbidden for every nurse and the repair of the LNS adds
+	// the rotations of the loaded solution as initial columns
+	// This way, the model holds a solution before the first destroy operator
+	//
+	vector<bool> isFixNurse(pScenario_->nbNurses_,true);
+	pCompleteSolver_->fixNurses(isFixNurse);
+	pCompleteSolver_->LNSSolve(lnsParameters_);
+	pCompleteSolver_->unfixNurses(isFixNurse);
+
+	std::cout << "END OF THE LOAD OF THE INITIAL SOLUTION" << std::endl << std::endl;
+
+	return this->treatResults(pCompleteSolver_);
+}
+
+
 //----------------------------------------------------------------------------
 // After the end of a solution process: retrieve status, solution, etc.
 //----------------------------------------------------------------------------
@@ -465,6 +705,148 @@ double DeterministicSolver::treatResults(Solver* pSolver) {
 }
 
 
+//----------------------------------------------------------------------------
+//
+// CHECKPOINTS OF THE SOLUTION
+//
+//----------------------------------------------------------------------------
+
+// Mark the nurses of the input solver as scheduled and copy their rosters
+// Be particularly cautious that the nurse indices are not the same in the
+// initial scenario and in the solvers per component
+//
+void DeterministicSolver::storeComponentRosters(DeterministicSolver* pSolver, const vector<Roster>& solution) {
+	if (solution.empty()) return;
+
+	for (PLiveNurse pNurse: pSolver->theLiveNurses_) {
+		theLiveNurses_[pNurse->originalNurseId_]->roster_ = solution[pNurse->id_];
+		isNurseScheduled_[pNurse->originalNurseId_] = true;
+	}
+}
+
+// Write the current solution in the checkpoint directory
+// The weeks are written in a temporary directory that then replaces the
+// previous checkpoint, so that a checkpoint never mixes the weeks of two
+// solutions: after a crash, the checkpoint directory is either the previous
+// or the new one, or only the previous one is left in <checkpoint>.old
+//
+void DeterministicSolver::writeCheckpoint() {
+
+	// the solver of a connex component only gives its rosters to the solver of
+	// the complete scenario
+	if (pParentSolver_) {
+		pParentSolver_->storeComponentRosters(this, solution_);
+		pParentSolver_->writeCheckpoint();
+		return;
+	}
+
+	if (checkpointPath_.empty()) return;
+
+	// nothing is written until every nurse has a roster
+	if (!solution_.empty()) {
+		for (int n=0; n<pScenario_->nbNurses_; ++n) {
+			theLiveNurses_[n]->roster_ = solution_[n];
+			isNurseScheduled_[n] = true;
+		}
+	}
+	for (bool isScheduled: isNurseScheduled_) {
+		if (!isScheduled) return;
+	}
+
+	// the directories are named without their trailing separator to be renamed
+	string checkpointDir = checkpointPath_.substr(0, checkpointPath_.find_last_not_of('/')+1);
+	string tmpDir = checkpointDir+".tmp", oldDir = checkpointDir+".old";
+	int nbWeeks = getNbDays()/7;
+	auto removeDir = [nbWeeks](const string& dir) {
+		for (int w=0; w < nbWeeks; ++w) {
+			std::remove((dir+"/sol-week"+std::to_string(w)+".txt").c_str());
+		}
+		rmdir(dir.c_str());
+	};
+
+	removeDir(tmpDir);
+	if (mkdir(tmpDir.c_str(), 0777) != 0) {
+		std::cerr << "Could not create the checkpoint directory " << tmpDir << std::endl;
+		return;
+	}
+
+	vector<string> solutions = solutionToString(nbWeeks);
+	for (int w=0; w < nbWeeks; ++w) {
+		string solutionFile = tmpDir+"/sol-week"+std::to_string(w)+".txt";
+		std::ofstream file(solutionFile.c_str(), std::fstream::out);
+		file << solutions[w];
+		file.close();
+		if (file.fail()) {
+			std::cerr << "Could not write the checkpoint " << solutionFile << std::endl;
+			removeDir(tmpDir);
+			return;
+		}
+	}
+
+	// a directory cannot be renamed over a non-empty one, so the previous
+	// checkpoint is moved aside first
+	removeDir(oldDir);
+	std::rename(checkpointDir.c_str(), oldDir.c_str());
+	if (std::rename(tmpDir.c_str(), checkpointDir.c_str()) != 0) {
+		std::cerr << "Could not replace the checkpoint " << checkpointDir << std::endl;
+		std::rename(oldDir.c_str(), checkpointDir.c_str());
+		return;
+	}
+	removeDir(oldDir);
+	std::cout << "Checkpoint written in " << checkpointPath_ << std::endl;
+}
+
+
+//----------------------------------------------------------------------------
+//
+// LOG OF THE SOLUTIONS
+//
+//----------------------------------------------------------------------------
+
+// Append the current solution to the log of the solutions with its cost
+// breakdown
+//
+void DeterministicSolver::logIncumbent(const string& phase, int iteration) {
+
+	// the solver of a connex component only gives its rosters to the solver of
+	// the complete scenario
+	if (pParentSolver_) {
+		pParentSolver_->storeComponentRosters(this, solution_);
+		pParentSolver_->logIncumbent(phase, iteration);
+		return;
+	}
+
+	if (!pSolutionLog_) return;
+
+	// nothing is logged until every nurse has a roster
+	if (!solution_.empty()) {
+		for (int n=0; n<pScenario_->nbNurses_; ++n) {
+			theLiveNurses_[n]->roster_ = solution_[n];
+			isNurseScheduled_[n] = true;
+		}
+	}
+	for (bool isScheduled: isNurseScheduled_) {
+		if (!isScheduled) return;
+	}
+
+	// evaluate the rosters of the live nurses
+	vector<Roster> solution;
+	for (PLiveNurse pNurse: theLiveNurses_) {
+		pNurse->buildStates();
+		solution.push_back(pNurse->roster_);
+	}
+	CostBreakdown costs = computeCostBreakdown();
+
+	pSolutionLog_->appendSolution(solution, costs, pTimerTotal_->dSinceStart(), phase, iteration);
+}
+
+// Append the statistics of the run to the log of the solutions
+//
+void DeterministicSolver::logStats() {
+	if (pSolutionLog_) pSolutionLog_->appendStats(stats_);
+}
+
+
 //------------------------------------------------------------------------
 //
 // Solve the problem using a decomposition of the set nurses by connex
@@ -472,13 +854,13 @@ double DeterministicSolver::treatResults(Solver* pSolver) {
 //
 //------------------------------------------------------------------------
 
-double DeterministicSolver::solveByConnexPositions() {
+double DeterministicSolver::solveByConnexPositions(const vector<Roster>& initialSolution) {
 
 	// DIVIDE THE SCENARIO INTO CONNEX COMPONENTS AND PRINT THE RESULT
 	vector<PScenario> scenariosPerComponent = divideScenarioIntoConnexPositions(pScenario_);
 
 	// SOLVE THE PROBLEM COMPONENT-WISE
-	int i = 0;
+	int nbNursesLeft = pScenario_->nbNurses();
 	for (PScenario pScenario: scenariosPerComponent) {
 		std::cout << "COMPONENT-WISE SCENARIO" << std::endl;
 		std::cout << pScenario->toString() << std::endl;
@@ -487,24 +869,34 @@ double DeterministicSolver::solveByConnexPositions() {
 		InputPaths inputPaths;
     DeterministicSolver* solver = new DeterministicSolver(pScenario,inputPaths);
 		solver->copyParameters(this);
+		solver->pParentSolver_ = this;
+
+		// share the time left between the components that are not solved yet
+		// proportionnally to their number of nurses: the time unused by the
+		// previous components goes to the next ones and the last component gets
+		// all the time left
+		double allowedTime = timeBudget_.componentTimeLimit(pTimerTotal_->dSinceStart(),pScenario->nbNurses(),nbNursesLeft);
+		nbNursesLeft -= pScenario->nbNurses();
+		solver->setTotalTimeLimit(allowedTime);
 
-		// set allowed time proportionnally to the number of nurses in each
-		// component
-		double allowedTime = options_.totalTimeLimitSeconds_*(double)pScenario->nbNurses()/(double)pScenario_->nbNurses();
-		// if solving the last component, leave it all the time left
-		if (i++ == scenariosPerComponent.size()) {
-			allowedTime = std::max(allowedTime,options_.totalTimeLimitSeconds_-pTimerTotal_->dSinceStart());
+		// extract the rosters of the nurses of the component from the initial
+		// solution
+		vector<Roster> componentSolution;
+		if (!initialSolution.empty()) {
+			for (PLiveNurse pNurse: solver->theLiveNurses_)
+				componentSolution.push_back(initialSolution[pNurse->originalNurseId_]);
 		}
-		solver->setTotalTimeLimit(allowedTime);
 
-		// solve the component
-		solver->solve();
+		// solve the component and keep the rates observed in the component to
+		// predict the cost of the next ones
+		solver->solve(componentSolution);
+		timeBudget_.copyRates(solver->getTimeBudget());
 
 		// STORE THE SOLUTION
 		// Be particularly cautious that the nurse indices are not the same in the
 		// initial scenario and in the solvers per component
-		for (PLiveNurse pNurse: solver->theLiveNurses_)
-			theLiveNurses_[pNurse->originalNurseId_]->roster_ = solver->getSolution()[pNurse->id_];
+		this->storeComponentRosters(solver, solver->getSolution());
+		this->writeCheckpoint();
 
 		// Consolidate the global state of the solver
 		stats_.add(solver->getGlobalStat());
@@ -556,6 +948,19 @@ double DeterministicSolver::solveWithRollingHorizon() {
 	//
 	pRollingSolver_ = setSolverWithInputAlgorithm(pDemand_);
 
+	// Thread and solution of the speculative solution of the next window
+	// The thread is joined when leaving this method, even on an exception, and
+	// an exception thrown in the thread is raised again in this thread
+	//
+	std::thread speculativeThread;
+	std::exception_ptr speculativeException;
+	vector<Roster> speculativeSolution;
+	bool isSpeculationKept = false;
+	struct ThreadJoiner {
+		std::thread& thread_;
+		~ThreadJoiner() {if (thread_.joinable()) thread_.join();}
+	} speculativeJoiner {speculativeThread};
+
 	// Solve the instance iteratively with a rolling horizon
 	//
 	int firstDay = 0; //first day of the current horizon
@@ -578,7 +983,47 @@ double DeterministicSolver::solveWithRollingHorizon() {
 		// Solve the problem with a method that allows for a warm start
 		//
 		this->rollingSetOptimalityLevel(firstDay);
+
+		// the speculative solution of this window is consistent with the fixed
+		// days: it is in the model, so a feasible solution is enough
+		//
+		if (isSpeculationKept) {
+			rollingParameters_.setOptimalityLevel(UNTIL_FEASIBLE);
+			isSpeculationKept = false;
+		}
+
+		// Start the speculative solution of the next window: the partial solution
+		// of the previous window is a prediction of the sample period of the
+		// current window
+		// The two windows are solved at the same time by two BCP solvers of the
+		// same process: this assumes that BCP and the LP solver keep the state of
+		// a solution in their own objects, which holds for the sequential
+		// version of BCP built with this project (as for the evaluation threads of
+		// the stochastic solver), so rollingSpeculative must stay off with a
+		// build of BCP that shares state between its problems
+		//
+		int nextFirstDay = firstDay+samplePeriod;
+		if (options_.rollingSpeculative_ && firstDay > 0 && nextFirstDay < pDemand_->nbDays_) {
+			pRollingSolver_->storeSolution();
+			vector<Roster> prediction = pRollingSolver_->getSolution();
+			SolverParam param = rollingParameters_;
+			speculativeSolution.clear();
+			int rdmSeed = rdm_();
+			speculativeThread = std::thread([this, prediction, lastDaySample, nextFirstDay, param, rdmSeed,
+				&speculativeSolution, &speculativeException]() {
+				try {
+					speculativeSolution = this->rollingSpeculativeSolve(prediction, lastDaySample, nextFirstDay, param, rdmSeed);
+				}
+				catch (...) {
+					speculativeException = std::current_exception();
+				}
+			});
+		}
+
+		double timeStartSolve = pTimerTotal_->dSinceStart();
 		pRollingSolver_->rollingSolve(rollingParameters_,firstDay);
+		timeBudget_.recordRate(PHASE_ROLLING, pScenario_->nbNurses_*(pDemand_->nbDays_-firstDay),
+			pTimerTotal_->dSinceStart()-timeStartSolve);
 
 		if (rollingParameters_.printIntermediarySol_) {
 			pRollingSolver_->printCurrentSol();
@@ -590,6 +1035,24 @@ double DeterministicSolver::solveWithRollingHorizon() {
 		for (int day=0; day<=lastDaySample; day++) isFixDay[day] = true;
 		pRollingSolver_->fixDays(isFixDay);
 
+		// Keep the speculative solution of the next window if the sample period
+		// has been fixed as predicted, otherwise its columns are only a warm start
+		//
+		if (speculativeThread.joinable()) {
+			speculativeThread.join();
+			if (speculativeException) {
+				std::rethrow_exception(speculativeException);
+			}
+			if (!speculativeSolution.empty()) {
+				pRollingSolver_->storeSolution();
+				isSpeculationKept = this->isSpeculationConsistent(pRollingSolver_->getSolution(),
+					speculativeSolution, firstDay, lastDaySample);
+				std::cout << "The speculative solution of the next window is "
+					<< (isSpeculationKept ? "kept" : "used as a warm start") << std::endl;
+				pRollingSolver_->addWarmStartSolution(speculativeSolution);
+			}
+		}
+
 		// update the first and last day of the sample period
 		//
 		firstDay = firstDay+samplePeriod;
@@ -619,14 +1082,97 @@ double DeterministicSolver::solveWithRollingHorizon() {
 	return treatResults(pRollingSolver_);
 }
 
+// Solve speculatively the window of the rolling horizon starting on firstDay
+// The predicted solution is first loaded in a new solver (as in
+// solveFromInitialSolution), then the days until lastFixedDay are fixed and the
+// window is solved as in the rolling horizon
+//
+vector<Roster> DeterministicSolver::rollingSpeculativeSolve(vector<Roster> prediction,
+	int lastFixedDay, int firstDay, SolverParam param, int rdmSeed) {
+
+	Solver* pSolver = setSolverWithInputAlgorithm(pDemand_, rdmSeed);
+	pSolver->initialize(param, {});
+	pSolver->loadSolution(prediction);
+
+	// solve the problem restricted to the rotations of the prediction
+	//
+	vector<bool> isFixNurse(pScenario_->nbNurses_,true);
+	pSolver->fixNurses(isFixNurse);
+	pSolver->LNSSolve(param);
+	pSolver->unfixNurses(isFixNurse);
+
+	// solve the window with the predicted days fixed
+	//
+	vector<Roster> solution;
+	MasterProblem* pMaster = static_cast<MasterProblem*>(pSolver);
+	if (pMaster->getModel()->nbSolutions() >= 1) {
+		int lastDayControl = std::min(firstDay+options_.rollingControlHorizon_-1,pDemand_->nbDays_-1);
+		vector<bool> isRelaxDay(pDemand_->nbDays_,false);
+		for (int day=lastDayControl+1; day < pDemand_->nbDays_; day++) isRelaxDay[day] = true;
+		pSolver->relaxDays(isRelaxDay);
+
+		vector<bool> isFixDay(pDemand_->nbDays_,false);
+		for (int day=0; day<=lastFixedDay; day++) isFixDay[day] = true;
+		pSolver->fixDays(isFixDay);
+
+		pSolver->rollingSolve(param, firstDay);
+		if (pMaster->getModel()->nbSolutions() >= 1) {
+			pSolver->storeSolution();
+			solution = pSolver->getSolution();
+		}
+	}
+
+	delete pSolver;
+	return solution;
+}
+
+// Check if the solution matches the speculative solution from firstDay to lastDay
+//
+bool DeterministicSolver::isSpeculationConsistent(const vector<Roster>& solution,
+	const vector<Roster>& speculativeSolution, int firstDay, int lastDay) {
+	if (solution.size() != speculativeSolution.size()) return false;
+
+	for (unsigned int n = 0; n < solution.size(); n++) {
+		for (int day = firstDay; day <= lastDay; day++) {
+			if (solution[n].shift(day) != speculativeSolution[n].shift(day)
+				|| solution[n].skill(day) != speculativeSolution[n].skill(day)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 // Set the optimality level of the rolling horizon solver
 // This function needs to be called before each new solution, and the behavior
 // depends on the first day of the horizon
 //
 void DeterministicSolver::rollingSetOptimalityLevel(int firstDay) {
+
+	// predict the time needed by the remaining steps of the rolling horizon
+	// and compare it to the time that the initial solution can use
+	//
+	double predictedTime = 0.0;
+	for (int day = firstDay; day < pDemand_->nbDays_; day += options_.rollingSamplePeriod_) {
+		predictedTime += timeBudget_.predictedTime(PHASE_ROLLING, pScenario_->nbNurses_*(pDemand_->nbDays_-day));
+	}
+	double improveFraction = options_.withLNS_ ? options_.lnsMinTimeFraction_ : 0.0;
+	double timeLeft = timeBudget_.timeLeftForInitialSol(pTimerTotal_->dSinceStart(), improveFraction);
+
+	// only look for a feasible solution when the rolling horizon is late on
+	// its schedule (the prediction is reliable only after the first step)
+	//
+	if (timeBudget_.isRateObserved(PHASE_ROLLING) && predictedTime > timeLeft) {
+		std::cout << "The rolling horizon is late: only search for feasible solutions" << std::endl;
+		rollingParameters_.setOptimalityLevel(UNTIL_FEASIBLE);
+		return;
+	}
+
 	rollingParameters_.setOptimalityLevel(TWO_DIVES);
 
- 	if (pDemand_->nbDays_-firstDay <= 21) {
+	// try harder on the last weeks if there is time for it
+	//
+	if (pDemand_->nbDays_-firstDay <= 21 && 2.0*predictedTime <= timeLeft) {
 		rollingParameters_.setOptimalityLevel(REPEATED_DIVES);
 	}
 }
@@ -650,13 +1196,13 @@ double DeterministicSolver::solveWithLNS() {
 	// Initialize data structures for LNS
 	//
 	this->initializeLNS();
-	std::vector<double> nursesSelectionWeights(nursesSelectionOperators_.size(),3.0);
-	std::vector<double> daysSelectionWeights(daysSelectionOperators_.size(),3.0);
-	std::vector<double> repairWeights(repairOperators_.size(),0.1);
+	LNSOperatorWeights nursesSelectionWeights(nursesSelectionOperators_.size());
+	LNSOperatorWeights daysSelectionWeights(daysSelectionOperators_.size());
+	LNSOperatorWeights repairWeights(repairOperators_.size());
 
 	// Initialize the solver that will handle the repair problems
 	//
-	if (options_.withRollingHorizon_) {
+	if (options_.withRollingHorizon_ && pRollingSolver_) {
 		pLNSSolver_ = pRollingSolver_;
 	}
 	else {
@@ -674,22 +1220,51 @@ double DeterministicSolver::solveWithLNS() {
 	// without improvement is reached
 	//
 	int nbItWithoutImprovement=0;
+	int nbItInSegment=0;
 	double bestObjVal=this->computeSolutionCost();
+	timeBudget_.startLNS(timeSinceStart);
+	double timeLastCheckpoint = timeSinceStart;
+	bool isImprovedSinceCheckpoint = false;
 	while (true) { //nbItWithoutImprovement < options_.lnsMaxItWithoutImprovement_) {
 
-		// draw the next destroy operators randomly according to the weights
-		int nurseIndex = Tools::drawRandomWithWeights(nursesSelectionWeights);
-		int dayIndex = Tools::drawRandomWithWeights(daysSelectionWeights);
-		int repairIndex = Tools::drawRandomWithWeights(repairWeights);
+		// draw the next destroy and repair operators randomly according to the
+		// weights
+		int nurseIndex = nursesSelectionWeights.draw(rdm_);
+		int dayIndex = daysSelectionWeights.draw(rdm_);
+		int repairIndex = repairWeights.draw(rdm_);
 		NursesSelectionOperator nurseOperator = nursesSelectionOperators_[nurseIndex];
 		DaysSelectionOperator dayOperator = daysSelectionOperators_[dayIndex];
 
+		// force a deeper repair when the lns has not improved for a while
+		RepairOperator minRepairOperator = REPAIR_TWO_DIVES;
+		if (nbItWithoutImprovement > std::min(30,options_.lnsMaxItWithoutImprovement_/2) ) {
+			minRepairOperator = REPAIR_OPTIMALITY;
+		}
+		else if (nbItWithoutImprovement > std::min(10,options_.lnsMaxItWithoutImprovement_/4) ) {
+			minRepairOperator = REPAIR_REPEATED_DIVES;
+		}
+		while (repairOperators_[repairIndex] < minRepairOperator && repairIndex+1 < (int) repairOperators_.size()) {
+			repairIndex++;
+		}
+		lnsParameters_.setOptimalityLevel(repairToOptimalityLevel[repairOperators_[repairIndex]]);
+
 		// apply the destroy operator
-		this->adaptiveDestroy(nurseOperator, dayOperator);
+		int nbNurseDays = this->adaptiveDestroy(nurseOperator, dayOperator);
+
+		// do not start a repair that is not predicted to end before the time limit
+		//
+		timeSinceStart = pTimerTotal_->dSinceStart();
+		if (timeBudget_.isRateObserved(PHASE_LNS)
+			&& timeBudget_.predictedTime(PHASE_LNS, nbNurseDays) > timeBudget_.timeLeft(timeSinceStart)) {
+			std::cout << "Stop the lns: not enough time left for another repair" << std::endl;
+			break;
+		}
 
 		// run the repair operator
 		//
 		double currentObjVal = pLNSSolver_->LNSSolve(lnsParameters_);
+		double timeRepair = pTimerTotal_->dSinceStart()-timeSinceStart;
+		timeBudget_.recordRate(PHASE_LNS, nbNurseDays, timeRepair);
 
 		// stop lns if runtime is exceeded
 		//
@@ -712,39 +1287,50 @@ double DeterministicSolver::solveWithLNS() {
 			pLNSSolver_->printCurrentSol();
 		}
 
-		// update the weight of adaptive lns
+		// score the operators with the improvement per wall-clock second of the repair
 		//
+		double improvement = std::max(0.0, bestObjVal-currentObjVal);
+		double score = improvement/std::max(timeRepair, 0.01);
+		nursesSelectionWeights.addScore(nurseIndex, score);
+		daysSelectionWeights.addScore(dayIndex, score);
+		repairWeights.addScore(repairIndex, score);
+
+		// update the throughput of the operators
+		for (LNSOperatorStats* pOpStats: {&stats_.lnsNursesSelectionStats_[nurseIndex],
+			&stats_.lnsDaysSelectionStats_[dayIndex], &stats_.lnsRepairStats_[repairIndex]}) {
+			pOpStats->nbIterations_++;
+			pOpStats->time_ += timeRepair;
+			pOpStats->improvement_ += improvement;
+		}
+
 		if (currentObjVal < bestObjVal-EPSILON) {
 			// update stats
 			stats_.lnsImprovementValueTotal_+=bestObjVal-currentObjVal;
+			timeBudget_.recordImprovement(timeSinceStart, bestObjVal-currentObjVal);
 			stats_.lnsNbIterationsWithImprovement_++;
 
-			// update weights of the destroy operators
 			bestObjVal = currentObjVal;
 			nbItWithoutImprovement = 0;
-			lnsParameters_.setOptimalityLevel(TWO_DIVES);
-			nursesSelectionWeights[nurseIndex] = nursesSelectionWeights[nurseIndex]+1.0;
-			daysSelectionWeights[nurseIndex] = daysSelectionWeights[nurseIndex]+1.0;
-
-			// update weights of the repair operators
-			double timeIteration = pTimerTotal_->dSinceInit()-timeSinceStart;
-			repairWeights[repairIndex] += 10.0/timeIteration;
-
+			isImprovedSinceCheckpoint = true;
 
 			// update the counters of iterations with improvement
 			stats_.nbImprovementsWithNursesSelection_[nurseIndex]++;
 			stats_.nbImprovementsWithDaysSelection_[dayIndex]++;
 			stats_.nbImprovementsWithRepair_[repairIndex]++;
+
+			this->logIncumbent("lns", stats_.lnsNbIterations_);
 		}
 		else {
 			nbItWithoutImprovement++;
+		}
 
-			if (nbItWithoutImprovement > std::min(30,options_.lnsMaxItWithoutImprovement_/2) ) {
-				lnsParameters_.setOptimalityLevel(OPTIMALITY);
-			}
-			else if (nbItWithoutImprovement > std::min(10,options_.lnsMaxItWithoutImprovement_/4) ) {
-				lnsParameters_.setOptimalityLevel(REPEATED_DIVES);
-			}
+		// update the weights of the operators at the end of each segment
+		//
+		if (++nbItInSegment >= options_.lnsSegmentLength_) {
+			nursesSelectionWeights.updateWeights(options_.lnsReactionFactor_);
+			daysSelectionWeights.updateWeights(options_.lnsReactionFactor_);
+			repairWeights.updateWeights(options_.lnsReactionFactor_);
+			nbItInSegment = 0;
 		}
 
 		std::cout << "**********************************************" << std::endl
@@ -760,7 +1346,24 @@ double DeterministicSolver::solveWithLNS() {
 		pLNSSolver_->unfixDays(isUnfixDay);
 
 		stats_.lnsNbIterations_++;
+
+		// write a checkpoint of the best solution at regular intervals
+		//
+		if (options_.lnsCheckpointInterval_ > 0 && isImprovedSinceCheckpoint
+			&& timeSinceStart-timeLastCheckpoint >= options_.lnsCheckpointInterval_) {
+			this->writeCheckpoint();
+			timeLastCheckpoint = timeSinceStart;
+			isImprovedSinceCheckpoint = false;
+		}
+
+		// stop lns if it does not improve the solution fast enough anymore
+		//
+		if (timeBudget_.isImprovementTooSlow(timeSinceStart, options_.lnsImprovementRateWindow_, options_.lnsMinImprovementRate_)) {
+			std::cout << "Stop the lns: the improvement rate is too low" << std::endl;
+			break;
+		}
 	}
+	std::cout << timeBudget_.toString(pTimerTotal_->dSinceStart());
 
 	std::cout << "END OF LNS" << std::endl << std::endl;
 
@@ -794,21 +1397,30 @@ void DeterministicSolver::initializeLNS() {
 		daysSelectionOperators_.push_back(ALL_WEEKS);
 	}
 
-	// initialize the set of repair operators of the lns
-	repairOperators_.push_back(REPAIR_TWO_DIVES);
-	repairOperators_.push_back(REPAIR_REPEATED_DIVES);
-	repairOperators_.push_back(REPAIR_OPTIMALITY);
+	// initialize the set of repair operators of the lns, from the optimality
+	// level set in the options
+	// the operators are sorted by increasing optimality level
+	for (RepairOperator repair: {REPAIR_TWO_DIVES, REPAIR_REPEATED_DIVES, REPAIR_OPTIMALITY}) {
+		if (repairToOptimalityLevel[repair] >= options_.lnsOptimalityLevel_ || repair == REPAIR_OPTIMALITY) {
+			repairOperators_.push_back(repair);
+		}
+	}
 
 	// initialize the counters of improvements
 	stats_.nbImprovementsWithRepair_.insert(stats_.nbImprovementsWithRepair_.begin(),repairOperators_.size(),0);
 	stats_.nbImprovementsWithNursesSelection_.insert(stats_.nbImprovementsWithNursesSelection_.begin(),nursesSelectionOperators_.size(),0);
 	stats_.nbImprovementsWithDaysSelection_.insert(stats_.nbImprovementsWithDaysSelection_.begin(),daysSelectionOperators_.size(),0);
+
+	// initialize the throughput of the operators
+	stats_.lnsRepairStats_.resize(repairOperators_.size());
+	stats_.lnsNursesSelectionStats_.resize(nursesSelectionOperators_.size());
+	stats_.lnsDaysSelectionStats_.resize(daysSelectionOperators_.size());
 }
 
 
 // Application of the destroy operator
 //
-void DeterministicSolver::adaptiveDestroy(NursesSelectionOperator nurseOp, DaysSelectionOperator dayOp) {
+int DeterministicSolver::adaptiveDestroy(NursesSelectionOperator nurseOp, DaysSelectionOperator dayOp) {
 	// apply the destroy operator
 	std::vector<bool> isFixNurse(pScenario_->nbNurses_,true);
 	std::vector<bool> isFixDay(pScenario_->nbDays(),true);
@@ -836,25 +1448,25 @@ void DeterministicSolver::adaptiveDestroy(NursesSelectionOperator nurseOp, DaysS
 	//
 	switch (nurseOp) {
 		case NURSES_RANDOM: {
-			randIndVector = Tools::drawRandomIndices(nbNursesDestroy,0,pScenario_->nbNurses_-1);
+			randIndVector = Tools::drawRandomIndices(rdm_,nbNursesDestroy,0,pScenario_->nbNurses_-1);
 			for (int ind:randIndVector) {
 				isFixNurse[ind]=false;
 			}
 			break;
 		}
 		case NURSES_POSITION: {
-			int randPos = Tools::drawRandomWithWeights(positionWeights_);
+			int randPos = Tools::drawRandomWithWeights(rdm_,positionWeights_);
 			int nbNursesWithPos = theLiveNursesByPosition_[randPos].size();
-			randIndVector = Tools::drawRandomIndices(nbNursesDestroy,0,nbNursesWithPos-1);
+			randIndVector = Tools::drawRandomIndices(rdm_,nbNursesDestroy,0,nbNursesWithPos-1);
 			for (int ind:randIndVector) {
 				isFixNurse[theLiveNursesByPosition_[randPos][ind]->id_]=false;
 			}
 			break;
 		}
 		case NURSES_CONTRACT: {
-			int randContract = Tools::drawRandomWithWeights(contractWeights_);
+			int randContract = Tools::drawRandomWithWeights(rdm_,contractWeights_);
 			int nbNursesWithContract = theLiveNursesByContract_[randContract].size();
-			randIndVector = Tools::drawRandomIndices(nbNursesDestroy,0,nbNursesWithContract-1);
+			randIndVector = Tools::drawRandomIndices(rdm_,nbNursesDestroy,0,nbNursesWithContract-1);
 			for (int ind:randIndVector) {
 				isFixNurse[theLiveNursesByContract_[randContract][ind]->id_]=false;
 			}
@@ -873,7 +1485,7 @@ void DeterministicSolver::adaptiveDestroy(NursesSelectionOperator nurseOp, DaysS
 		for (int i=1; i< std::max(getNbDays()-nbDaysDestroy-1,6); i++) {
 			weightDays[i] = 0.1;
 		}
-		int firstDay = Tools::drawRandomWithWeights(weightDays); // Tools::randomInt(0, getNbDays()-nbDaysDestroy-1);
+		int firstDay = Tools::drawRandomWithWeights(rdm_,weightDays); // Tools::randomInt(0, getNbDays()-nbDaysDestroy-1);
 		for (int day=0; day <nbDaysDestroy; day++) {
 			isFixDay[firstDay+day] = false;
 		}
@@ -892,6 +1504,10 @@ void DeterministicSolver::adaptiveDestroy(NursesSelectionOperator nurseOp, DaysS
 	}
 	std::cout << std::endl;
 
+	// number of nurse-days that are not fixed anymore
+	int nbNursesRepair = std::count(isFixNurse.begin(), isFixNurse.end(), false);
+	int nbDaysRepair = std::min(nbDaysDestroy, getNbDays());
+	return nbNursesRepair*nbDaysRepair;
 }
 
 
@@ -974,24 +1590,34 @@ void DeterministicSolver::organizeTheLiveNursesByContract() {
 
 // Return a solver with the algorithm specified for resolution
 Solver * DeterministicSolver::setSolverWithInputAlgorithm(PDemand pDemand) {
+	return setSolverWithInputAlgorithm(pDemand, rdm_());
+}
+
+Solver * DeterministicSolver::setSolverWithInputAlgorithm(PDemand pDemand, int rdmSeed) {
+	Solver* pSolver = nullptr;
 	switch(options_.solutionAlgorithm_){
 		case GENCOL:
-		return new RotationMP(pScenario_, pDemand, pScenario_->pWeekPreferences(), pScenario_->pInitialState(), options_.MySolverType_);
+		pSolver = new RotationMP(pScenario_, pDemand, pScenario_->pWeekPreferences(), pScenario_->pInitialState(), options_.MySolverType_);
+		break;
 		default:
 		Tools::throwError("The algorithm is not handled yet");
 		break;
 	}
-	return nullptr;
+	pSolver->setRandomSeed(rdmSeed);
+	return pSolver;
 }
 
 // Return a solver with the input algorithm
 Solver* DeterministicSolver::setSubSolverWithInputAlgorithm(PDemand pDemand, Algorithm algorithm) {
+	Solver* pSolver = nullptr;
 	switch(algorithm){
 		case GENCOL:
-		return new RotationMP(pScenario_, pDemand, pScenario_->pWeekPreferences(), pScenario_->pInitialState(), options_.MySolverType_);
+		pSolver = new RotationMP(pScenario_, pDemand, pScenario_->pWeekPreferences(), pScenario_->pInitialState(), options_.MySolverType_);
+		break;
 		default:
 		Tools::throwError("The algorithm is not handled yet");
 		break;
 	}
-	return nullptr;
+	pSolver->setRandomSeed(rdm_());
+	return pSolver;
 }
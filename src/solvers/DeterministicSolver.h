@@ -12,11 +12,14 @@
 #include "solvers/Solver.h"
 #include "tools/InputPaths.h"
 #include "tools/GlobalStats.h"
+#include "tools/SolutionLog.h"
 #include "solvers/mp/MasterProblem.h"
 
 enum NursesSelectionOperator {NURSES_RANDOM,NURSES_POSITION,NURSES_CONTRACT};
 enum DaysSelectionOperator {TWO_WEEKS,FOUR_WEEKS,ALL_WEEKS};
 enum RepairOperator {REPAIR_TWO_DIVES,REPAIR_REPEATED_DIVES,REPAIR_OPTIMALITY};
+static std::map<RepairOperator,OptimalityLevel> repairToOptimalityLevel =
+	{{REPAIR_TWO_DIVES,TWO_DIVES},{REPAIR_REPEATED_DIVES,REPEATED_DIVES},{REPAIR_OPTIMALITY,OPTIMALITY}};
 
 class DeterministicSolverOptions {
 
@@ -37,6 +40,10 @@ public:
 	int rollingControlHorizon_ = 14;
 	int rollingPredictionHorizon_ = 56;
 
+	// True -> solve the next window of the rolling horizon speculatively in
+	// another thread, starting from the partial solution of the current window
+	bool rollingSpeculative_ = false;
+
 	// True -> find an initial solution with primal-dual procedure
 	// False -> do it otherwise
 	bool withPrimalDual_ = false;
@@ -57,6 +64,43 @@ public:
 	int lnsNbNursesDestroyOverFourWeeks_ = 10;
 	int lnsNbNursesDestroyOverAllWeeks_ = 5;
 
+	// Lowest optimality level of the repairs: the repair operators below this
+	// level are never drawn
+	OptimalityLevel lnsOptimalityLevel_ = TWO_DIVES;
+
+	// Parameters of the adaptive selection of the operators
+	// the weights are updated every lnsSegmentLength_ iterations with the mean
+	// improvement per wall-clock second obtained by each operator in the segment, and
+	// lnsReactionFactor_ sets how fast they react to these scores
+	int lnsSegmentLength_ = 10;
+	double lnsReactionFactor_ = 0.2;
+
+	// Parameters of the time budget
+	// lnsMinTimeFraction_: fraction of the total time that the initial solution
+	// should leave to the LNS (only used to choose the optimality levels)
+	// lnsMinImprovementRate_: the LNS stops when the improvement of the
+	// objective per wall-clock second over the last lnsImprovementRateWindow_ seconds
+	// is below this rate (0 -> never stop early)
+	double lnsMinTimeFraction_ = 0.2;
+	double lnsMinImprovementRate_ = 0.0;
+	double lnsImprovementRateWindow_ = 60.0;
+
+	// Wall-clock time between two checkpoints of the best solution of the LNS
+	// (0 -> no checkpoint)
+	double lnsCheckpointInterval_ = 0.0;
+
+	// True -> append every incumbent and the final statistics to a compact
+	// binary log (solutions.bin) next to the solution
+	bool solutionLog_ = false;
+
+	// True -> polish the final solution with a local search on the rosters
+	// Parameters of the local search: maximum time (limited by the time left),
+	// number of threads and maximum number of days of the swaps
+	bool withLocalSearch_ = false;
+	double localSearchMaxTime_ = 1.0;
+	int localSearchNbThreads_ = 1;
+	int localSearchMaxSegmentLength_ = 7;
+
 	// parameters of column generation
 	bool isStabilization_ = false;
 	bool isStabUpdateCost_ = false;
@@ -88,6 +132,156 @@ public:
 };
 
 
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   L N S O p e r a t o r W e i g h t s
+//
+//  Weights of a family of operators of the adaptive LNS
+//  The operators are drawn according to their weights. Each use of an operator
+//  is scored by the improvement it brings per wall-clock second, and the weights are
+//  updated at the end of each segment of iterations with the mean score of the
+//  operators used in the segment: w = (1-r)*w + r*score.
+//  The operators that are used without improving thus see their weight decay,
+//  down to a minimum ratio of the largest weight to keep some diversity.
+//
+//-----------------------------------------------------------------------------
+
+class LNSOperatorWeights {
+
+public:
+	LNSOperatorWeights(int nbOperators=0, double initialWeight=1.0):
+		weights_(nbOperators,initialWeight), scores_(nbOperators,0.0), nbUses_(nbOperators,0) {}
+	~LNSOperatorWeights() {}
+
+	// Draw an operator according to the weights
+	//
+	int draw(std::minstd_rand& rdm) {return Tools::drawRandomWithWeights(rdm, weights_);}
+
+	// Score the last use of an operator
+	//
+	void addScore(int op, double score) {
+		scores_[op] += score;
+		nbUses_[op]++;
+	}
+
+	// Update the weights with the scores of the segment and start a new segment
+	//
+	void updateWeights(double reactionFactor);
+
+	const std::vector<double>& weights() const {return weights_;}
+
+private:
+	std::vector<double> weights_;
+	std::vector<double> scores_;
+	std::vector<int> nbUses_;
+};
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   T i m e B u d g e t
+//
+//  Central manager of the time of a deterministic solver (on the wall clock)
+//  It shares the time left between the connex components and between the
+//  phases of the solution (initial solution, LNS), predicts the cost of the
+//  work left from the size of the problems and the observed solution
+//  rates, and detects when the LNS does not improve fast enough anymore.
+//  All the times are given with respect to the total timer of the solver.
+//
+//-----------------------------------------------------------------------------
+
+enum BudgetPhase {PHASE_COMPLETE, PHASE_ROLLING, PHASE_LNS, NB_BUDGET_PHASES};
+
+class TimeBudget {
+
+public:
+	TimeBudget() {}
+	~TimeBudget() {}
+
+	// Start a new budget of totalTime seconds at time now
+	//
+	void initialize(double totalTime, double now);
+
+	// Time left in the budget
+	//
+	double timeLeft(double now) const {return startTime_+totalTime_-now;}
+
+	// Time left for the initial solution when a fraction of the total time must
+	// be kept for the improvement phase
+	//
+	double timeLeftForInitialSol(double now, double improveFraction) const {
+		return timeLeft(now)-improveFraction*totalTime_;
+	}
+
+	// Time allowed to a connex component with nbNurses nurses when nbNursesLeft
+	// nurses (this component included) are still to be scheduled
+	// The time left is shared in proportion of the predicted costs, so the time
+	// unused by the previous components is given back to the next ones, and the
+	// last component gets all the time left
+	//
+	double componentTimeLimit(double now, int nbNurses, int nbNursesLeft) const;
+
+	// Record the time spent in the solution of a problem with the input
+	// number of nurse-days that are not fixed, and update the rate of the phase
+	//
+	void recordRate(BudgetPhase phase, int nbNurseDays, double seconds);
+
+	// True if at least one rate has been recorded for the phase
+	//
+	bool isRateObserved(BudgetPhase phase) const {return nbObservations_[phase] > 0;}
+
+	// Copy the rates observed by another budget (e.g. in a connex component)
+	//
+	void copyRates(const TimeBudget& budget) {
+		secondsPerNurseDay_ = budget.secondsPerNurseDay_;
+		nbObservations_ = budget.nbObservations_;
+	}
+
+	// Predicted time of a problem with the input number of free nurse-days
+	//
+	double predictedTime(BudgetPhase phase, int nbNurseDays) const {
+		return secondsPerNurseDay_[phase]*nbNurseDays;
+	}
+
+	// Mark the start of the LNS
+	//
+	void startLNS(double now) {
+		lnsStartTime_ = now;
+		improvements_.clear();
+	}
+
+	// Record the improvement of the objective obtained by a LNS iteration ending
+	// at time now
+	//
+	void recordImprovement(double now, double improvement);
+
+	// True if the improvement per wall-clock second over the last window seconds is below
+	// minRate (never true before the LNS has run for window seconds)
+	//
+	bool isImprovementTooSlow(double now, double window, double minRate) const;
+
+	// Display the budget
+	//
+	std::string toString(double now) const;
+
+private:
+	double totalTime_ = LARGE_TIME;
+	double startTime_ = 0.0;
+
+	// Observed time per free nurse-day in each phase
+	// The rates are initialized with a rough prior and smoothed exponentially
+	// when new observations are recorded
+	//
+	std::vector<double> secondsPerNurseDay_ = std::vector<double>(NB_BUDGET_PHASES,0.02);
+	std::vector<int> nbObservations_ = std::vector<int>(NB_BUDGET_PHASES,0);
+
+	// Time and value of the improvements recorded in the LNS
+	//
+	double lnsStartTime_ = -1.0;
+	std::vector<std::pair<double,double> > improvements_;
+};
+
+
 //-----------------------------------------------------------------------------
 //
 //  C l a s s   D e t e r m i n i s t i c S o l v e r
@@ -125,6 +319,7 @@ public:
 		rollingParameters_ = pSolver->getRollingParameters();
 		lnsParameters_ = pSolver->getLnsParameters();
 		completeParameters_ = pSolver->getCompleteParameters();
+		timeBudget_.copyRates(pSolver->getTimeBudget());
 	}
 
 	// Initialize deterministic options with default values
@@ -135,7 +330,7 @@ public:
 	//
 	void readOptionsFromFile(InputPaths& inputPaths);
 
-	// Set total cpu time available to the solution
+	// Set total wall-clock time available to the solution
 	//
 	void setTotalTimeLimit(double t) {
 		options_.totalTimeLimitSeconds_ = t;
@@ -167,6 +362,18 @@ public:
 protected:
 	GlobalStats stats_;
 
+	//----------------------------------------------------------------------------
+	//
+	// TIME BUDGET OF THE OVERALL SOLUTION PROCESS
+	//
+	//----------------------------------------------------------------------------
+
+protected:
+	TimeBudget timeBudget_;
+
+public:
+	const TimeBudget& getTimeBudget() const {return timeBudget_;}
+
 
 	//----------------------------------------------------------------------------
 	//
@@ -177,11 +384,17 @@ protected:
 
 public:
 	// Main function
+	// If an initial solution is input, the initial solution phase is skipped and
+	// the LNS directly starts from this solution
 	double solve(std::vector<Roster> initialSolution = {});
 
 	// Solve the problem using a decomposition of the set nurses by connex components
 	// of the rcspp of positions
-	double solveByConnexPositions();
+	double solveByConnexPositions(const std::vector<Roster>& initialSolution = {});
+
+	// Load an initial solution in a new solver as if it had been found by the
+	// initial solution phase
+	double solveFromInitialSolution(std::vector<Roster> initialSolution);
 
 protected:
 
@@ -191,6 +404,56 @@ protected:
 	// After the end of a solution process: retrieve status, solution, etc.
 	double treatResults(Solver* pSolver);
 
+	//----------------------------------------------------------------------------
+	//
+	// CHECKPOINTS OF THE SOLUTION
+	// The current solution is periodically written in the format of the output
+	// files, so that a later run can start from it with --init-sol
+	//
+	//----------------------------------------------------------------------------
+
+public:
+	// Write the current solution in the checkpoint directory
+	// The solver of a connex component gives its rosters to the solver of the
+	// complete scenario, which writes only when every nurse has a roster
+	//
+	void writeCheckpoint();
+
+protected:
+	// Directory of the checkpoints (empty -> no checkpoint)
+	std::string checkpointPath_;
+
+	// Solver of the complete scenario when solving a connex component
+	DeterministicSolver* pParentSolver_ = nullptr;
+
+	// True for the nurses whose roster has been computed at least once
+	std::vector<bool> isNurseScheduled_;
+
+	// Mark the nurses of the input solver as scheduled and copy their rosters
+	void storeComponentRosters(DeterministicSolver* pSolver, const std::vector<Roster>& solution);
+
+	//----------------------------------------------------------------------------
+	//
+	// LOG OF THE SOLUTIONS
+	// Every incumbent is appended to a compact binary log with its cost
+	// breakdown, the text files of the validator are still written at the end
+	//
+	//----------------------------------------------------------------------------
+
+public:
+	// Append the current solution to the log of the solutions
+	// As for the checkpoints, the solver of a connex component gives its rosters
+	// to the solver of the complete scenario
+	//
+	void logIncumbent(const std::string& phase, int iteration = 0);
+
+	// Append the statistics of the run to the log of the solutions
+	void logStats();
+
+protected:
+	// Log of the solutions (nullptr -> no log)
+	std::unique_ptr<SolutionLogWriter> pSolutionLog_;
+
 
 	//----------------------------------------------------------------------------
 	//
@@ -241,6 +504,21 @@ private:
 	//
 	void rollingSetOptimalityLevel(int firstDay);
 
+	// Solve speculatively the window of the rolling horizon starting on firstDay
+	// in a new solver: the days until lastFixedDay are fixed to their values in
+	// the predicted solution
+	// The seed of the random generator of the new solver is given, because the
+	// method runs in another thread
+	// Return the solution of the window (empty if none was found)
+	//
+	std::vector<Roster> rollingSpeculativeSolve(std::vector<Roster> prediction,
+		int lastFixedDay, int firstDay, SolverParam param, int rdmSeed);
+
+	// Check if the solution matches the speculative solution from firstDay to lastDay
+	//
+	bool isSpeculationConsistent(const std::vector<Roster>& solution,
+		const std::vector<Roster>& speculativeSolution, int firstDay, int lastDay);
+
 	//----------------------------------------------------------------------------
 	//
 	// SOLUTION WITH LARGE NEIGHBORHOOD SEARCH
@@ -264,8 +542,9 @@ protected:
 	void initializeLNS();
 
 	// Application of the destroy operator
+	// Return the number of nurse-days that are not fixed anymore
 	//
-	void adaptiveDestroy(NursesSelectionOperator nurseOp, DaysSelectionOperator dayOp);
+	int adaptiveDestroy(NursesSelectionOperator nurseOp, DaysSelectionOperator dayOp);
 
 	// Initialize the organized vectors of live nurses
 	//
@@ -302,8 +581,11 @@ protected:
 
 protected:
 	// Return a solver with the algorithm specified in the options_
+	// The random generator of the new solver is seeded with the generator of
+	// this solver, unless a seed is given
 	//
 	Solver * setSolverWithInputAlgorithm(PDemand pDemand);
+	Solver * setSolverWithInputAlgorithm(PDemand pDemand, int rdmSeed);
 	Solver* setSubSolverWithInputAlgorithm(PDemand pDemand, Algorithm algorithm);
 
 
@@ -0,0 +1,191 @@
+/*
+ * Greedy.cpp
+ *
+ *  Created on: October 5, 2020
+ */
+
+#include "solvers/Greedy.h"
+
+using std::vector;
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   G r e e d y
+//
+//  Constructive heuristic that builds the rosters day by day
+//
+//-----------------------------------------------------------------------------
+
+// Constructor: sort the shifts and the skills in the order in which their
+// demand is covered
+Greedy::Greedy(PScenario pScenario, PDemand pDemand,
+	PPreferences pPreferences, vector<State>* pInitState):
+	Solver(pScenario, pDemand, pPreferences, pInitState) {
+
+	// the shift 0 is always rest and it is never covered
+	vector<int> nbForbiddenSuccessors(pScenario_->nbShifts_, 0);
+	for (int sh = 1; sh < pScenario_->nbShifts_; sh++) {
+		shiftsSorted_.push_back(sh);
+		nbForbiddenSuccessors[sh] = pScenario_->nbForbiddenSuccessorsShift(sh);
+	}
+	ShiftSorter compareShifts(nbForbiddenSuccessors);
+	std::stable_sort(shiftsSorted_.begin(), shiftsSorted_.end(), compareShifts);
+
+	// the rarest skills are covered first
+	// the rarities are not written in the positions of the scenario, because
+	// the positions may be shared with other solvers
+	if (!pDemand_->isPreprocessed_) pDemand_->preprocessDemand();
+	for (int sk = 0; sk < pScenario_->nbSkills_; sk++) {
+		skillsSorted_.push_back(sk);
+		int nbNursesWithSkill = 0;
+		for (PLiveNurse pNurse: theLiveNurses_) {
+			if (pNurse->hasSkill(sk)) nbNursesWithSkill++;
+		}
+		skillRarity_[sk] = (double)pDemand_->minPerSkill_[sk]/std::max(1, nbNursesWithSkill);
+	}
+	SkillSorter compareSkills(skillRarity_);
+	std::stable_sort(skillsSorted_.begin(), skillsSorted_.end(), compareSkills);
+}
+
+Greedy::~Greedy() {}
+
+// Build the rosters day by day and return the cost of the solution
+double Greedy::solve(vector<Roster> solution) {
+
+	int nbDays = pDemand_->nbDays_;
+	int nbShifts = pScenario_->nbShifts_, nbSkills = pScenario_->nbSkills_;
+
+	resetRosters();
+	vector3D<int> staffing;
+	Tools::initVector3D(staffing, nbDays, nbShifts, nbSkills, 0);
+
+	for (int day = 0; day < nbDays; day++) {
+		isAssigned_.assign(theLiveNurses_.size(), false);
+
+		// cover the minimum demand first, and then the optimal demand
+		for (bool isOptimalDemand: {false, true}) {
+			for (int sh: shiftsSorted_) {
+				for (int sk: skillsSorted_) {
+					int demand = isOptimalDemand ? pDemand_->optDemand_[day][sh][sk] :
+						pDemand_->minDemand_[day][sh][sk];
+
+					while (staffing[day][sh][sk] < demand) {
+						// find the nurse whose assignment is the cheapest
+						// the nurses with the fewest skills are preferred in case of ties
+						PLiveNurse pBestNurse(nullptr);
+						double bestCost = LARGE_SCORE;
+						for (PLiveNurse pNurse: theLiveNurses_) {
+							if (!isAvailable(pNurse, day, sh, sk)) continue;
+							double cost = costOfTask(pNurse, day, sh);
+							if (cost < bestCost || (pBestNurse && cost == bestCost
+									&& pNurse->nbSkills_ < pBestNurse->nbSkills_)) {
+								bestCost = cost;
+								pBestNurse = pNurse;
+							}
+						}
+
+						// the optimal demand is covered only if the assignment is
+						// cheaper than the missing nurse
+						if (!pBestNurse) break;
+						if (isOptimalDemand && bestCost >= WEIGHT_OPTIMAL_DEMAND) break;
+
+						pBestNurse->roster_.assignTask(day, sh, sk);
+						isAssigned_[pBestNurse->id_] = true;
+						staffing[day][sh][sk]++;
+					}
+				}
+			}
+		}
+
+		// update the states of the nurses at the beginning of the next day
+		for (PLiveNurse pNurse: theLiveNurses_) {
+			int shift = pNurse->roster_.shift(day);
+			pNurse->states_[day+1].addDayToState(pNurse->states_[day],
+				pScenario_->shiftIDToShiftTypeID_[shift], shift, pScenario_->timeDurationToWork_[shift]);
+		}
+	}
+
+	// store the solution and get its cost
+	solution_.clear();
+	for (PLiveNurse pNurse: theLiveNurses_) {
+		solution_.push_back(pNurse->roster_);
+	}
+	objValue_ = computeSolutionCost();
+	status_ = (objValue_ < LARGE_SCORE) ? FEASIBLE : INFEASIBLE;
+
+	return objValue_;
+}
+
+// Reset the rosters and the states of the nurses
+void Greedy::resetRosters() {
+	int nbDays = pDemand_->nbDays_;
+	for (PLiveNurse pNurse: theLiveNurses_) {
+		pNurse->nbDays_ = nbDays;
+		pNurse->roster_.init(nbDays, pDemand_->firstDay_);
+		pNurse->statCt_.init(nbDays);
+		pNurse->states_.resize(nbDays+1);
+		pNurse->states_[0] = *(pNurse->pStateIni_);
+		pNurse->buildStates();
+	}
+	// the constraint statuses were reinitialized
+	costEvaluator_.reset();
+}
+
+// Check the hard constraints: one task per day, skill of the nurse and
+// forbidden successions
+bool Greedy::isAvailable(PLiveNurse pNurse, int day, int shift, int skill) {
+	if (isAssigned_[pNurse->id_]) return false;
+	if (!pNurse->hasSkill(skill)) return false;
+	return !pScenario_->isForbiddenSuccessorShift_ShiftType(shift, pNurse->states_[day].shiftType_);
+}
+
+// Marginal cost of the assignment with respect to the soft constraints that
+// are checked in LiveNurse::checkConstraints
+double Greedy::costOfTask(PLiveNurse pNurse, int day, int shift) {
+	const State& state = pNurse->states_[day];
+	int shiftType = pScenario_->shiftIDToShiftTypeID_[shift];
+	double cost = 0.0;
+
+	// consecutive days off and worked days
+	if (state.shiftType_ == 0 && state.consDaysOff_ < pNurse->minConsDaysOff()) {
+		cost += WEIGHT_CONS_DAYS_OFF*(pNurse->minConsDaysOff()-state.consDaysOff_);
+	}
+	if (state.shiftType_ > 0 && state.consDaysWorked_ >= pNurse->maxConsDaysWork()) {
+		cost += WEIGHT_CONS_DAYS_WORK;
+	}
+	// working is rewarded when the nurse would otherwise pay for a too short
+	// sequence of worked days or shifts
+	if (pNurse->needWork(day)) {
+		cost -= WEIGHT_CONS_DAYS_WORK;
+	}
+
+	// consecutive shifts
+	if (state.shiftType_ > 0 && state.shiftType_ != shiftType) {
+		int missingShifts = pScenario_->minConsShiftsOf(state.shiftType_)-state.consShifts_;
+		if (missingShifts > 0) cost += WEIGHT_CONS_SHIFTS*missingShifts;
+	}
+	if (state.shiftType_ == shiftType && state.consShifts_ >= pScenario_->maxConsShiftsOf(shiftType)) {
+		cost += WEIGHT_CONS_SHIFTS;
+	}
+
+	// preferences
+	int level = pNurse->wishesOffLevel(day, shift);
+	if (level >= 0) cost += WEIGHT_PREFERENCES_OFF[level];
+	level = pNurse->wishesOnLevel(day, shift);
+	if (level >= 0) cost += WEIGHT_PREFERENCES_ON[level];
+
+	// complete week-ends
+	if (Tools::isSunday(day) && pNurse->needCompleteWeekends()) {
+		cost += (state.shiftType_ > 0) ? -WEIGHT_COMPLETE_WEEKEND : WEIGHT_COMPLETE_WEEKEND;
+	}
+
+	// total number of worked days and week-ends
+	if (state.totalTimeWorked_+pScenario_->timeDurationToWork_[shift] > pNurse->maxTotalShifts()) {
+		cost += WEIGHT_TOTAL_SHIFTS;
+	}
+	if (Tools::isSaturday(day) && state.totalWeekendsWorked_ >= pNurse->maxTotalWeekends()) {
+		cost += WEIGHT_TOTAL_WEEKENDS;
+	}
+
+	return cost;
+}
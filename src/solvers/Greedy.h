@@ -0,0 +1,57 @@
+/*
+ * Greedy.h
+ *
+ *  Created on: October 5, 2020
+ */
+
+#ifndef __Greedy__
+#define __Greedy__
+
+#include "solvers/Solver.h"
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   G r e e d y
+//
+//  Constructive heuristic that builds the rosters day by day
+//  On each day, the minimum demand of each shift and skill is covered first,
+//  and the optimal demand is then covered as long as the marginal cost of the
+//  assignment is smaller than the cost of the missing nurse
+//  The nurse assigned to a task is the one whose roster is the least penalized
+//  by the assignment with respect to the current state of their contract
+//  The solver takes milliseconds, so it is used as a cheap proxy of the
+//  column generation to evaluate the schedules in the stochastic solver
+//
+//-----------------------------------------------------------------------------
+
+class Greedy: public Solver {
+
+public:
+
+	Greedy(PScenario pScenario, PDemand pDemand,
+		PPreferences pPreferences, std::vector<State>* pInitState);
+	~Greedy();
+
+	// Build the rosters of all the nurses and return the cost of the solution
+	// the input solution is ignored
+	double solve(std::vector<Roster> solution = {}) override;
+
+protected:
+
+	// reset the rosters and the states of the nurses so that the solver can be
+	// called again with another demand
+	void resetRosters();
+
+	// return true if the nurse can perform the shift on the day with the skill
+	// without violating a hard constraint
+	bool isAvailable(PLiveNurse pNurse, int day, int shift, int skill);
+
+	// marginal cost of assigning the shift on the day to the nurse given the
+	// state at the beginning of the day
+	double costOfTask(PLiveNurse pNurse, int day, int shift);
+
+	// true if the nurse has already been assigned a task on the current day
+	std::vector<bool> isAssigned_;
+};
+
+#endif
@@ -8,7 +8,8 @@
 
 #include "solvers/InitializeSolver.h"
 #include "tools/ReadWrite.h"
-//#include "solvers/Greedy.h"
+#include "tools/ScenarioSnapshot.h"
+#include "solvers/Greedy.h"
 #include "solvers/mp/RotationMP.h"
 #include "tools/MyTools.h"
 
@@ -19,8 +20,8 @@
 #include <sys/types.h>
 
 //initialize the counter of objects
-unsigned int MyObject::s_count = 0;
-unsigned int Rotation::s_count = 0;
+std::atomic<unsigned int> MyObject::s_count(0);
+std::atomic<unsigned int> Rotation::s_count(0);
 
 
 using std::string;
@@ -71,6 +72,14 @@ InputPaths* readNonCompactArguments(int argc, char** argv) {
 			pInputPaths->paramFile(str);
 			narg += 2;
 		}
+		else if (!strcmp(argv[narg],"--init-sol")) {
+			pInputPaths->initialSolutionPath(str);
+			narg += 2;
+		}
+		else if (!strcmp(argv[narg],"--snapshot")) {
+			pInputPaths->snapshotPath(str);
+			narg += 2;
+		}
 		else if (!strcmp(argv[narg],"--timeout")) {
 			pInputPaths->timeOut(std::stod(str));
 			narg += 2;
@@ -107,7 +116,7 @@ InputPaths* readCompactArguments(int argc, char** argv) {
 
 	// Default arguments are set to enable simple call to the function without argument
 	//
-	std::string dataDir = "",instanceName = "",solutionPath="",logPath="",paramFile="";
+	std::string dataDir = "",instanceName = "",solutionPath="",logPath="",paramFile="",initialSolutionPath="",snapshotPath="";
 	int historyIndex = 0, randSeed=0;
 	bool shortSP = true;
 	std::vector<int> weekIndices;
@@ -158,6 +167,14 @@ InputPaths* readCompactArguments(int argc, char** argv) {
 			paramFile = str;
 			narg += 2;
 		}
+		else if (!strcmp(arg,"--init-sol")) {
+			initialSolutionPath = str;
+			narg += 2;
+		}
+		else if (!strcmp(arg,"--snapshot")) {
+			snapshotPath = str;
+			narg += 2;
+		}
 		else if (!strcmp(arg,"--timeout")) {
 			timeOut = std::stod(str);
 			narg += 2;
@@ -181,11 +198,52 @@ InputPaths* readCompactArguments(int argc, char** argv) {
 	//
 	InputPaths* pInputPaths =
 	  new InputPaths(dataDir, instanceName, historyIndex,weekIndices,solutionPath,logPath,paramFile,timeOut,randSeed,shortSP);
+	pInputPaths->initialSolutionPath(initialSolutionPath);
+	pInputPaths->snapshotPath(snapshotPath);
 
 	return pInputPaths;
 }
 
 
+/************************************************************************
+* Binary snapshots of the preprocessed scenarios (option --snapshot)
+* The key of a snapshot lists the input files with their size and their time
+* of last modification, and the number of weeks read, so that a snapshot is
+* only restored for the same instance and is invalidated when a file changes
+*************************************************************************/
+
+string snapshotFileSignature(const string& fileName) {
+	std::stringstream signature;
+	signature << fileName;
+	struct stat fileStat;
+	if (stat(fileName.c_str(), &fileStat) == 0) {
+		signature << ":" << fileStat.st_size << ":" << fileStat.st_mtime;
+	}
+	return signature.str();
+}
+
+string snapshotKey(const InputPaths & inputPaths, int nbWeeks) {
+	std::stringstream key;
+	key << snapshotFileSignature(inputPaths.scenario()) << " " << snapshotFileSignature(inputPaths.history());
+	for (int w=0; w < nbWeeks; w++) key << " " << snapshotFileSignature(inputPaths.week(w));
+	return key.str();
+}
+
+PScenario readSnapshot(const InputPaths & inputPaths, int nbWeeks) {
+	if (inputPaths.snapshotPath().empty()) return nullptr;
+	PScenario pScen = ScenarioSnapshot::read(inputPaths.snapshotPath(), snapshotKey(inputPaths, nbWeeks));
+	if (pScen) std::cout << "Restored the scenario from " << inputPaths.snapshotPath() << std::endl;
+	return pScen;
+}
+
+void writeSnapshot(PScenario pScen, const InputPaths & inputPaths, int nbWeeks) {
+	if (inputPaths.snapshotPath().empty()) return;
+	// the connex components of the positions are saved with the scenario
+	pScen->computeConnexPositions();
+	ScenarioSnapshot::write(pScen, inputPaths.snapshotPath(), snapshotKey(inputPaths, nbWeeks));
+	std::cout << "Wrote the snapshot " << inputPaths.snapshotPath() << std::endl;
+}
+
 /************************************************************************
 * Initialize the week scenario by reading the input files
 *************************************************************************/
@@ -219,12 +277,16 @@ PScenario initializeScenario(string scenPath, string demandPath, string historyP
 
 PScenario initializeScenario(const InputPaths & inputPaths, string logPath) {
 
+	// Restore the scenario of a previous run on the same files if possible
+	PScenario pScen = readSnapshot(inputPaths, 1);
+	if (pScen) return pScen;
+
 	// Initialize demand and preferences
 	PDemand pDemand(nullptr);
 	PPreferences pPref(nullptr);
 
 	// Read the scenario
-	PScenario pScen = ReadWrite::readScenario(inputPaths.scenario());
+	pScen = ReadWrite::readScenario(inputPaths.scenario());
 
 	// Read the demand and preferences and link them with the scenario
 	ReadWrite::readWeek(inputPaths.week(0), pScen,&pDemand,&pPref);
@@ -233,6 +295,7 @@ PScenario initializeScenario(const InputPaths & inputPaths, string logPath) {
 
 	// Read the history
 	ReadWrite::readHistory(inputPaths.history(), pScen);
+	writeSnapshot(pScen, inputPaths, 1);
 
 	// Check that the scenario was read properly if logfile specified in input
 	if (!logPath.empty()) {
@@ -276,14 +339,19 @@ PScenario initializeMultipleWeeks(string dataDir, string instanceName,
 
 PScenario initializeMultipleWeeks(const InputPaths & inputPaths, string logPath) {
 
+	// Restore the scenario of a previous run on the same files if possible
+	PScenario pScen = readSnapshot(inputPaths, inputPaths.nbWeeks());
+	if (pScen) return pScen;
+
 	// Read the scenario
-	PScenario pScen = ReadWrite::readScenario(inputPaths.scenario());
+	pScen = ReadWrite::readScenario(inputPaths.scenario());
 
 	// Read the demand and preferences and link them with the scenario
 	ReadWrite::readWeeks(inputPaths.weeks(), pScen);
 
 	// Read the history
 	ReadWrite::readHistory(inputPaths.history(), pScen);
+	writeSnapshot(pScen, inputPaths, inputPaths.nbWeeks());
 
 	// Check that the scenario was read properly if logfile specified in input
 	if (!logPath.empty()) {
@@ -346,18 +414,9 @@ vector<PScenario> divideScenarioIntoConnexPositions(PScenario pScenario) {
 		PDemand pDemand = pScenario->pWeekDemand();
 
 		// erase the skills to remove from the minimum and optimal demands
-		vector3D<int> minDemand = pDemand->minDemand_;
-		vector3D<int> optDemand = pDemand->optDemand_;
-		for (int day = 0; day < pDemand->nbDays_; day++) {
-    		for (int shift = 0; shift < pDemand->nbShifts_; shift++) {
-				for (int skill:skillsToRemove) {
-					minDemand[day][shift][skill] = 0;
-					optDemand[day][shift][skill] = 0;
-				}
-			}
-		}
-		PDemand pDemandInTheComponent = std::make_shared<Demand>(pDemand->nbDays_, pDemand->firstDay_, pDemand->nbShifts_,
-		 pDemand->nbSkills_, pDemand->name_, minDemand, optDemand);
+		// the copy shares the tables of the demand until the skills are removed
+		PDemand pDemandInTheComponent = std::make_shared<Demand>(*pDemand);
+		pDemandInTheComponent->removeSkills(skillsToRemove);
 
 		// create the preferences that relate only to the nurses of the connex component
 		//
@@ -409,9 +468,9 @@ Solver* setSolverWithInputAlgorithm(PScenario pScen, Algorithm algorithm) {
 
 	Solver* pSolver = nullptr;
 	switch(algorithm){
-	// case GREEDY:
-	// 	pSolver = new Greedy(pScen, pScen->pWeekDemand(), pScen->pWeekPreferences(), pScen->pInitialState());
-	// 	break;
+	case GREEDY:
+		pSolver = new Greedy(pScen, pScen->pWeekDemand(), pScen->pWeekPreferences(), pScen->pInitialState());
+		break;
 	case GENCOL:
 		// DBG: ICI, ON CHOISIT SI ON UTILISE CLP OU GUROBI, A TERME IL CHOISIR EN FONCTION D'UNE OPTION...
 //	   		pSolver = new MasterProblem(pScen, pScen->pWeekDemand(), pScen->pWeekPreferences(), pScen->pInitialState(), S_Gurobi);
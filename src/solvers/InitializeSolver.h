@@ -16,6 +16,11 @@
 InputPaths* readNonCompactArguments(int argc, char** argv);
 InputPaths* readCompactArguments(int argc, char** argv);
 
+// Read or write the binary snapshot of the scenario read from the input
+// files (nothing is done if no snapshot path is given)
+PScenario readSnapshot(const InputPaths & inputPaths, int nbWeeks);
+void writeSnapshot(PScenario pScen, const InputPaths & inputPaths, int nbWeeks);
+
 //Initialize the week scenario by reading the input files
 PScenario initializeScenario(std::string scenFile, std::string demandFile, std::string historyFile, std::string logFile="");
 PScenario initializeScenario(const InputPaths & inputPaths, std::string logPath="");
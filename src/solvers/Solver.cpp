@@ -8,6 +8,8 @@
 
 #include <math.h>
 #include <cmath>
+#include <atomic>
+#include <thread>
 #include "solvers/Solver.h"
 #include "solvers/mp/RotationMP.h"
 
@@ -126,25 +128,25 @@ const std::map<int,std::vector<Wish> > & LiveNurse::wishesOn() const {
 // returns true if the nurse wishes the day-shift off
 //
 bool LiveNurse::wishesOff(int day, int shift) const {
-  return Preferences::wishLevel(wishesOff(), day, shift) != -1;
+  return pPreferences_->wantsTheShiftOffLevel(originalNurseId_, day, shift) != -1;
 }
 
 // returns true if the nurse wishes the day-shift off
 //
 int LiveNurse::wishesOffLevel(int day, int shift) const {
-  return Preferences::wishLevel(wishesOff(), day, shift);
+  return pPreferences_->wantsTheShiftOffLevel(originalNurseId_, day, shift);
 }
 
 // returns true if the nurse wishes the day-shift off
 //
 bool LiveNurse::wishesOn(int day, int shift) const {
-  return Preferences::wishLevel(wishesOn(), day, shift) != -1;
+  return pPreferences_->wantsTheShiftOnLevel(originalNurseId_, day, shift) != -1;
 }
 
 // returns true if the nurse wishes the day-shift off
 //
 int LiveNurse::wishesOnLevel(int day, int shift) const {
-  return Preferences::wishLevel(wishesOn(), day, shift);
+  return pPreferences_->wantsTheShiftOnLevel(originalNurseId_, day, shift);
 }
 
 // returns true if the nurses reached the maximum number of consecutive worked
@@ -203,10 +205,18 @@ bool LiveNurse::isFreeToChoose(int day) {
 // remaining margin for the satisfied ones.
 //
 void LiveNurse::checkConstraints(const Roster& roster,
-	const vector<State>& states, StatCtNurse& stat) {
+	const RosterBits& bits, StatCtNurse& stat) {
+	checkConstraints(roster, bits, stat, 0, nbDays_-1);
+}
+
+// the counters of the states are read in the image of the roster: the states
+// of the days before firstDay are never built
+//
+void LiveNurse::checkConstraints(const Roster& roster,
+	const RosterBits& bits, StatCtNurse& stat, int firstDay, int lastDay) {
 	// check the satisfaction of the hard constraints and record the violations
 	//
-	for (int day = 0; day < nbDays_; day++) {
+	for (int day = firstDay; day <= lastDay; day++) {
 
 		// Check that the nurse has the assigned skill
 		//
@@ -219,7 +229,7 @@ void LiveNurse::checkConstraints(const Roster& roster,
 
 		// Check the forbidden successor constraint
 		//
-		int lastShiftType = states[day].shiftType_;   // last shift assigned to the nurse
+		int lastShiftType = bits.shiftType(day-1);   // last shift assigned to the nurse
 		int thisShift = roster.shift(day);    // shift assigned on this day
 
 		stat.violSuccShifts_[day] = pScenario_->isForbiddenSuccessorShift_ShiftType(thisShift,lastShiftType);
@@ -228,93 +238,96 @@ void LiveNurse::checkConstraints(const Roster& roster,
 	// check the soft constraints and record the costs of the violations and the
 	// remaining margin for the satisfied ones.
 	//
-	for (int day = 1; day <= nbDays_; day++) {
+	for (int day = firstDay; day <= lastDay; day++) {
 
-		// shift assigned on the previous day
-		int shift = states[day].shift_;
-		int shiftType = states[day].shiftType_;
-		int prevShiftType = states[day-1].shiftType_;
+		// shift assigned on the day
+		int shift = roster.shift(day);
+		int shiftType = bits.shiftType(day);
+		int prevShiftType = bits.shiftType(day-1);
 
 		// first look at consecutive working days or days off
 		//
 		int missingDays=0, extraDays=0;
-		stat.costConsDays_[day-1] = 0;
-		stat.costConsDaysOff_[day-1] = 0;
+		stat.costConsDays_[day] = 0;
+		stat.costConsDaysOff_[day] = 0;
 
 		// compute the violations of consecutive working days an
 		if (shiftType) {
 			if (prevShiftType == 0) {
-				missingDays = minConsDaysOff()-states[day-1].consDaysOff_;
+				missingDays = minConsDaysOff()-bits.consDaysOff(day-1);
 			}
 
-			stat.costConsDaysOff_[day-1] += (missingDays>0) ? WEIGHT_CONS_DAYS_OFF*missingDays:0;
-			stat.costConsDays_[day-1] += (states[day].consDaysWorked_>maxConsDaysWork()) ? WEIGHT_CONS_DAYS_WORK:0;
+			stat.costConsDaysOff_[day] += (missingDays>0) ? WEIGHT_CONS_DAYS_OFF*missingDays:0;
+			stat.costConsDays_[day] += (bits.consDaysWorked(day)>maxConsDaysWork()) ? WEIGHT_CONS_DAYS_WORK:0;
 		}
 		else {
 			if (prevShiftType > 0) {
-				missingDays =minConsDaysWork()-states[day-1].consDaysWorked_;
+				missingDays =minConsDaysWork()-bits.consDaysWorked(day-1);
 			}
-			extraDays = states[day].consDaysOff_-maxConsDaysOff();
+			extraDays = bits.consDaysOff(day)-maxConsDaysOff();
 
-			stat.costConsDays_[day-1] += (missingDays>0) ? WEIGHT_CONS_DAYS_WORK*missingDays:0;
-			stat.costConsDaysOff_[day-1] += (extraDays>0) ? WEIGHT_CONS_DAYS_OFF:0;
+			stat.costConsDays_[day] += (missingDays>0) ? WEIGHT_CONS_DAYS_WORK*missingDays:0;
+			stat.costConsDaysOff_[day] += (extraDays>0) ? WEIGHT_CONS_DAYS_OFF:0;
 		}
 
 		// check the consecutive same shifts
 		//
-		stat.costConsShifts_[day-1]= 0;
+		stat.costConsShifts_[day]= 0;
 		int missingShifts = 0;
 
 		// count the penalty for minimum consecutive shifts only for the previous day
 		// when the new shift is different
 		if (shiftType != prevShiftType && prevShiftType > 0)  {
-		  missingShifts = pScenario_->minConsShiftsOf(prevShiftType)-states[day-1].consShifts_;
-		  stat.costConsShifts_[day-1] += (missingShifts>0) ? WEIGHT_CONS_SHIFTS*missingShifts:0;
+		  missingShifts = pScenario_->minConsShiftsOf(prevShiftType)-bits.consShifts(day-1);
+		  stat.costConsShifts_[day] += (missingShifts>0) ? WEIGHT_CONS_SHIFTS*missingShifts:0;
 		}
 
 		// count the penalty for maximum consecutive shifts when the shift is worked
 		// the last day will then be counted
 		if (shiftType > 0) {
-		  stat.costConsShifts_[day-1] +=
-		    (states[day].consShifts_>pScenario_->maxConsShiftsOf(shiftType)) ? WEIGHT_CONS_SHIFTS:0;
+		  stat.costConsShifts_[day] +=
+		    (bits.consShifts(day)>pScenario_->maxConsShiftsOf(shiftType)) ? WEIGHT_CONS_SHIFTS:0;
 		}
 
 		// check the preferences
 		//
-		stat.costPref_[day-1] = 0;
-		int l = wishesOffLevel(day-1, shift);
+		stat.costPref_[day] = 0;
+		int l = wishesOffLevel(day, shift);
 		if(l>=0)
-		  stat.costPref_[day-1] += WEIGHT_PREFERENCES_OFF[l];
-    l = wishesOnLevel(day-1, shift);
+		  stat.costPref_[day] += WEIGHT_PREFERENCES_OFF[l];
+    l = wishesOnLevel(day, shift);
     if(l>=0)
-      stat.costPref_[day-1] += WEIGHT_PREFERENCES_ON[l];
+      stat.costPref_[day] += WEIGHT_PREFERENCES_ON[l];
 
 		// check the complete week-end (only if the nurse requires them)
 		// this cost is only assigned to the sundays
 		//
-		stat.costWeekEnd_[day-1] = 0;
-		if ( Tools::isSunday(day-1) && needCompleteWeekends()) {
+		stat.costWeekEnd_[day] = 0;
+		if ( Tools::isSunday(day) && needCompleteWeekends()) {
 			if ( (shiftType > 0 && prevShiftType == 0) || ( shiftType == 0 && prevShiftType > 0 )) {
-				stat.costWeekEnd_[day-1] = WEIGHT_COMPLETE_WEEKEND;
+				stat.costWeekEnd_[day] = WEIGHT_COMPLETE_WEEKEND;
 			}
 		}
 
 	} // end for day
 
 	// get the costs due to total number of working days and week-ends
+	// the totals of the final state are popcounts of the image
 	//
 	stat.costTotalDays_ = 0;
 	stat.costTotalWeekEnds_ = 0;
 	if (true) {//pScenario_->thisWeek() == pScenario_->nbWeeks_) {
+		int totalTimeWorked = bits.totalTimeWorked(nbDays_-1);
 		int missingDays=0, extraDays=0;
-		missingDays = std::max(0, minTotalShifts() - states[nbDays_].totalTimeWorked_);
-		extraDays = std::max(0, states[nbDays_].totalTimeWorked_-maxTotalShifts());
-		stat.deltaTotalDays_ = maxTotalShifts()-states[nbDays_].totalTimeWorked_;
+		missingDays = std::max(0, minTotalShifts() - totalTimeWorked);
+		extraDays = std::max(0, totalTimeWorked-maxTotalShifts());
+		stat.deltaTotalDays_ = maxTotalShifts()-totalTimeWorked;
 		stat.costTotalDays_ = WEIGHT_TOTAL_SHIFTS*(extraDays+missingDays);
 
+		int totalWeekendsWorked = bits.totalWeekendsWorked(nbDays_-1);
 		int extraWeekEnds = 0;
-		extraWeekEnds = std::max(0, states[nbDays_].totalWeekendsWorked_-maxTotalWeekends());
-		stat.deltaWeekEnds_ = maxTotalWeekends()-states[nbDays_].totalWeekendsWorked_;
+		extraWeekEnds = std::max(0, totalWeekendsWorked-maxTotalWeekends());
+		stat.deltaWeekEnds_ = maxTotalWeekends()-totalWeekendsWorked;
 		stat.costTotalWeekEnds_ = WEIGHT_TOTAL_WEEKENDS * extraWeekEnds;
 	}
 }
@@ -328,6 +341,15 @@ void LiveNurse::buildStates(){
   }
 }
 
+// State of the nurse after the input number of days of its roster, computed
+// from the image of the roster instead of the states of all the previous days
+//
+State LiveNurse::computeState(int nbDays) const {
+  RosterBits bits;
+  bits.build(roster_, states_[0], pScenario_);
+  return bits.state(roster_, nbDays);
+}
+
 //-----------------------------------------------------------------------------
 // Compute the maximum and minimum number of working days from the input
 // current state and in the next nbDays without getting any penalty for
@@ -531,6 +553,284 @@ void SolverParam::setOptimalityLevel(OptimalityLevel level) {
 
 
 
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   C o s t E v a l u a t o r
+//
+//  Incremental evaluation of the cost of the rosters of the live nurses
+//
+//-----------------------------------------------------------------------------
+
+// evaluate the rosters of all the nurses from scratch
+//
+void CostEvaluator::init(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+	const vector<PLiveNurse>& theNurses, int nbDays) {
+
+	pScenario_ = pScenario;
+	pDemand_ = pDemand;
+	pPreferences_ = pPreferences;
+	demandVersion_ = pDemand->version();
+	preferencesVersion_ = pPreferences->version();
+	theNurses_ = theNurses;
+	nbDays_ = nbDays;
+
+	int nbNurses = theNurses_.size();
+	int nbShifts = pScenario_->nbShifts_, nbSkills = pScenario_->nbSkills_;
+
+	// every nurse is initially considered at rest, so that the staffing is
+	// updated when evaluating its roster
+	shifts_.resize(nbNurses);
+	skills_.resize(nbNurses);
+	dayCosts_.resize(nbNurses);
+	states_.resize(nbNurses);
+	rosterBits_.resize(nbNurses);
+	totalCosts_.assign(nbNurses, 0);
+	for (int n = 0; n < nbNurses; n++) {
+		int nbDaysNurse = theNurses_[n]->nbDays_;
+		shifts_[n].assign(nbDaysNurse, 0);
+		skills_[n].assign(nbDaysNurse, 0);
+		dayCosts_[n].assign(nbDaysNurse, 0);
+		states_[n] = theNurses_[n]->states_;
+		rosterBits_[n].build(theNurses_[n]->roster_, states_[n][0], pScenario_);
+	}
+
+	// cost of the coverage when no nurse works
+	Tools::initVector3D(satisfiedDemand_, nbDays_, nbShifts, nbSkills, 0);
+	sumDayCosts_ = 0;
+	sumTotalCosts_ = 0;
+	coverageCost_ = 0;
+	nbMissingMinStaff_ = 0;
+	for (int day = 0; day < nbDays_; day++) {
+		for (int sh = 1; sh < nbShifts; sh++) {
+			for (int sk = 0; sk < nbSkills; sk++) {
+				coverageCost_ += WEIGHT_OPTIMAL_DEMAND * std::max(0, pDemand_->optDemand_[day][sh][sk]);
+				if (pDemand_->minDemand_[day][sh][sk] > 0) nbMissingMinStaff_++;
+			}
+		}
+	}
+
+	for (int n = 0; n < nbNurses; n++) {
+		evaluateNurse(n, 0, theNurses_[n]->nbDays_-1);
+	}
+}
+
+// compare the rosters and the states of the nurses with the cached ones and
+// evaluate again only the days that have changed
+// the demand and the preferences are identified by their pointers and their
+// versions, which change when they are modified in place
+//
+void CostEvaluator::update(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+	const vector<PLiveNurse>& theNurses, int nbDays) {
+
+	bool isNewData = pScenario != pScenario_ || pDemand != pDemand_ || pPreferences != pPreferences_
+		|| pDemand->version() != demandVersion_ || pPreferences->version() != preferencesVersion_
+		|| nbDays != nbDays_ || theNurses.size() != theNurses_.size();
+	for (unsigned int n = 0; n < theNurses.size() && !isNewData; n++) {
+		isNewData = theNurses[n] != theNurses_[n] || theNurses[n]->states_.size() != states_[n].size()
+			|| theNurses[n]->nbDays_ != (int) shifts_[n].size();
+	}
+	if (isNewData) {
+		init(pScenario, pDemand, pPreferences, theNurses, nbDays);
+		return;
+	}
+
+	for (unsigned int n = 0; n < theNurses_.size(); n++) {
+		PLiveNurse pNurse = theNurses_[n];
+
+		// the cost of a day depends on the assignment of the day and on the
+		// consecutive counters of the states at the beginning and at the end of the
+		// day, but not on the total time and week-ends worked
+		int firstDay = -1, lastDay = -1;
+		for (int day = 0; day < pNurse->nbDays_; day++) {
+			if (pNurse->roster_.shift(day) != shifts_[n][day] || pNurse->roster_.skill(day) != skills_[n][day]
+				|| !isSameConsecutiveState(pNurse->states_[day], states_[n][day])
+				|| !isSameConsecutiveState(pNurse->states_[day+1], states_[n][day+1])) {
+				if (firstDay < 0) firstDay = day;
+				lastDay = day;
+			}
+		}
+
+		// the costs of the global constraints only depend on the totals of the
+		// final state
+		const State& finalState = pNurse->states_[pNurse->nbDays_];
+		const State& cachedFinalState = states_[n][pNurse->nbDays_];
+		bool isNewTotal = finalState.totalTimeWorked_ != cachedFinalState.totalTimeWorked_
+			|| finalState.totalWeekendsWorked_ != cachedFinalState.totalWeekendsWorked_;
+
+		// the image of the roster follows the initial state
+		const State& initialState = pNurse->states_[0];
+		const State& cachedInitialState = states_[n][0];
+		if (!isSameConsecutiveState(initialState, cachedInitialState) || initialState.dayId_ != cachedInitialState.dayId_
+			|| initialState.totalTimeWorked_ != cachedInitialState.totalTimeWorked_
+			|| initialState.totalWeekendsWorked_ != cachedInitialState.totalWeekendsWorked_) {
+			rosterBits_[n].build(pNurse->roster_, initialState, pScenario_);
+		}
+
+		// the totals of the other states do not change any cost, but the cached
+		// states must still be those of the nurse for the next cost variations
+		states_[n] = pNurse->states_;
+
+		if (firstDay >= 0) evaluateNurse(n, firstDay, lastDay);
+		// with an empty range of days, only the global constraints are evaluated
+		else if (isNewTotal) evaluateNurse(n, pNurse->nbDays_, pNurse->nbDays_-1);
+	}
+}
+
+// update the cost after a change in the roster of the nurse n from firstDay
+// to lastDay
+//
+void CostEvaluator::updateRosterSegment(int n, int firstDay, int lastDay) {
+	if (nbDays_ < 0) {
+		Tools::throwError("CostEvaluator::updateRosterSegment: the evaluator is not initialized!");
+	}
+	PLiveNurse pNurse = theNurses_[n];
+	vector<State>& states = pNurse->states_;
+	firstDay = std::max(0, firstDay);
+
+	// rebuild the states until they are identical to the previous ones: the
+	// following states only differ by the total time and week-ends worked
+	unsigned int k = firstDay+1;
+	for (; k < states.size(); k++) {
+		State previousState = states[k];
+		int shift = pNurse->roster_.shift(k-1);
+		states[k].addDayToState(states[k-1], pScenario_->shiftIDToShiftTypeID_[shift], shift,
+			pScenario_->timeDurationToWork_[shift]);
+
+		if ((int) k > lastDay && isSameConsecutiveState(previousState, states[k])) {
+			int deltaTime = states[k].totalTimeWorked_-previousState.totalTimeWorked_;
+			int deltaWeekends = states[k].totalWeekendsWorked_-previousState.totalWeekendsWorked_;
+			for (unsigned int j = k+1; j < states.size(); j++) {
+				states[j].totalTimeWorked_ += deltaTime;
+				states[j].totalWeekendsWorked_ += deltaWeekends;
+				states_[n][j] = states[j];
+			}
+			break;
+		}
+	}
+
+	// the cost of the days after k only depends on states that did not change
+	evaluateNurse(n, firstDay, k-1);
+}
+
+// cost of the solution: LARGE_SCORE if the minimum demand is not satisfied
+//
+double CostEvaluator::cost(bool withTotalCosts) const {
+	if (nbMissingMinStaff_ > 0) return LARGE_SCORE;
+	return sumDayCosts_ + (withTotalCosts ? sumTotalCosts_ : 0) + coverageCost_;
+}
+
+// evaluate again the days from firstDay to lastDay of the nurse n and the
+// costs of its global constraints
+//
+void CostEvaluator::evaluateNurse(int n, int firstDay, int lastDay) {
+	PLiveNurse pNurse = theNurses_[n];
+	firstDay = std::max(0, firstDay);
+	lastDay = std::min(pNurse->nbDays_-1, lastDay);
+
+	rosterBits_[n].update(pNurse->roster_, firstDay, lastDay);
+	pNurse->checkConstraints(pNurse->roster_, rosterBits_[n], pNurse->statCt_, firstDay, lastDay);
+	const StatCtNurse& stat = pNurse->statCt_;
+
+	for (int day = firstDay; day <= lastDay; day++) {
+		int shift = pNurse->roster_.shift(day), skill = pNurse->roster_.skill(day);
+
+		// only the first nbDays_ days are counted in the cost
+		if (day < nbDays_) {
+			int dayCost = stat.costConsDays_[day]+stat.costConsDaysOff_[day]+
+				stat.costConsShifts_[day]+stat.costPref_[day]+stat.costWeekEnd_[day];
+			sumDayCosts_ += dayCost-dayCosts_[n][day];
+			dayCosts_[n][day] = dayCost;
+
+			if (shift != shifts_[n][day] || skill != skills_[n][day]) {
+				if (shifts_[n][day] > 0) addToStaffing(day, shifts_[n][day], skills_[n][day], -1);
+				if (shift > 0) addToStaffing(day, shift, skill, 1);
+			}
+		}
+		shifts_[n][day] = shift;
+		skills_[n][day] = skill;
+	}
+	for (int k = firstDay; k <= lastDay+1; k++) {
+		states_[n][k] = pNurse->states_[k];
+	}
+
+	int totalCost = stat.costTotalDays_+stat.costTotalWeekEnds_;
+	sumTotalCosts_ += totalCost-totalCosts_[n];
+	totalCosts_[n] = totalCost;
+}
+
+// add delta nurses to the staffing of the triple (day,shift,skill) and
+// update the cost of the coverage
+//
+void CostEvaluator::addToStaffing(int day, int shift, int skill, int delta) {
+	int& staffing = satisfiedDemand_[day][shift][skill];
+	int minDemand = pDemand_->minDemand_[day][shift][skill];
+	int optDemand = pDemand_->optDemand_[day][shift][skill];
+
+	if (staffing < minDemand) nbMissingMinStaff_--;
+	coverageCost_ -= WEIGHT_OPTIMAL_DEMAND * std::max(0, optDemand-staffing);
+	staffing += delta;
+	if (staffing < minDemand) nbMissingMinStaff_++;
+	coverageCost_ += WEIGHT_OPTIMAL_DEMAND * std::max(0, optDemand-staffing);
+}
+
+// cost variation of the nurse n if its roster was replaced by the input one
+//
+int CostEvaluator::nurseCostDelta(int n, const Roster& roster, RosterBits& bits, StatCtNurse& stat,
+	int firstDay, int lastDay, bool withTotalCosts) const {
+	PLiveNurse pNurse = theNurses_[n];
+	firstDay = std::max(0, firstDay);
+	lastDay = std::min(pNurse->nbDays_-1, lastDay);
+	bits.update(roster, firstDay, lastDay);
+
+	// the consecutive counters after lastDay only change until the end of the
+	// sequence of worked days or days off that follows lastDay, and the cost of
+	// a day depends on the counters of the day and of the previous day
+	int lastEvaluatedDay = lastDay;
+	if (lastDay+1 < pNurse->nbDays_) {
+		lastEvaluatedDay = std::min(pNurse->nbDays_-1, bits.lastDayOfSequence(lastDay+1)+1);
+	}
+
+	pNurse->checkConstraints(roster, bits, stat, firstDay, lastEvaluatedDay);
+	int delta = 0;
+	for (int day = firstDay; day <= std::min(lastEvaluatedDay, nbDays_-1); day++) {
+		delta += stat.costConsDays_[day]+stat.costConsDaysOff_[day]+
+			stat.costConsShifts_[day]+stat.costPref_[day]+stat.costWeekEnd_[day]-dayCosts_[n][day];
+	}
+	if (withTotalCosts) {
+		delta += stat.costTotalDays_+stat.costTotalWeekEnds_-totalCosts_[n];
+	}
+
+	// restore the image
+	bits.update(pNurse->roster_, firstDay, lastDay);
+
+	return delta;
+}
+
+// cost variation of the coverage if a nurse moves from the task
+// (oldShift,oldSkill) to the task (newShift,newSkill) on the day
+//
+int CostEvaluator::coverageCostDelta(int day, int oldShift, int oldSkill, int newShift, int newSkill) const {
+	if (oldShift == newShift && (oldShift == 0 || oldSkill == newSkill)) return 0;
+
+	int delta = 0;
+	if (oldShift > 0) {
+		int staffing = satisfiedDemand_[day][oldShift][oldSkill];
+		if (staffing <= pDemand_->minDemand_[day][oldShift][oldSkill]) return LARGE_SCORE;
+		if (staffing <= pDemand_->optDemand_[day][oldShift][oldSkill]) delta += WEIGHT_OPTIMAL_DEMAND;
+	}
+	if (newShift > 0) {
+		int staffing = satisfiedDemand_[day][newShift][newSkill];
+		if (staffing < pDemand_->optDemand_[day][newShift][newSkill]) delta -= WEIGHT_OPTIMAL_DEMAND;
+	}
+	return delta;
+}
+
+bool CostEvaluator::isSameConsecutiveState(const State& s1, const State& s2) {
+	return s1.shiftType_ == s2.shiftType_ && s1.shift_ == s2.shift_ && s1.consShifts_ == s2.consShifts_
+		&& s1.consDaysWorked_ == s2.consDaysWorked_ && s1.consDaysOff_ == s2.consDaysOff_;
+}
+
+
 //-----------------------------------------------------------------------------
 //
 //  C l a s s   S o l v e r
@@ -549,10 +849,14 @@ Solver::Solver(PScenario pScenario, PDemand pDemand,
 	isPreprocessedSkills_(false), isPreprocessedNurses_(false) {
 
 	//create the timer that records the life time of the solver and start it
-	pTimerTotal_ = new Tools::Timer();
+	// the time limits are on the wall clock, as some solvers use several threads
+	pTimerTotal_ = new Tools::Timer(Tools::WALL_CLOCK);
 	pTimerTotal_->init();
 	pTimerTotal_->start();
 
+	// seed the random generator of the solver
+	rdm_.seed(Tools::randomGenerator()());
+
 	// initialize the preprocessed data of the skills
 	for (int sk = 0; sk < pScenario_->nbSkills_; sk++) {
 		maxStaffPerSkillNoPenalty_.push_back(-1.0);
@@ -612,10 +916,6 @@ void Solver::loadSolution(vector<Roster> &solution) {
 //-------------------------------------------------------------------------
 
 void Solver::preprocessTheNurses() {
-	// local variables for conciseness of the code
-	//
-	int nbDays = pDemand_->nbDays_;
-
 	this->specifyNursePositions();
 	if (!isPreprocessedSkills_) this->preprocessTheSkills();
 	this->computeMinMaxDaysNoPenaltyTotalDays();
@@ -652,10 +952,6 @@ void Solver::preprocessTheNurses() {
 	}
 
 
-	// initialize to zero the satisfied demand
-	//
-	Tools::initVector3D(satisfiedDemand_, nbDays,pScenario_->nbShifts_, pScenario_->nbSkills_, 0);
-
 	isPreprocessedNurses_ = true;
 }
 
@@ -840,7 +1136,7 @@ void Solver::sortShuffleTheNurses() {
 
 	// shuffle the nurses that have the same position
 	for (int p=0; p < pScenario_->nbPositions(); p++) {
-		std::random_shuffle(nursePerPosition[p].begin(),nursePerPosition[p].end());
+		std::shuffle(nursePerPosition[p].begin(),nursePerPosition[p].end(),rdm_);
 	}
 
 	// fill the sorted vector of live nurses
@@ -901,7 +1197,7 @@ void Solver::setBoundsAndWeights(WeightStrategy strategy){
 		break;
 
 	case RANDOMMEANMAX:
-		if(Tools::randomInt(0, 1) == 0)
+		if(Tools::randomInt(rdm_, 0, 1) == 0)
 			computeWeightsTotalShiftsForPrimalDual(MEAN);
 		else
 			computeWeightsTotalShiftsForPrimalDual(MAX);
@@ -1367,62 +1663,310 @@ double Solver::computeFractionalWeekendPenalty() {
 
 // get the total cost of the current solution
 // the solution is simply given by the roster of each nurse
+// the evaluator only evaluates again the rosters that changed since the last call
 double Solver::computeSolutionCost(int nbDays) {
-	double totalCost = 0.0;
-	int nbNurses = pScenario_->nbNurses_;
-	int nbShifts = pScenario_->nbShifts_, nbSkills = pScenario_->nbSkills_;
+	costEvaluator_.update(pScenario_, pDemand_, pPreferences_, theLiveNurses_, nbDays);
 
-	int nbCons = 0, nbWork = 0, nbRest = 0, nbCov = 0, nbPref = 0, nbWE = 0, totalDays = 0, compWE = 0;
+	// the costs of the global constraints are only paid at the end of the horizon
+	bool isLastWeek = pScenario_->thisWeek()+pScenario_->nbWeeksLoaded() == pScenario_->nbWeeks();
+	return costEvaluator_.cost(isLastWeek);
+}
 
-	// reset the satisfied demand to compute it from scratch
-	Tools::initVector3D(satisfiedDemand_,nbDays, nbShifts, nbSkills, 0);
+//------------------------------------------------
+// Local search on the final rosters
+//------------------------------------------------
 
-	// first add the individual cost of each nurse
-	for (int n = 0; n < nbNurses; n++) {
-		PLiveNurse pNurse = theLiveNurses_[n];
-		pNurse->checkConstraints(pNurse->roster_, pNurse->states_, pNurse->statCt_);
-		StatCtNurse stat = pNurse->statCt_;
+// improve the current solution with a local search on the rosters
+//
+double Solver::localSearch(double maxTime, int nbThreads, int maxSegmentLength) {
+	Tools::Timer timer(Tools::WALL_CLOCK);
+	timer.start();
+
+	// load the solution in the live nurses and evaluate it
+	if ((int) solution_.size() != pScenario_->nbNurses_) return objValue_;
+	loadSolution(solution_);
+	double currentCost = computeSolutionCost();
+	if (currentCost >= LARGE_SCORE) return currentCost;
+
+	bool withTotalCosts = pScenario_->thisWeek()+pScenario_->nbWeeksLoaded() == pScenario_->nbWeeks();
+	int nbNurses = theLiveNurses_.size();
+	nbThreads = std::max(1, nbThreads);
+
+	// the pairs of nurses whose rosters did not change since the last pass are
+	// not explored again
+	vector<bool> isModified(nbNurses, true);
+	std::atomic<bool> isTimeOut(false);
+	while (!isTimeOut) {
+		vector<std::pair<int,int> > pairs;
+		for (int n1 = 0; n1 < nbNurses; n1++) {
+			pairs.push_back(std::pair<int,int>(n1, n1));
+			for (int n2 = n1+1; n2 < nbNurses; n2++) {
+				if (!isModified[n1] && !isModified[n2]) continue;
+				for (int sk: theLiveNurses_[n1]->skills_) {
+					if (theLiveNurses_[n2]->hasSkill(sk)) {
+						pairs.push_back(std::pair<int,int>(n1, n2));
+						break;
+					}
+				}
+			}
+		}
 
-		for (int day = 0; day < nbDays ; day++) {
-			totalCost += stat.costConsDays_[day]+stat.costConsDaysOff_[day]+
-			  stat.costConsShifts_[day]+stat.costPref_[day]+stat.costWeekEnd_[day];
+		// explore the pairs concurrently: each thread has its own timer on the wall
+		// clock, started when the exploration starts
+		vector<LocalSearchMove> bestMoves(pairs.size());
+		std::atomic<unsigned int> nextPair(0);
+		double timeAtStart = timer.dSinceStart();
+		auto explorePairs = [&]() {
+			Tools::Timer threadTimer(Tools::WALL_CLOCK);
+			threadTimer.start();
+			for (unsigned int p = nextPair++; p < pairs.size() && !isTimeOut; p = nextPair++) {
+				bestMoves[p] = bestLocalSearchMove(pairs[p].first, pairs[p].second, maxSegmentLength, withTotalCosts);
+				if (timeAtStart+threadTimer.dSinceStart() > maxTime) isTimeOut = true;
+			}
+		};
+		vector<std::thread> threads;
+		for (int t = 1; t < nbThreads; t++) threads.push_back(std::thread(explorePairs));
+		explorePairs();
+		for (std::thread& thread: threads) thread.join();
+
+		// apply the improving moves, starting with the best ones, as long as they
+		// do not involve a nurse that was modified by a previous move
+		// the coverage can be changed by the previous moves, so the cost is
+		// checked again with the evaluator
+		vector<LocalSearchMove> improvingMoves;
+		for (const LocalSearchMove& move: bestMoves) {
+			if (move.delta < 0) improvingMoves.push_back(move);
+		}
+		std::stable_sort(improvingMoves.begin(), improvingMoves.end(),
+			[](const LocalSearchMove& m1, const LocalSearchMove& m2) {return m1.delta < m2.delta;});
+
+		isModified.assign(nbNurses, false);
+		bool isImproved = false;
+		for (const LocalSearchMove& move: improvingMoves) {
+			if (isModified[move.nurse1] || isModified[move.nurse2]) continue;
+
+			LocalSearchMove reverseMove = applyLocalSearchMove(move);
+			double newCost = costEvaluator_.cost(withTotalCosts);
+			if (newCost < currentCost-EPSILON) {
+				currentCost = newCost;
+				isModified[move.nurse1] = true;
+				isModified[move.nurse2] = true;
+				isImproved = true;
+			}
+			else {
+				applyLocalSearchMove(reverseMove);
+			}
+		}
 
-			nbWork += stat.costConsDays_[day];
-			nbCons += stat.costConsShifts_[day];
-			nbRest += stat.costConsDaysOff_[day];
-			nbPref += stat.costPref_[day];
-			nbWE += stat.costWeekEnd_[day];
+		if (!isImproved || timer.dSinceStart() > maxTime) break;
+	}
 
-			if (pNurse->roster_.shift(day) > 0) {
-				satisfiedDemand_[day][pNurse->roster_.shift(day)][pNurse->roster_.skill(day)]++;
+	// store the improved solution
+	solution_.clear();
+	for (PLiveNurse pNurse: theLiveNurses_) {
+		solution_.push_back(pNurse->roster_);
+	}
+	objValue_ = currentCost;
+
+	return objValue_;
+}
+
+// find the best move of the local search for the pair of nurses (n1,n2), or
+// for the nurse n1 alone if n2 == n1
+//
+LocalSearchMove Solver::bestLocalSearchMove(int n1, int n2, int maxSegmentLength, bool withTotalCosts) {
+	LocalSearchMove bestMove;
+	bestMove.nurse1 = n1;
+	bestMove.nurse2 = n2;
+
+	int nbDays = pDemand_->nbDays_;
+
+	// the rosters, their images and the statuses are modified in local buffers
+	PLiveNurse pNurse1 = theLiveNurses_[n1];
+	Roster roster1 = pNurse1->roster_;
+	RosterBits bits1 = costEvaluator_.rosterBits(n1);
+	StatCtNurse stat1 = pNurse1->statCt_;
+
+	if (n1 == n2) {
+		// the skill of a rest is not relevant
+		const vector<int> restSkill(1, 0);
+
+		for (int day = 0; day < nbDays; day++) {
+			int oldShift = roster1.shift(day), oldSkill = roster1.skill(day);
+
+			// change the task of the nurse on the day
+			for (int sh = 0; sh < pScenario_->nbShifts_; sh++) {
+				for (int sk: (sh ? pNurse1->skills_ : restSkill)) {
+					if (sh == oldShift && (sh == 0 || sk == oldSkill)) continue;
+					int delta = costEvaluator_.coverageCostDelta(day, oldShift, oldSkill, sh, sk);
+					if (delta >= LARGE_SCORE) continue;
+
+					roster1.assignTask(day, sh, sk);
+					if (isFeasibleSegment(pNurse1, roster1, day, day)) {
+						delta += costEvaluator_.nurseCostDelta(n1, roster1, bits1, stat1, day, day, withTotalCosts);
+						if (delta < bestMove.delta) {
+							bestMove.type = LS_CHANGE_TASK;
+							bestMove.firstDay = bestMove.lastDay = day;
+							bestMove.shift = sh;
+							bestMove.skill = sk;
+							bestMove.delta = delta;
+						}
+					}
+					roster1.assignTask(day, oldShift, oldSkill);
+				}
 			}
-		}
 
-		if ( pScenario_->thisWeek()+pScenario_->nbWeeksLoaded() == pScenario_->nbWeeks() ) {
-			totalCost += stat.costTotalDays_+stat.costTotalWeekEnds_;
-			totalDays += stat.costTotalDays_;
-			compWE += stat.costTotalWeekEnds_;
-			// std::cout << pNurse->name_ << "    " <<stat.costTotalDays_ << std::endl;
+			// exchange the tasks of the day with those of a following day
+			for (int day2 = day+1; day2 < std::min(nbDays, day+maxSegmentLength+1); day2++) {
+				int shift2 = roster1.shift(day2), skill2 = roster1.skill(day2);
+				if (shift2 == oldShift) continue;
+				int delta = costEvaluator_.coverageCostDelta(day, oldShift, oldSkill, shift2, skill2);
+				if (delta >= LARGE_SCORE) continue;
+				int delta2 = costEvaluator_.coverageCostDelta(day2, shift2, skill2, oldShift, oldSkill);
+				if (delta2 >= LARGE_SCORE) continue;
+
+				roster1.assignTask(day, shift2, skill2);
+				roster1.assignTask(day2, oldShift, oldSkill);
+				if (isFeasibleSegment(pNurse1, roster1, day, day2)) {
+					delta += delta2+costEvaluator_.nurseCostDelta(n1, roster1, bits1, stat1, day, day2, withTotalCosts);
+					if (delta < bestMove.delta) {
+						bestMove.type = LS_SWAP_DAYS;
+						bestMove.firstDay = day;
+						bestMove.lastDay = day2;
+						bestMove.delta = delta;
+					}
+				}
+				roster1.assignTask(day, oldShift, oldSkill);
+				roster1.assignTask(day2, shift2, skill2);
+			}
+
+			// reverse the order of the tasks from the day to a following day (2-opt
+			// on the days): the segments of two days are the swaps above
+			for (int day2 = day+2; day2 < std::min(nbDays, day+maxSegmentLength); day2++) {
+				int delta = 0;
+				bool isCovered = true;
+				for (int d = day; d <= day2 && isCovered; d++) {
+					int reverseDay = day+day2-d;
+					int deltaDay = costEvaluator_.coverageCostDelta(d, roster1.shift(d), roster1.skill(d),
+						roster1.shift(reverseDay), roster1.skill(reverseDay));
+					if (deltaDay >= LARGE_SCORE) isCovered = false;
+					delta += deltaDay;
+				}
+				if (!isCovered) continue;
+
+				reverseTasks(roster1, day, day2);
+				if (isFeasibleSegment(pNurse1, roster1, day, day2)) {
+					delta += costEvaluator_.nurseCostDelta(n1, roster1, bits1, stat1, day, day2, withTotalCosts);
+					if (delta < bestMove.delta) {
+						bestMove.type = LS_REVERSE_DAYS;
+						bestMove.firstDay = day;
+						bestMove.lastDay = day2;
+						bestMove.delta = delta;
+					}
+				}
+				reverseTasks(roster1, day, day2);
+			}
 		}
+		return bestMove;
 	}
 
-	// add the cost of non-optimal demand
-	for(int day = 0; day < nbDays; day++) {
-		for (int sh = 1; sh < nbShifts ; sh++) {
-			for (int sk = 0; sk < nbSkills; sk++) {
-			  // infeasible
-			  if(satisfiedDemand_[day][sh][sk] < pDemand_->minDemand_[day][sh][sk])
-			    return LARGE_SCORE;
-				int missingStaff;
-				missingStaff = std::max(0, pDemand_->optDemand_[day][sh][sk] - satisfiedDemand_[day][sh][sk]);
-				totalCost += WEIGHT_OPTIMAL_DEMAND * missingStaff;
-				nbCov += WEIGHT_OPTIMAL_DEMAND * missingStaff;
+	// exchange the tasks of the two nurses on a sequence of days: the coverage
+	// does not change
+	PLiveNurse pNurse2 = theLiveNurses_[n2];
+	Roster roster2 = pNurse2->roster_;
+	RosterBits bits2 = costEvaluator_.rosterBits(n2);
+	StatCtNurse stat2 = pNurse2->statCt_;
+
+	for (int firstDay = 0; firstDay < nbDays; firstDay++) {
+		int nbDifferentDays = 0;
+		int lastDay = firstDay;
+		for (; lastDay < std::min(nbDays, firstDay+maxSegmentLength); lastDay++) {
+			int shift1 = roster1.shift(lastDay), skill1 = roster1.skill(lastDay);
+			int shift2 = roster2.shift(lastDay), skill2 = roster2.skill(lastDay);
+			if ((shift2 && !pNurse1->hasSkill(skill2)) || (shift1 && !pNurse2->hasSkill(skill1))) break;
+
+			roster1.assignTask(lastDay, shift2, skill2);
+			roster2.assignTask(lastDay, shift1, skill1);
+			if (shift1 != shift2) nbDifferentDays++;
+			if (!nbDifferentDays || !isFeasibleSegment(pNurse1, roster1, firstDay, lastDay)
+				|| !isFeasibleSegment(pNurse2, roster2, firstDay, lastDay)) continue;
+
+			int delta = costEvaluator_.nurseCostDelta(n1, roster1, bits1, stat1, firstDay, lastDay, withTotalCosts)
+				+ costEvaluator_.nurseCostDelta(n2, roster2, bits2, stat2, firstDay, lastDay, withTotalCosts);
+			if (delta < bestMove.delta) {
+				bestMove.type = LS_SWAP_NURSES;
+				bestMove.firstDay = firstDay;
+				bestMove.lastDay = lastDay;
+				bestMove.delta = delta;
 			}
 		}
+
+		// restore the rosters of the nurses
+		for (int day = firstDay; day < lastDay; day++) {
+			roster1.assignTask(day, pNurse1->roster_.shift(day), pNurse1->roster_.skill(day));
+			roster2.assignTask(day, pNurse2->roster_.shift(day), pNurse2->roster_.skill(day));
+		}
 	}
 
-	// std::cout << nbCons << "   " << nbWork << "   " <<nbRest << "   " << nbCov << "    " << nbPref <<"    " << nbWE << "   " << totalDays << "    " << compWE << std::endl;
-	return totalCost;
+	return bestMove;
+}
+
+// return true if the roster satisfies the skill and the forbidden successions
+// constraints of the nurse from firstDay to lastDay
+//
+bool Solver::isFeasibleSegment(PLiveNurse pNurse, const Roster& roster, int firstDay, int lastDay) {
+	for (int day = firstDay; day <= std::min(lastDay+1, pNurse->nbDays_-1); day++) {
+		int shift = roster.shift(day);
+		if (day <= lastDay && shift && !pNurse->hasSkill(roster.skill(day))) return false;
+
+		int prevShiftType = day ? pScenario_->shiftIDToShiftTypeID_[roster.shift(day-1)] : pNurse->states_[0].shiftType_;
+		if (pScenario_->isForbiddenSuccessorShift_ShiftType(shift, prevShiftType)) return false;
+	}
+	return true;
+}
+
+// reverse the order of the tasks of the roster from firstDay to lastDay
+//
+void Solver::reverseTasks(Roster& roster, int firstDay, int lastDay) {
+	for (int d1 = firstDay, d2 = lastDay; d1 < d2; d1++, d2--) {
+		int shift = roster.shift(d1), skill = roster.skill(d1);
+		roster.assignTask(d1, roster.shift(d2), roster.skill(d2));
+		roster.assignTask(d2, shift, skill);
+	}
+}
+
+// apply the move to the rosters of the live nurses, update the cost evaluator,
+// and return the move that reverts it
+//
+LocalSearchMove Solver::applyLocalSearchMove(const LocalSearchMove& move) {
+	LocalSearchMove reverseMove = move;
+	Roster& roster1 = theLiveNurses_[move.nurse1]->roster_;
+
+	if (move.type == LS_SWAP_NURSES) {
+		Roster& roster2 = theLiveNurses_[move.nurse2]->roster_;
+		for (int day = move.firstDay; day <= move.lastDay; day++) {
+			int shift1 = roster1.shift(day), skill1 = roster1.skill(day);
+			roster1.assignTask(day, roster2.shift(day), roster2.skill(day));
+			roster2.assignTask(day, shift1, skill1);
+		}
+		costEvaluator_.updateRosterSegment(move.nurse2, move.firstDay, move.lastDay);
+	}
+	else if (move.type == LS_SWAP_DAYS) {
+		int shift = roster1.shift(move.firstDay), skill = roster1.skill(move.firstDay);
+		roster1.assignTask(move.firstDay, roster1.shift(move.lastDay), roster1.skill(move.lastDay));
+		roster1.assignTask(move.lastDay, shift, skill);
+	}
+	else if (move.type == LS_REVERSE_DAYS) {
+		reverseTasks(roster1, move.firstDay, move.lastDay);
+	}
+	else {
+		reverseMove.shift = roster1.shift(move.firstDay);
+		reverseMove.skill = roster1.skill(move.firstDay);
+		roster1.assignTask(move.firstDay, move.shift, move.skill);
+	}
+	costEvaluator_.updateRosterSegment(move.nurse1, move.firstDay, move.lastDay);
+
+	return reverseMove;
 }
 
 // get aggregate information on the solution and write them in a string
@@ -1524,11 +2068,12 @@ vector<State> Solver::getFinalStates() {
 }
 
 // return the states of the nurses at day k
+// only these states are computed, from the images of the rosters
 //
 vector<State> Solver::getStatesOfDay(int k) {
 	vector<State> pStatesOfDayK;
 	for (PLiveNurse pNurse: theLiveNurses_) {
-		pStatesOfDayK.push_back(pNurse->state(k+1));
+		pStatesOfDayK.push_back(pNurse->computeState(k+1));
 	}
 	return pStatesOfDayK;
 }
@@ -1603,8 +2148,7 @@ string Solver::solutionToString(int firstDay, int nbDays, int firstWeek){
 //
 string Solver::solutionToLogString() {
 	std::stringstream rep;
-	int nbNurses = pScenario_->nbNurses_, nbShifts = pScenario_->nbShifts_;
-	int nbSkills = pScenario_->nbSkills_;
+	int nbNurses = pScenario_->nbNurses_;
 	int firstDay = pDemand_->firstDay_, nbDays = pDemand_->nbDays_;
 
 	rep << "Complete shift schedule" << std::endl << std::endl;
@@ -1633,31 +2177,62 @@ string Solver::solutionToLogString() {
 	}
 	rep << std::endl;
 
+	CostBreakdown costs = computeCostBreakdown();
+
+	// write the status of hard and soft constraints
+	//
+	rep << "Hard constraints violations\n";
+	rep << "---------------------------\n";
+	rep << "Minimal coverage constraints: " << costs.violMinCover << std::endl;
+	rep << "Required skill constraints: " << costs.violReqSkill << std::endl;
+	rep << "Illegal shift type succession constraints: " << costs.violForbiddenSucc << std::endl;
+	rep << "Single assignment per day: 0" << std::endl;
+
+	rep << "\nCost per constraint type\n";
+	rep << "------------------------\n";
+	rep << "Total assignment constraints: " << costs.costTotalDays << std::endl;
+	//rep << "Consecutive constraints: " << costs.costConsDays+costs.costConsShifts << std::endl;
+	rep << "Consecutive working days constraints: " << costs.costConsDays << std::endl;
+	rep << "Consecutive days off constraints: " << costs.costConsDaysOff << std::endl;
+	rep << "Consecutive shifts constraints: " << costs.costConsShifts << std::endl;
+	rep << "Preferences: " << costs.costPref << std::endl;
+	rep << "Max working weekend: " << costs.costTotalWeekEnds << std::endl;
+	rep << "Complete weekends: " << costs.costWeekEnds << std::endl;
+	rep << "Optimal coverage constraints: " << costs.costOptCover << std::endl;
+
+	rep << "\n---------------------------\n";
+	rep << "\nTotal cost: " << costs.totalCost << std::endl;
+
+	return rep.str();
+}
+
+// compute the cost of the current solution and detail it per constraint
+//
+CostBreakdown Solver::computeCostBreakdown() {
+	int nbNurses = pScenario_->nbNurses_, nbShifts = pScenario_->nbShifts_;
+	int nbSkills = pScenario_->nbSkills_;
+	int firstDay = pDemand_->firstDay_, nbDays = pDemand_->nbDays_;
+	CostBreakdown costs;
+
 	// compute the total cost and in the mean time update the structures of each
 	// live nurse that contains all the required information on soft and hard
 	// constraints satisfaction
 	//
-	double totalCost = computeSolutionCost();
-
-	// store temporarily the data that is about to be written
-	//
-	int violMinCover = 0, violReqSkill = 0, violForbiddenSucc = 0;
-	double costOptCover = 0, costTotalDays = 0, costTotalWeekEnds = 0;
-	double costConsDays = 0, costConsDaysOff=0, costConsShifts = 0, costPref = 0, costWeekEnds = 0;
+	costs.totalCost = computeSolutionCost();
 
 	// constraints related to the demand
 	for (int day = firstDay; day < firstDay+nbDays; day++) {
 		for (int sh = 1; sh < nbShifts; sh++) {
 			for (int sk = 0; sk < nbSkills; sk++) {
-				violMinCover += std::max(0,pDemand_->minDemand_[day][sh][sk]-satisfiedDemand_[day][sh][sk]);
-				costOptCover += WEIGHT_OPTIMAL_DEMAND
-					* std::max(0,pDemand_->optDemand_[day][sh][sk]-satisfiedDemand_[day][sh][sk]);
-//        if(pDemand_->minDemand_[day][sh][sk]-satisfiedDemand_[day][sh][sk]>0)
-//           std::cout << day << " " << sh  << " " << sk << " " << pDemand_->minDemand_[day][sh][sk] << " " << satisfiedDemand_[day][sh][sk] << std::endl;
-//        else if(pDemand_->optDemand_[day][sh][sk]-satisfiedDemand_[day][sh][sk]>0)
-//                   std::cout << day << " " << sh  << " " << sk << " " << satisfiedDemand_[day][sh][sk] << " " << pDemand_->optDemand_[day][sh][sk] << std::endl;
-//        else if(pDemand_->optDemand_[day][sh][sk]-satisfiedDemand_[day][sh][sk]<0)
-//                           std::cout << "*" << day << " " << sh  << " " << sk << " " << satisfiedDemand_[day][sh][sk] << " " << pDemand_->optDemand_[day][sh][sk] << std::endl;
+				costs.violMinCover += std::max(0,pDemand_->minDemand_[day][sh][sk]-costEvaluator_.satisfiedDemand(day,sh,sk));
+				costs.costOptCover += WEIGHT_OPTIMAL_DEMAND
+					* std::max(0,pDemand_->optDemand_[day][sh][sk]-costEvaluator_.satisfiedDemand(day,sh,sk));
+//        if(pDemand_->minDemand_[day][sh][sk]-costEvaluator_.satisfiedDemand(day,sh,sk)>0)
+//           std::cout << day << " " << sh  << " " << sk << " " << pDemand_->minDemand_[day][sh][sk] << " " << costEvaluator_.satisfiedDemand(day,sh,sk) << std::endl;
+//        else if(pDemand_->optDemand_[day][sh][sk]-costEvaluator_.satisfiedDemand(day,sh,sk)>0)
+//                   std::cout << day << " " << sh  << " " << sk << " " << costEvaluator_.satisfiedDemand(day,sh,sk) << " " << pDemand_->optDemand_[day][sh][sk] << std::endl;
+//        else if(pDemand_->optDemand_[day][sh][sk]-costEvaluator_.satisfiedDemand(day,sh,sk)<0)
+//                           std::cout << "*" << day << " " << sh  << " " << sk << " " << costEvaluator_.satisfiedDemand(day,sh,sk) << " " << pDemand_->optDemand_[day][sh][sk] << std::endl;
 			}
 		}
 	}
@@ -1667,8 +2242,8 @@ string Solver::solutionToLogString() {
 		PLiveNurse pNurse = theLiveNurses_[n];
 
 		if ( pScenario_->thisWeek()+pScenario_->nbWeeksLoaded() == pScenario_->nbWeeks() ) {
-			costTotalDays += pNurse->statCt_.costTotalDays_;
-			costTotalWeekEnds += pNurse->statCt_.costTotalWeekEnds_;
+			costs.costTotalDays += pNurse->statCt_.costTotalDays_;
+			costs.costTotalWeekEnds += pNurse->statCt_.costTotalWeekEnds_;
 		}
 
 		for (int day = firstDay; day < firstDay+nbDays; day++){
@@ -1676,44 +2251,20 @@ string Solver::solutionToLogString() {
 			int skill = pNurse->roster_.skill(day);
 			int shift = pNurse->roster_.shift(day);
 			int prevShift = pNurse->states_[day].shift_;
-			violReqSkill += shift == 0 ? 0 : (pNurse->hasSkill(skill)? 0:1);
-			violForbiddenSucc += pScenario_->isForbiddenSuccessorShift_Shift(shift, prevShift)? 1: 0;
+			costs.violReqSkill += shift == 0 ? 0 : (pNurse->hasSkill(skill)? 0:1);
+			costs.violForbiddenSucc += pScenario_->isForbiddenSuccessorShift_Shift(shift, prevShift)? 1: 0;
 
 			// the other costs per soft constraint can be read from the stat structure
-			costConsDays += pNurse->statCt_.costConsDays_[day];
-			costConsDaysOff += pNurse->statCt_.costConsDaysOff_[day];
-			costConsShifts += pNurse->statCt_.costConsShifts_[day];
-			costPref += pNurse->statCt_.costPref_[day];
-			costWeekEnds += pNurse->statCt_.costWeekEnd_[day];
+			costs.costConsDays += pNurse->statCt_.costConsDays_[day];
+			costs.costConsDaysOff += pNurse->statCt_.costConsDaysOff_[day];
+			costs.costConsShifts += pNurse->statCt_.costConsShifts_[day];
+			costs.costPref += pNurse->statCt_.costPref_[day];
+			costs.costWeekEnds += pNurse->statCt_.costWeekEnd_[day];
 
 		}
 	}
 
-	// write the status of hard and soft constraints
-	//
-	rep << "Hard constraints violations\n";
-	rep << "---------------------------\n";
-	rep << "Minimal coverage constraints: " << violMinCover << std::endl;
-	rep << "Required skill constraints: " << violReqSkill << std::endl;
-	rep << "Illegal shift type succession constraints: " << violForbiddenSucc << std::endl;
-	rep << "Single assignment per day: 0" << std::endl;
-
-	rep << "\nCost per constraint type\n";
-	rep << "------------------------\n";
-	rep << "Total assignment constraints: " << costTotalDays << std::endl;
-	//rep << "Consecutive constraints: " << costConsDays+costConsShifts << std::endl;
-	rep << "Consecutive working days constraints: " << costConsDays << std::endl;
-	rep << "Consecutive days off constraints: " << costConsDaysOff << std::endl;
-	rep << "Consecutive shifts constraints: " << costConsShifts << std::endl;
-	rep << "Preferences: " << costPref << std::endl;
-	rep << "Max working weekend: " << costTotalWeekEnds << std::endl;
-	rep << "Complete weekends: " << costWeekEnds << std::endl;
-	rep << "Optimal coverage constraints: " << costOptCover << std::endl;
-
-	rep << "\n---------------------------\n";
-	rep << "\nTotal cost: " << totalCost << std::endl;
-
-	return rep.str();
+	return costs;
 }
 
 // When a solution of multiple consecutive weeks is available, display the complete
@@ -271,14 +271,25 @@ public:
 	bool isFreeToChoose(int day);
 
 	// check the satisfaction of the hard constraints and record the violations
-	// for the input roster and resulting states
+	// for the input roster, whose image is given by bits
 	//
-	void checkConstraints(const Roster& roster, const std::vector<State>& states, StatCtNurse& stat);
+	void checkConstraints(const Roster& roster, const RosterBits& bits, StatCtNurse& stat);
+
+	// same as above, but only the days from firstDay to lastDay are checked
+	// the global constraints are always checked
+	//
+	void checkConstraints(const Roster& roster, const RosterBits& bits, StatCtNurse& stat,
+		int firstDay, int lastDay);
 
 	// Build States from the roster
 	//
 	void buildStates();
 
+	// state of the nurse after the input number of days of its roster, computed
+	// without building the states of the previous days
+	//
+	State computeState(int nbDays) const;
+
   // Print the contract type + preferences
   void printContractAndPreferences(PScenario pScenario) const;
 
@@ -303,6 +314,175 @@ bool comparePositions(PPosition p1, PPosition p2);
 bool compareNurses(PLiveNurse n1, PLiveNurse n2);
 
 
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   C o s t E v a l u a t o r
+//
+//  Incremental evaluation of the cost of the rosters of the live nurses
+//  The cost of each day of each nurse, the costs of the global constraints of
+//  each nurse and the staffing of each triple (day,shift,skill) are cached, so
+//  that only the days whose assignment or state has changed are evaluated
+//  again when a few rosters of the solution are modified
+//
+//-----------------------------------------------------------------------------
+
+class CostEvaluator {
+
+public:
+	CostEvaluator() {}
+	~CostEvaluator() {}
+
+	// evaluate the rosters of all the nurses from scratch
+	//
+	void init(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+		const std::vector<PLiveNurse>& theNurses, int nbDays);
+
+	// compare the rosters and the states of the nurses with the cached ones and
+	// evaluate again only the days that have changed
+	// everything is evaluated from scratch if the input data has changed since
+	// the last evaluation, even in place (see Demand::version)
+	//
+	void update(PScenario pScenario, PDemand pDemand, PPreferences pPreferences,
+		const std::vector<PLiveNurse>& theNurses, int nbDays);
+
+	// update the cost after a change in the roster of the nurse n from firstDay
+	// to lastDay: the states of the nurse are rebuilt from firstDay until they
+	// are identical to the previous ones, and only these days are evaluated again
+	//
+	void updateRosterSegment(int n, int firstDay, int lastDay);
+
+	// force a complete evaluation at the next update (e.g., when the rosters
+	// and their constraint statuses have been reinitialized)
+	//
+	void reset() {nbDays_ = -1;}
+
+	// cost of the solution: LARGE_SCORE if the minimum demand is not satisfied
+	// the costs of the global constraints are counted only if
+	// withTotalCosts is true
+	//
+	double cost(bool withTotalCosts) const;
+
+	int satisfiedDemand(int day, int shift, int skill) const {
+		return satisfiedDemand_[day][shift][skill];
+	}
+
+	// cost variation of the nurse n if its roster was replaced by the input one,
+	// which only differs from the current one between firstDay and lastDay
+	// the image of the roster and the statuses are buffers: the image must be a
+	// copy of rosterBits(n) and it is restored before returning, so that several
+	// threads can evaluate moves concurrently with their own buffers
+	//
+	int nurseCostDelta(int n, const Roster& roster, RosterBits& bits, StatCtNurse& stat,
+		int firstDay, int lastDay, bool withTotalCosts) const;
+
+	// image of the roster of the nurse n at the last evaluation
+	//
+	const RosterBits& rosterBits(int n) const {return rosterBits_[n];}
+
+	// cost variation of the coverage if a nurse moves from the task
+	// (oldShift,oldSkill) to the task (newShift,newSkill) on the day
+	// return LARGE_SCORE if the minimum demand is not satisfied anymore
+	//
+	int coverageCostDelta(int day, int oldShift, int oldSkill, int newShift, int newSkill) const;
+
+protected:
+	// evaluate again the days from firstDay to lastDay of the nurse n and the
+	// costs of its global constraints
+	//
+	void evaluateNurse(int n, int firstDay, int lastDay);
+
+	// add delta nurses to the staffing of the triple (day,shift,skill) and
+	// update the cost of the coverage
+	//
+	void addToStaffing(int day, int shift, int skill, int delta);
+
+	// true if the two states only differ by the total time and week-ends worked:
+	// the costs of the following days are then identical
+	//
+	static bool isSameConsecutiveState(const State& s1, const State& s2);
+
+	PScenario pScenario_ = nullptr;
+	PDemand pDemand_ = nullptr;
+	PPreferences pPreferences_ = nullptr;
+	std::vector<PLiveNurse> theNurses_;
+
+	// versions of the demand and of the preferences at the last evaluation
+	//
+	int demandVersion_ = -1, preferencesVersion_ = -1;
+
+	// number of days that are counted in the cost of the solution
+	//
+	int nbDays_ = -1;
+
+	// assignments, states, images of the rosters and costs of each nurse at the
+	// last evaluation
+	//
+	vector2D<int> shifts_, skills_;
+	std::vector<std::vector<State> > states_;
+	std::vector<RosterBits> rosterBits_;
+	vector2D<int> dayCosts_;
+	std::vector<int> totalCosts_;
+
+	// staffing in the solution : a 3D vector that contains the number of nurses
+	//  for each triple (day,shift,skill)
+	//
+	vector3D<int> satisfiedDemand_;
+
+	// aggregated costs
+	//
+	int sumDayCosts_ = 0, sumTotalCosts_ = 0, coverageCost_ = 0;
+
+	// number of triples (day,shift,skill) whose minimum demand is not satisfied
+	//
+	int nbMissingMinStaff_ = 0;
+};
+
+
+//-----------------------------------------------------------------------------
+//
+//  S t r u c t   L o c a l S e a r c h M o v e
+//
+//  Move of the local search that improves the final rosters
+//  LS_SWAP_NURSES: the two nurses exchange their tasks from firstDay to lastDay
+//  LS_SWAP_DAYS: the nurse exchanges its tasks of firstDay and lastDay
+//  LS_REVERSE_DAYS: the nurse performs its tasks from firstDay to lastDay in
+//  the reverse order (2-opt on the days)
+//  LS_CHANGE_TASK: the nurse performs the task (shift,skill) on firstDay
+//
+//-----------------------------------------------------------------------------
+
+enum LocalSearchMoveType {LS_SWAP_NURSES, LS_SWAP_DAYS, LS_REVERSE_DAYS, LS_CHANGE_TASK};
+
+struct LocalSearchMove {
+	LocalSearchMoveType type = LS_CHANGE_TASK;
+	int nurse1 = -1, nurse2 = -1;
+	int firstDay = 0, lastDay = 0;
+	int shift = 0, skill = 0;
+
+	// variation of the cost of the solution
+	int delta = 0;
+};
+
+//-----------------------------------------------------------------------------
+//
+//  S t r u c t   C o s t B r e a k d o w n
+//
+//  Violations of the hard constraints and cost of each soft constraint of a
+//  solution, as reported by the validator
+//
+//-----------------------------------------------------------------------------
+
+struct CostBreakdown {
+	// hard constraints
+	int violMinCover = 0, violReqSkill = 0, violForbiddenSucc = 0;
+
+	// soft constraints
+	double costOptCover = 0, costTotalDays = 0, costTotalWeekEnds = 0;
+	double costConsDays = 0, costConsDaysOff = 0, costConsShifts = 0, costPref = 0, costWeekEnds = 0;
+
+	double totalCost = 0;
+};
+
 //-----------------------------------------------------------------------------
 //
 //  C l a s s   Print Solution
@@ -446,9 +626,9 @@ public:
 
 // Algorithms for the overall solution
 //
-enum Algorithm{GENCOL, STOCHASTIC_GENCOL, NONE};
+enum Algorithm{GENCOL, STOCHASTIC_GENCOL, GREEDY, NONE};
 static std::map<std::string,Algorithm> AlgorithmsByName =
-	{{"GENCOL",GENCOL},{"STOCHASTIC_GENCOL",STOCHASTIC_GENCOL},{"NONE",NONE}};
+	{{"GENCOL",GENCOL},{"STOCHASTIC_GENCOL",STOCHASTIC_GENCOL},{"GREEDY",GREEDY},{"NONE",NONE}};
 
 enum MySolverType { S_SCIP, S_CLP, S_Gurobi, S_Cplex, S_CBC };
 static std::map<std::string,MySolverType> MySolverTypesByName =
@@ -515,6 +695,12 @@ protected:
 	// Timer started at the creation of the solver and stopped at destruction
 	Tools::Timer* pTimerTotal_;
 
+	// Random generator of the solver: every random draw of the solver and of
+	// its components (pricer, branching, LNS operators) uses it, so that the
+	// solvers can run concurrently and remain reproducible
+	// It is seeded at construction with the random generator of the thread
+	std::minstd_rand rdm_;
+
 	//-----------------------------------------------------------------------------
 	// Manipulated data
 	//-----------------------------------------------------------------------------
@@ -574,10 +760,10 @@ protected:
 	//
 	double objValue_;
 
-	// staffing in the solution : a 3D vector that contains the number of nurses
-	//  for each triple (day,shift,skill)
+	// incremental evaluator of the cost of the solution: it also contains the
+	// staffing of each triple (day,shift,skill) in the solution
 	//
-	vector3D<int> satisfiedDemand_;
+	CostEvaluator costEvaluator_;
 
 	// total cost under-staffing cost and under staffing cost for each triple
 	// (day,shift,skill)
@@ -592,6 +778,27 @@ protected:
 	std::vector<int> shiftsSorted_;
 	std::vector<int> skillsSorted_;
 
+	// find the best move of the local search for the pair of nurses (n1,n2), or
+	// for the nurse n1 alone if n2 == n1
+	// the solver is not modified, so that several pairs can be explored
+	// concurrently
+	//
+	LocalSearchMove bestLocalSearchMove(int n1, int n2, int maxSegmentLength, bool withTotalCosts);
+
+	// return true if the roster satisfies the skill and the forbidden successions
+	// constraints of the nurse from firstDay to lastDay
+	//
+	bool isFeasibleSegment(PLiveNurse pNurse, const Roster& roster, int firstDay, int lastDay);
+
+	// reverse the order of the tasks of the roster from firstDay to lastDay
+	//
+	static void reverseTasks(Roster& roster, int firstDay, int lastDay);
+
+	// apply the move to the rosters of the live nurses, update the cost
+	// evaluator, and return the move that reverts it
+	//
+	LocalSearchMove applyLocalSearchMove(const LocalSearchMove& move);
+
 public:
 	//------------------------------------------------
 	// Solution with rolling horizon process
@@ -627,6 +834,15 @@ public:
 	// Solve the problem with a method that allows for a warm start
 	virtual double rollingSolve(const SolverParam& parameters, int firstDay) {return 0.0;}
 
+	// Add a solution whose columns will be given as a warm start to the next
+	// solution of the rolling horizon
+	virtual void addWarmStartSolution(const std::vector<Roster>& solution) {}
+
+	// Get the compact patterns of the columns of the model, and add columns
+	// given by their compact patterns as initial columns of the next solution
+	virtual std::vector<std::vector<double>> getColumnPatterns() const {return {};}
+	virtual void addInitialColumnPatterns(const std::vector<std::vector<double>>& patterns) {}
+
 	// Special solve function for LNS
 	// It is a priori the same as a regular, but it might be modified if needed
 	virtual double LNSSolve(const SolverParam& parameters) {return 0.0;}
@@ -756,10 +972,24 @@ public:
 
 	// get the total cost of the current solution
 	// the solution is simply given by the roster of each nurse
+	// only the rosters that changed since the last call are evaluated again
 	double computeSolutionCost(int nbDays);
 
 	double computeSolutionCost(){return computeSolutionCost(pDemand_->nbDays_);}
 
+	// compute the cost of the current solution and detail it per constraint
+	CostBreakdown computeCostBreakdown();
+
+	// improve the current solution with a local search on the rosters: swaps of
+	// the tasks of two nurses over a few consecutive days, swaps of two days of
+	// a nurse, reversals of the order of the tasks of a nurse over a few
+	// consecutive days, and changes of the task of a nurse on a day
+	// the moves are evaluated incrementally with the cost evaluator, the pairs of
+	// nurses are explored concurrently by nbThreads threads, and the search stops
+	// when no move improves the solution or after maxTime seconds (wall clock)
+	// return the cost of the improved solution
+	double localSearch(double maxTime, int nbThreads=1, int maxSegmentLength=7);
+
    // get aggregate information on the solution and write them in a string
    //
    std::string solutionStatisticsToString();
@@ -783,6 +1013,11 @@ public:
 	//
 	Tools::Timer* getTimerTotal() {return pTimerTotal_;}
 
+	// get/seed the random generator
+	//
+	std::minstd_rand& rdm() {return rdm_;}
+	void setRandomSeed(int rdmSeed) {rdm_.seed(rdmSeed);}
+
 	// return the solution, but only for the k first days
 	//
 	std::vector<Roster> getSolutionAtDay(int k);
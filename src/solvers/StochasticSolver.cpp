@@ -8,8 +8,14 @@
 #include "solvers/StochasticSolver.h"
 #include "tools/DemandGenerator.h"
 #include "solvers/mp/RotationMP.h"
+#include "solvers/Greedy.h"
 #include "tools/ReadWrite.h"
 
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 // #define COMPARE_EVALUATIONS
 
 using std::string;
@@ -141,9 +147,17 @@ StochasticSolver::StochasticSolver(PScenario pScenario, StochasticSolverOptions
 
    // initialize the log output
    pLogStream_ = new Tools::LogOutput(options_.logfile_);
+   pEvaluationLogStream_ = pLogStream_;
+
+   if (options_.withRacing_ && options_.nEvaluationThreads_ > 1) {
+      (*pLogStream_) << "# Racing is disabled: it does not apply when the demands are evaluated by several threads" << std::endl;
+      options_.withRacing_ = false;
+   }
 
-   //initialize random of tools
-   Tools::initializeRandomGenerator();
+   // the random generator of the solver (seeded with the generator of the
+   // thread) is used for the generation, and a second generator is used for the
+   // evaluation, because both may run concurrently
+   evaluationRdm_.seed(rdm_());
 
    if (!options_.generationParameters_.logfile_.empty()) {
       FILE * pFile;
@@ -276,6 +290,27 @@ void StochasticSolver::solveOneWeekWithoutPenalties(){
 // Solves the problem by generation + evaluation of scenarios
 void StochasticSolver::solveOneWeekGenerationEvaluation(){
 
+   // thread of the evaluation of the last schedule in pipelined mode
+   // the evaluation thread writes its log in a buffer, which is copied in the
+   // log file after each join
+   // The thread is joined when leaving this method, even on an exception, and
+   // an exception thrown in the thread is raised again in this thread
+   std::thread evaluationThread;
+   std::exception_ptr evaluationException;
+   bool isEvaluationDone = false;
+   Tools::LogOutput evaluationLog(evaluationLogBuffer_);
+   struct ThreadJoiner {
+      StochasticSolver* pSolver_;
+      std::thread& thread_;
+      ~ThreadJoiner() {
+         if (thread_.joinable()) thread_.join();
+         pSolver_->pEvaluationLogStream_ = pSolver_->pLogStream_;
+      }
+   } evaluationJoiner {this, evaluationThread};
+   if (options_.withPipelinedEvaluation_) {
+      pEvaluationLogStream_ = &evaluationLog;
+   }
+
    while(nSchedules_<options_.nGenerationDemandsMax_){
 
       // get the time left to solve another schedule
@@ -294,46 +329,33 @@ void StochasticSolver::solveOneWeekGenerationEvaluation(){
          options_.generationParameters_.weekIndices_ = { pScenario_->thisWeek() };
       }
 
-      if(addAndSolveNewSchedule()){
-
-         // Get the new best schedule
-         //
-         int newBestSchedule = -1;
-         double newBestScore = LARGE_SCORE;
-         double bestBaseCost = 0;
-         for(int i=0; i<nSchedules_; i++){
-            if( (options_.demandingEvaluation_ && theScores_[i]+30 < newBestScore)||(!options_.demandingEvaluation_ && theScores_[i] < newBestScore) ){
-               newBestScore = theScores_[i];
-               newBestSchedule = i;
-               bestBaseCost = theBaseCosts_[i];
-            } else if (theScores_[i] == newBestScore and theBaseCosts_[i] < bestBaseCost){
-               newBestScore = theScores_[i];
-               newBestSchedule = i;
-               bestBaseCost = theBaseCosts_[i];
-            }
-         }
-
-         // write the output NOW so that it is not lost
-         //
-         bestScore_ = newBestScore;
-         if(newBestSchedule != bestSchedule_){
-            bestSchedule_ = newBestSchedule;
-
-            //			solution_ = pGenerationSolvers_[bestSchedule_]->getSolutionAtDay(6);
-            solution_ = schedules_[bestSchedule_];
-            loadSolution(solution_);
-            Tools::LogOutput outStream(options_.generationParameters_.outfile_);
-            outStream << solutionToString();
-
-
-            (*pLogStream_) << "# New best is schedule n°" << bestSchedule_ << " (score: " << bestScore_ << ")" << std::endl;
-            (*pLogStream_) << "# The new best solution was written in " << options_.generationParameters_.outfile_ << std::endl;
-
-         }
-         else {
-            (*pLogStream_) << "# Best schedule did not change and is no. " << bestSchedule_ << " (score: " << bestScore_ << ")" << std::endl;
-
+      // Pipelined mode: generate the new schedule while the previous one is
+      // evaluated by another thread, and update the best schedule as soon as
+      // the evaluation is over
+      if (options_.withPipelinedEvaluation_) {
+         solveNewSchedule();
+         if (evaluationThread.joinable()) {
+            evaluationThread.join();
+            flushEvaluationLog();
+            if (evaluationException) std::rethrow_exception(evaluationException);
+            if (isEvaluationDone) updateBestSchedule();
+            else (*pLogStream_) << "# Time has run out." << std::endl;
          }
+         storeNewSchedule();
+         if(nSchedules_ == 1)
+            generateAllEvaluationDemands();
+         int sched = nSchedules_-1;
+         evaluationThread = std::thread([this, sched, &isEvaluationDone, &evaluationException]() {
+            try {
+               isEvaluationDone = evaluateSchedule(sched);
+            }
+            catch (...) {
+               evaluationException = std::current_exception();
+            }
+         });
+      }
+      else if(addAndSolveNewSchedule()){
+         updateBestSchedule();
       } else {
          (*pLogStream_) << "# Time has run out." << std::endl;
       }
@@ -348,6 +370,16 @@ void StochasticSolver::solveOneWeekGenerationEvaluation(){
       //		if (timeLeft < avgTimePerSchedule) break;
 
    }
+
+   // wait for the evaluation of the last schedule
+   if (evaluationThread.joinable()) {
+      evaluationThread.join();
+      flushEvaluationLog();
+      if (evaluationException) std::rethrow_exception(evaluationException);
+      if (isEvaluationDone) updateBestSchedule();
+   }
+   pEvaluationLogStream_ = pLogStream_;
+
 #ifdef COMPARE_EVALUATIONS
    for(int i=0; i<nSchedules_; i++){
       (*pLogStream_) << " The score of schedule " << i << ". GENCOL : " << theScores_[i] << " ; GREEDY : " << theScoresGreedy_[i] << std::endl;
@@ -355,6 +387,56 @@ void StochasticSolver::solveOneWeekGenerationEvaluation(){
 #endif
 }
 
+// Copy the buffer of the evaluation log in the log file
+void StochasticSolver::flushEvaluationLog(){
+   (*pLogStream_) << evaluationLogBuffer_.str();
+   evaluationLogBuffer_.str("");
+}
+
+// Update the best schedule with the current scores
+void StochasticSolver::updateBestSchedule(){
+   // Get the new best schedule
+   //
+   int newBestSchedule = -1;
+   double newBestScore = LARGE_SCORE;
+   double bestBaseCost = 0;
+   for(int i=0; i<nSchedules_; i++){
+      if( (options_.demandingEvaluation_ && theScores_[i]+30 < newBestScore)||(!options_.demandingEvaluation_ && theScores_[i] < newBestScore) ){
+         newBestScore = theScores_[i];
+         newBestSchedule = i;
+         bestBaseCost = theBaseCosts_[i];
+      } else if (theScores_[i] == newBestScore and theBaseCosts_[i] < bestBaseCost){
+         newBestScore = theScores_[i];
+         newBestSchedule = i;
+         bestBaseCost = theBaseCosts_[i];
+      }
+   }
+
+   // write the output NOW so that it is not lost
+   //
+   bestScore_ = newBestScore;
+   if(newBestSchedule != bestSchedule_){
+      bestSchedule_ = newBestSchedule;
+
+      //			solution_ = pGenerationSolvers_[bestSchedule_]->getSolutionAtDay(6);
+      solution_ = schedules_[bestSchedule_];
+      loadSolution(solution_);
+      (*pLogStream_) << "# New best is schedule n°" << bestSchedule_ << " (score: " << bestScore_ << ")" << std::endl;
+
+      // an empty output file means that the intermediate solutions are not written
+      if (!options_.generationParameters_.outfile_.empty()) {
+         Tools::LogOutput outStream(options_.generationParameters_.outfile_);
+         outStream << solutionToString();
+         (*pLogStream_) << "# The new best solution was written in " << options_.generationParameters_.outfile_ << std::endl;
+      }
+
+   }
+   else {
+      (*pLogStream_) << "# Best schedule did not change and is no. " << bestSchedule_ << " (score: " << bestScore_ << ")" << std::endl;
+
+   }
+}
+
 //----------------------------------------------------------------------------
 //
 // Iterative solution process in which the week is first solved by itsef,
@@ -371,7 +453,7 @@ void StochasticSolver::solveIterativelyWithIncreasingDemand() {
 
    // Initialize the values that intervene in the stopping criterion
    double timeLeft = options_.totalTimeLimitSeconds_-pTimerTotal_->dSinceInit();
-   Tools::Timer* timerSolve = new Tools::Timer();
+   Tools::Timer* timerSolve = new Tools::Timer(Tools::WALL_CLOCK);
    timerSolve->init();
    double timeLastSolve = 0.0;
    int maxNbAddedWeeks = pScenario_->nbWeeks()- (pScenario_->thisWeek()+1);
@@ -480,7 +562,7 @@ void StochasticSolver::generateSingleGenerationDemand(){
    else{
       PDemand pSingleDemand;
       while(!isFeasible){
-         DemandGenerator dg (1, nDaysInDemand, demandHistory_ , pScenario_);
+         DemandGenerator dg (1, nDaysInDemand, demandHistory_ , pScenario_, rdm_());
          pSingleDemand = dg.generateSinglePerturbatedDemand(false); // no feasibility check here
          pCompleteDemand = pScenario_->pWeekDemand()->append(pSingleDemand);
          isFeasible = true;
@@ -508,8 +590,11 @@ void StochasticSolver::generateSingleGenerationDemand(){
 
 // Generate the schedules that are used for evaluation
 void StochasticSolver::generateAllEvaluationDemands(){
-   DemandGenerator dg (options_.nEvaluationDemands_, options_.nDaysEvaluation_, demandHistory_, pScenario_);
-   pEvaluationDemands_ = dg.generatePerturbedDemands();
+   DemandGenerator dg (options_.nEvaluationDemands_, options_.nDaysEvaluation_, demandHistory_, pScenario_, rdm_());
+   pEvaluationDemands_ = dg.generatePerturbedDemandsBatch();
+   // The column pool is shared by the evaluations over the same demand
+   Tools::initVector2D(evaluationColumnPool_, pScenario_->nbNurses_, options_.nEvaluationDemands_,
+      map<vector<int>, vector2D<double> >());
    // Initialize structures for scores
    for(int j=0; j<options_.nEvaluationDemands_; j++){
       map<double, set<int> > m;
@@ -536,18 +621,44 @@ void StochasticSolver::generateAllEvaluationDemands(){
 
 // Return a solver with the algorithm specified for schedule GENERATION
 Solver* StochasticSolver::setGenerationSolverWithInputAlgorithm(PDemand pDemand){
+   Solver* pSolver(nullptr);
    switch(options_.generationAlgorithm_){
    case GENCOL:
-      return new RotationMP(pScenario_, pDemand, pScenario_->pWeekPreferences(), pScenario_->pInitialState(), S_CLP);
+      pSolver = new RotationMP(pScenario_, pDemand, pScenario_->pWeekPreferences(), pScenario_->pInitialState(), S_CLP);
+      break;
    default:
       Tools::throwError("The algorithm is not handled yet");
       break;
    }
-   return nullptr;
+   pSolver->addInitialColumnPatterns(initialGenerationPatterns_);
+   return pSolver;
+}
+
+// Columns of the generation that can start the generation of the next week
+// The rotations of the first week are fixed by the solution of the week, but
+// those that start after it were priced on the generation demand of the next
+// week: they are moved one week earlier, and their cost is computed again
+// when they are added to the solver of the next week
+vector2D<double> StochasticSolver::getNextWeekColumnPatterns() const {
+   vector2D<double> patterns;
+   if (!pReusableGenerationSolver_) return patterns;
+   for (vector<double> pattern: pReusableGenerationSolver_->getColumnPatterns()) {
+      // the first day of the rotation is the second field of the pattern
+      if (pattern[1] < 7) continue;
+      pattern[1] -= 7;
+      patterns.push_back(pattern);
+   }
+   return patterns;
 }
 
 // Generate a new schedule
 void StochasticSolver::generateNewSchedule(){
+   solveNewSchedule();
+   storeNewSchedule();
+}
+
+// Solve the generation solver until a feasible schedule is found
+void StochasticSolver::solveNewSchedule(){
    bool hasFoundFeasible = false;
 
    while(!hasFoundFeasible){
@@ -584,11 +695,17 @@ void StochasticSolver::generateNewSchedule(){
       }
 
    }
+}
+
+// Store the schedule of the generation solver
+void StochasticSolver::storeNewSchedule(){
 
    // C. Store the solution
    //
    schedules_.push_back(pReusableGenerationSolver_->getSolutionAtDay(6));
    finalStates_.push_back(pReusableGenerationSolver_->getStatesOfDay(6));
+   theBaseCosts_.push_back(pReusableGenerationSolver_->computeSolutionCost(7));
+   theGenerationStatuses_.push_back(pReusableGenerationSolver_->getStatus());
 
    // D. Update the data
    //
@@ -609,6 +726,10 @@ void StochasticSolver::generateNewSchedule(){
 
 // Return a solver with the algorithm specified for schedule EVALUATION
 Solver* StochasticSolver::setEvaluationWithInputAlgorithm(PDemand pDemand, vector<State> * stateEndOfSchedule){
+   return setEvaluationWithInputAlgorithm(pDemand, stateEndOfSchedule, options_.evaluationAlgorithm_);
+}
+
+Solver* StochasticSolver::setEvaluationWithInputAlgorithm(PDemand pDemand, vector<State> * stateEndOfSchedule, Algorithm algorithm){
    Solver* pSolver(nullptr);
    PScenario pScen = std::make_shared<Scenario>(*pScenario_);
 
@@ -617,10 +738,13 @@ Solver* StochasticSolver::setEvaluationWithInputAlgorithm(PDemand pDemand, vecto
        pScenario_->nbNurses(), options_.nDaysEvaluation_, pScenario_->nbShifts());
    pScen->updateNewWeek(pDemand, pEmptyPref, *stateEndOfSchedule);
 
-   switch(options_.evaluationAlgorithm_){
+   switch(algorithm){
    case GENCOL:
       pSolver = new RotationMP(pScen, pDemand, pEmptyPref, stateEndOfSchedule, S_CLP);
       break;
+   case GREEDY:
+      pSolver = new Greedy(pScen, pDemand, pEmptyPref, stateEndOfSchedule);
+      break;
    default:
       Tools::throwError("The algorithm is not handled yet");
       break;
@@ -639,12 +763,16 @@ void StochasticSolver::initScheduleEvaluation(int sched){
    //	pEvaluationSolvers_.push_back(v);
    Solver* so (0);
    pReusableEvaluationSolvers_.push_back(so);
+
+   theEvaluationCosts_.resize(sched+1);
+   isScheduleEliminated_.resize(sched+1, false);
+   theGreedyCosts_.resize(sched+1, LARGE_SCORE);
 }
 
 // Evaluate 1 schedule on all evaluation instances
 bool StochasticSolver::evaluateSchedule(int sched){
 
-   (*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Evaluation of the schedule no. " << sched << std::endl;
+   (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Evaluation of the schedule no. " << sched << std::endl;
 
 #ifdef COMPARE_EVALUATIONS
    vector<Solver*> pGreedyEvaluators;
@@ -655,13 +783,25 @@ bool StochasticSolver::evaluateSchedule(int sched){
 #endif
 
    initScheduleEvaluation(sched);
-   vector<State> initialStates = finalStates_[nSchedules_-1];
+   vector<State> initialStates = finalStates_[sched];
    for (int i = 0; i < pScenario_->nbNurses_; i++) {
       initialStates[i].dayId_ = 0;
    }
 
-   int baseCost = pReusableGenerationSolver_->computeSolutionCost(7);
-   theBaseCosts_.push_back(baseCost);
+   // the base cost and the status are stored with the schedule, as the
+   // generation solver may already be solving the next schedule
+   int baseCost = theBaseCosts_[sched];
+   bool isGenerationInfeasible = theGenerationStatuses_[sched] == INFEASIBLE;
+
+   // Pre-screen the schedule with the greedy algorithm: only the schedules whose
+   // greedy cost is close to the best one are evaluated with the main algorithm
+   if (options_.withGreedyScreening_ && options_.evaluationAlgorithm_ != GREEDY
+         && options_.nEvaluationDemands_ > 0 && !isGenerationInfeasible
+         && isScreenedOutByGreedy(sched, initialStates, baseCost)) {
+      isScheduleEliminated_[sched] = true;
+      updateRankingsAndScores(options_.rankingStrategy_);
+      return true;
+   }
 
    // set the time per evaluation to the ratio of the time left over the number of evaluations
    // double timeLeft = options_.totalTimeLimitSeconds_-pTimerTotal_->dSinceInit();
@@ -673,14 +813,15 @@ bool StochasticSolver::evaluateSchedule(int sched){
       double timeLeft = options_.totalTimeLimitSeconds_ - pTimerTotal_->dSinceInit();
       if (nSchedules_ > 0)
          if (timeLeft < 1.0){
-            std::cout << "# Time has run out when evaluating schedule no." << (nSchedules_-1) << std::endl;
+            std::cout << "# Time has run out when evaluating schedule no." << sched << std::endl;
             return false;
          }
 
-      (*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Starting evaluation of schedule no. " << sched << " over evaluation demand no. " << j << std::endl;
+      (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Starting evaluation of schedule no. " << sched << " over evaluation demand no. " << j << std::endl;
 
       if(j==0){
          pReusableEvaluationSolvers_[sched] = setEvaluationWithInputAlgorithm(pEvaluationDemands_[j], & initialStates);
+         pReusableEvaluationSolvers_[sched]->setRandomSeed(evaluationRdm_());
       }
 
 #ifdef COMPARE_EVALUATIONS
@@ -715,7 +856,7 @@ bool StochasticSolver::evaluateSchedule(int sched){
       double currentCostGreedy = costPreviousWeeks_ + baseCost;
 #endif
 
-      if (pReusableGenerationSolver_->getStatus() == INFEASIBLE) {
+      if (isGenerationInfeasible) {
          currentCost = 1.0e6;
 #ifdef COMPARE_EVALUATIONS
          currentCostGreedy = 1.0e6;
@@ -724,11 +865,13 @@ bool StochasticSolver::evaluateSchedule(int sched){
       else {
          // Perform the actual evaluation on demand j by running the chosen algorithm
          // TODO : ici, arondi a l'entier -> peut etre modifie si besoin
+         addColumnsFromPool(pReusableEvaluationSolvers_[sched], j, initialStates);
          if(j==0){
             currentCost += (int) pReusableEvaluationSolvers_[sched]->solve(options_.evaluationParameters_);
          } else {
             currentCost += (int) pReusableEvaluationSolvers_[sched]->resolve(pEvaluationDemands_[j], options_.evaluationParameters_);
          }
+         storeColumnsInPool(pReusableEvaluationSolvers_[sched], j, initialStates);
 
 #ifdef COMPARE_EVALUATIONS
          pGreedyEvaluators[j]->solve();
@@ -738,19 +881,11 @@ bool StochasticSolver::evaluateSchedule(int sched){
 
       // Display
       //
-      (*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " evaluated over evaluation demand no. " << j << " (solution cost: " << currentCost << ")." << std::endl;
+      (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " evaluated over evaluation demand no. " << j << " (solution cost: " << currentCost << ")." << std::endl;
 
       // Insert the solution cost and solution
       //
-      // If already in the costs -> add it to the set of schedules that found that cost
-      if(schedulesFromObjectiveByEvaluationDemand_[j].find(currentCost) != schedulesFromObjectiveByEvaluationDemand_[j].end()){
-         schedulesFromObjectiveByEvaluationDemand_[j].at(currentCost).insert(sched);
-      }
-      // Otherwise, add a new pair
-      else{
-         set<int> s; s.insert(sched);
-         schedulesFromObjectiveByEvaluationDemand_[j].insert(pair<double, set<int> >( currentCost, s));
-      }
+      insertEvaluationCost(sched, j, currentCost);
 #ifdef COMPARE_EVALUATIONS
       if(schedulesFromObjectiveByEvaluationDemandGreedy_[j].find(currentCostGreedy) != schedulesFromObjectiveByEvaluationDemandGreedy_[j].end()){
          schedulesFromObjectiveByEvaluationDemandGreedy_[j].at(currentCostGreedy).insert(sched);
@@ -760,19 +895,352 @@ bool StochasticSolver::evaluateSchedule(int sched){
          schedulesFromObjectiveByEvaluationDemandGreedy_[j].insert(pair<double, set<int> >( currentCostGreedy, s));
       }
 #endif
+
+      // Stop the evaluation if the schedule is dominated by the best schedule
+      //
+      if (options_.withRacing_ && j+1 >= options_.racingMinDemands_ && j+1 < options_.nEvaluationDemands_
+            && isDominatedByBestSchedule(sched, j+1)) {
+         (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " is dominated by schedule no. " << bestSchedule_ << " after " << (j+1) << " evaluation demands: it is eliminated." << std::endl;
+         isScheduleEliminated_[sched] = true;
+         removeEvaluationCosts(sched);
+         racingSavedEvaluations_ += options_.nEvaluationDemands_-(j+1);
+         break;
+      }
+
+      // Evaluate the other demands concurrently once the first one has been
+      // evaluated: its solution is used as a warm start by every thread
+      //
+      if (j == 0 && options_.nEvaluationThreads_ > 1 && options_.nEvaluationDemands_ > 1) {
+         if (!evaluateScheduleConcurrently(sched, initialStates, baseCost)) {
+            return false;
+         }
+         break;
+      }
    }
 
-   (*pLogStream_) << "# Evaluation of schedule no. " << sched << " done!" << std::endl;
+   (*pEvaluationLogStream_) << "# Evaluation of schedule no. " << sched << " done!" << std::endl;
 
    updateRankingsAndScores(options_.rankingStrategy_);
 
+   if (options_.withRacing_) {
+      redistributeSavedEvaluations();
+   }
+   return true;
+
+}
+
+// Evaluate 1 schedule over the demands j>=1 with several threads
+// Each thread owns an evaluation solver, which is initialized with the columns
+// of the solution of the evaluation over the demand j=0, and then solves
+// the next demand that has not been evaluated yet
+bool StochasticSolver::evaluateScheduleConcurrently(int sched, vector<State> & initialStates, double baseCost){
+
+   int nDemands = options_.nEvaluationDemands_;
+   int nThreads = std::min(options_.nEvaluationThreads_, nDemands-1);
+   vector<Roster> warmStartSolution = pReusableEvaluationSolvers_[sched]->getSolution();
+   bool isGenerationInfeasible = theGenerationStatuses_[sched] == INFEASIBLE;
+
+   // the threads pick the next demand to evaluate, each thread builds its
+   // solver with the first demand it picks
+   vector<Solver*> pSolvers(nThreads, nullptr);
+   vector<int> rdmSeeds(nThreads);
+   for (int t = 0; t < nThreads; t++) rdmSeeds[t] = evaluationRdm_();
+   vector<double> costs(nDemands, 0.0);
+   vector<int> isEvaluated(nDemands, 0);
+   std::atomic<int> nextDemand(1);
+   std::atomic<bool> isTimeOut(false);
+   auto evaluate = [&](int t) {
+      int j;
+      while ((j = nextDemand++) < nDemands) {
+         // the timer of the solver reads the wall clock, so the time limit is not
+         // reached faster when several threads are busy
+         double timeLeft = options_.totalTimeLimitSeconds_ - pTimerTotal_->dSinceInit();
+         if (timeLeft < 1.0) {
+            isTimeOut = true;
+            return;
+         }
+         double currentCost = costPreviousWeeks_ + baseCost;
+         if (isGenerationInfeasible) {
+            currentCost = 1.0e6;
+         }
+         else if (!pSolvers[t]) {
+            pSolvers[t] = setEvaluationWithInputAlgorithm(pEvaluationDemands_[j], & initialStates);
+            pSolvers[t]->setRandomSeed(rdmSeeds[t]);
+            if(options_.evaluationCostPerturbation_){
+               if(pSolvers[t]->getNbDays() + (7*pScenario_->thisWeek()+1) < 7* pScenario_->nbWeeks_){
+                  pSolvers[t]->setBoundsAndWeights(options_.evaluationParameters_.weightStrategy_);
+               }
+            }
+            addColumnsFromPool(pSolvers[t], j, initialStates);
+            currentCost += (int) pSolvers[t]->solve(options_.evaluationParameters_, warmStartSolution);
+            storeColumnsInPool(pSolvers[t], j, initialStates);
+         } else {
+            addColumnsFromPool(pSolvers[t], j, initialStates);
+            currentCost += (int) pSolvers[t]->resolve(pEvaluationDemands_[j], options_.evaluationParameters_);
+            storeColumnsInPool(pSolvers[t], j, initialStates);
+         }
+         costs[j] = currentCost;
+         isEvaluated[j] = 1;
+      }
+   };
+
+   vector<std::thread> threads;
+   for (int t = 0; t < nThreads; t++) {
+      threads.push_back(std::thread(evaluate, t));
+   }
+   for (std::thread& th: threads) {
+      th.join();
+   }
+   for (Solver* pSolver: pSolvers) {
+      delete pSolver;
+   }
+
+   // insert the costs in the order of the demands
+   for (int j = 1; j < nDemands; j++) {
+      if (!isEvaluated[j]) break;
+      (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " evaluated over evaluation demand no. " << j << " (solution cost: " << costs[j] << ")." << std::endl;
+      insertEvaluationCost(sched, j, costs[j]);
+   }
+
+   if (isTimeOut) {
+      std::cout << "# Time has run out when evaluating schedule no." << sched << std::endl;
+      return false;
+   }
    return true;
+}
 
+// Signature of the initial state of a nurse for the evaluation column pool:
+// the columns generated for a nurse are valid for any schedule that ends in
+// the same state
+static vector<int> stateSignature(const State& state){
+   return {state.totalTimeWorked_, state.totalWeekendsWorked_, state.consDaysWorked_,
+      state.consShifts_, state.consDaysOff_, state.shiftType_, state.shift_};
+}
+
+// Add the columns of the pool that match the initial states to the solver
+void StochasticSolver::addColumnsFromPool(Solver* pSolver, int j, const vector<State>& initialStates){
+   if (!options_.withEvaluationColumnPool_) return;
+
+   std::lock_guard<std::mutex> lock(evaluationColumnPoolMutex_);
+   for (int n = 0; n < pScenario_->nbNurses_; n++) {
+      auto it = evaluationColumnPool_[n][j].find(stateSignature(initialStates[n]));
+      if (it != evaluationColumnPool_[n][j].end()) {
+         pSolver->addInitialColumnPatterns(it->second);
+      }
+   }
+}
+
+// Store the columns of the solver in the pool (they replace the previous ones)
+void StochasticSolver::storeColumnsInPool(Solver* pSolver, int j, const vector<State>& initialStates){
+   if (!options_.withEvaluationColumnPool_) return;
+
+   vector3D<double> patternsByNurse(pScenario_->nbNurses_);
+   for (const vector<double>& pattern: pSolver->getColumnPatterns()) {
+      patternsByNurse[(int)pattern[0]].push_back(pattern);
+   }
+
+   std::lock_guard<std::mutex> lock(evaluationColumnPoolMutex_);
+   for (int n = 0; n < pScenario_->nbNurses_; n++) {
+      if (!patternsByNurse[n].empty()) {
+         evaluationColumnPool_[n][j][stateSignature(initialStates[n])] = patternsByNurse[n];
+      }
+   }
+}
+
+// Insert the cost of the schedule sched over the evaluation demand j
+void StochasticSolver::insertEvaluationCost(int sched, int j, double cost){
+   theEvaluationCosts_[sched].resize(std::max((int)theEvaluationCosts_[sched].size(), j+1), 0.0);
+   theEvaluationCosts_[sched][j] = cost;
+
+   // If already in the costs -> add it to the set of schedules that found that cost
+   if(schedulesFromObjectiveByEvaluationDemand_[j].find(cost) != schedulesFromObjectiveByEvaluationDemand_[j].end()){
+      schedulesFromObjectiveByEvaluationDemand_[j].at(cost).insert(sched);
+   }
+   // Otherwise, add a new pair
+   else{
+      set<int> s; s.insert(sched);
+      schedulesFromObjectiveByEvaluationDemand_[j].insert(pair<double, set<int> >( cost, s));
+   }
+}
+
+// Evaluate the schedule with the greedy algorithm over every evaluation demand
+// The schedule is screened out if its average greedy cost exceeds the best
+// average greedy cost of the schedules still in the race by more than the
+// tolerance
+bool StochasticSolver::isScreenedOutByGreedy(int sched, vector<State> & initialStates, double baseCost){
+   // The greedy runs one after the other, so they share a single copy of the
+   // scenario that only gets the demand of each evaluation
+   PScenario pScen = std::make_shared<Scenario>(*pScenario_);
+   PPreferences pEmptyPref = std::make_shared<Preferences>(pScenario_->nbNurses(), options_.nDaysEvaluation_, pScenario_->nbShifts());
+   double greedyCost = 0;
+   for(int j=0; j<options_.nEvaluationDemands_; j++){
+      pScen->updateNewWeek(pEvaluationDemands_[j], pEmptyPref, initialStates);
+      pScen->setThisWeek(pScenario_->thisWeek()+1);
+      Greedy greedy(pScen, pEvaluationDemands_[j], pEmptyPref, &initialStates);
+      greedyCost += std::min((double)LARGE_SCORE, greedy.solve());
+   }
+   greedyCost = baseCost + greedyCost/options_.nEvaluationDemands_;
+   theGreedyCosts_[sched] = greedyCost;
+
+   double bestGreedyCost = LARGE_SCORE;
+   for(int s=0; s<sched; s++){
+      if (!isScheduleEliminated_[s]) bestGreedyCost = std::min(bestGreedyCost, theGreedyCosts_[s]);
+   }
+
+   (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Greedy cost of schedule no. " << sched << ": " << greedyCost << " (best: " << bestGreedyCost << ")" << std::endl;
+
+   if (!isGreedyCostScreenedOut(greedyCost, bestGreedyCost, options_.greedyScreeningTolerance_))
+      return false;
+
+   (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " is screened out by the greedy evaluation: it is eliminated." << std::endl;
+   return true;
+}
+
+// Screening decision: a greedy cost is screened out if it exceeds the best
+// greedy cost by more than the relative tolerance
+// Nothing is screened out as long as no schedule has a finite greedy cost
+bool StochasticSolver::isGreedyCostScreenedOut(double greedyCost, double bestGreedyCost, double tolerance){
+   if (bestGreedyCost >= LARGE_SCORE) return false;
+   return greedyCost > bestGreedyCost + tolerance*fabs(bestGreedyCost);
+}
+
+// Check if the schedule sched is statistically dominated by the best schedule
+// over the first nDemands evaluation demands
+// As the schedules are evaluated over the same demands, the costs are paired:
+// the schedule is dominated if the mean of the differences with the best
+// schedule is significantly positive (one-sided test)
+bool StochasticSolver::isDominatedByBestSchedule(int sched, int nDemands){
+   if (bestSchedule_ < 0 || bestSchedule_ == sched || nDemands < 2) return false;
+   const vector<double>& bestCosts = theEvaluationCosts_[bestSchedule_];
+   const vector<double>& costs = theEvaluationCosts_[sched];
+   if ((int)bestCosts.size() < nDemands || (int)costs.size() < nDemands) return false;
+
+   double mean = 0.0;
+   for (int j = 0; j < nDemands; j++) mean += costs[j]-bestCosts[j];
+   mean /= nDemands;
+   double variance = 0.0;
+   for (int j = 0; j < nDemands; j++) {
+      double diff = costs[j]-bestCosts[j]-mean;
+      variance += diff*diff;
+   }
+   variance /= (nDemands-1);
+
+   double criticalValue = studentCriticalValue(options_.racingConfidenceLevel_, nDemands-1);
+   return mean > criticalValue * sqrt(variance/nDemands);
+}
+
+// One-sided quantiles of the Student t distribution for 1 to 30 degrees of
+// freedom, followed by the quantile of the normal distribution
+// Beyond 30 degrees of freedom, the normal quantile z is corrected with the
+// first term of the Cornish-Fisher expansion: t = z + (z^3+z)/(4*nDegrees)
+double StochasticSolver::studentCriticalValue(double confidenceLevel, int nDegrees){
+   static const double quantiles90[31] = {
+      3.078, 1.886, 1.638, 1.533, 1.476, 1.440, 1.415, 1.397, 1.383, 1.372,
+      1.363, 1.356, 1.350, 1.345, 1.341, 1.337, 1.333, 1.330, 1.328, 1.325,
+      1.323, 1.321, 1.319, 1.318, 1.316, 1.315, 1.314, 1.313, 1.311, 1.310,
+      1.282};
+   static const double quantiles95[31] = {
+      6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833, 1.812,
+      1.796, 1.782, 1.771, 1.761, 1.753, 1.746, 1.740, 1.734, 1.729, 1.725,
+      1.721, 1.717, 1.714, 1.711, 1.708, 1.706, 1.703, 1.701, 1.699, 1.697,
+      1.645};
+   static const double quantiles99[31] = {
+      31.821, 6.965, 4.541, 3.747, 3.365, 3.143, 2.998, 2.896, 2.821, 2.764,
+      2.718, 2.681, 2.650, 2.624, 2.602, 2.583, 2.567, 2.552, 2.539, 2.528,
+      2.518, 2.508, 2.500, 2.492, 2.485, 2.479, 2.473, 2.467, 2.462, 2.457,
+      2.326};
+
+   const double* quantiles = 0;
+   if (fabs(confidenceLevel-0.90) < EPSILON) quantiles = quantiles90;
+   else if (fabs(confidenceLevel-0.95) < EPSILON) quantiles = quantiles95;
+   else if (fabs(confidenceLevel-0.99) < EPSILON) quantiles = quantiles99;
+   else Tools::throwError("StochasticSolver::studentCriticalValue: the confidence level of the racing must be 0.90, 0.95 or 0.99.");
+   if (nDegrees < 1) Tools::throwError("StochasticSolver::studentCriticalValue: at least one degree of freedom is needed.");
+
+   if (nDegrees <= 30) return quantiles[nDegrees-1];
+   double z = quantiles[30];
+   return z + (z*z*z+z)/(4.0*nDegrees);
+}
+
+// Remove the costs of an eliminated schedule from the rankings of the
+// evaluation demands
+// The schedule is not evaluated over every demand, so its partial costs would
+// only shift the ranks of the other schedules on the first demands
+void StochasticSolver::removeEvaluationCosts(int sched){
+   for (unsigned int j = 0; j < theEvaluationCosts_[sched].size(); j++) {
+      auto it = schedulesFromObjectiveByEvaluationDemand_[j].find(theEvaluationCosts_[sched][j]);
+      if (it == schedulesFromObjectiveByEvaluationDemand_[j].end()) continue;
+      it->second.erase(sched);
+      if (it->second.empty()) schedulesFromObjectiveByEvaluationDemand_[j].erase(it);
+   }
+}
+
+// Add evaluation demands with the evaluations saved by the race
+// A demand is added only when the saved evaluations pay for the evaluation of
+// every schedule still in the race, so that these schedules are always
+// compared over the same demands
+void StochasticSolver::redistributeSavedEvaluations(){
+   while (options_.nEvaluationDemands_ < options_.racingMaxEvaluationDemands_) {
+      vector<int> schedulesInRace;
+      for (int sched = 0; sched < nSchedules_; sched++) {
+         if (!isScheduleEliminated_[sched] && pReusableEvaluationSolvers_[sched]
+               && (int)theEvaluationCosts_[sched].size() == options_.nEvaluationDemands_)
+            schedulesInRace.push_back(sched);
+      }
+      if (schedulesInRace.empty() || racingSavedEvaluations_ < (int)schedulesInRace.size()) break;
+
+      // new evaluation demand, drawn as the other ones
+      int j = options_.nEvaluationDemands_;
+      DemandGenerator dg (1, options_.nDaysEvaluation_, demandHistory_, pScenario_, evaluationRdm_());
+      pEvaluationDemands_.push_back(dg.generatePerturbedDemandsBatch()[0]);
+      schedulesFromObjectiveByEvaluationDemand_.push_back(map<double, set<int> >());
+#ifdef COMPARE_EVALUATIONS
+      schedulesFromObjectiveByEvaluationDemandGreedy_.push_back(map<double, set<int> >());
+#endif
+      for (auto& poolOfNurse: evaluationColumnPool_) {
+         poolOfNurse.push_back(map<vector<int>, vector2D<double> >());
+      }
+      (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Evaluation demand no. " << j << " added with the evaluations saved by the race." << std::endl;
+
+      for (int sched: schedulesInRace) {
+         double timeLeft = options_.totalTimeLimitSeconds_ - pTimerTotal_->dSinceInit();
+         if (timeLeft < 1.0) {
+            std::cout << "# Time has run out when evaluating schedule no." << sched << std::endl;
+            return;
+         }
+
+         vector<State> initialStates = finalStates_[sched];
+         for (int i = 0; i < pScenario_->nbNurses_; i++) {
+            initialStates[i].dayId_ = 0;
+         }
+         Solver* pSolver = pReusableEvaluationSolvers_[sched];
+         double currentCost = costPreviousWeeks_ + theBaseCosts_[sched];
+         if (theGenerationStatuses_[sched] == INFEASIBLE) {
+            currentCost = 1.0e6;
+         }
+         else {
+            if(options_.evaluationCostPerturbation_){
+               if(pSolver->getNbDays() + (7*pScenario_->thisWeek()+1) < 7* pScenario_->nbWeeks_){
+                  pSolver->setBoundsAndWeights(options_.evaluationParameters_.weightStrategy_);
+               }
+            }
+            addColumnsFromPool(pSolver, j, initialStates);
+            currentCost += (int) pSolver->resolve(pEvaluationDemands_[j], options_.evaluationParameters_);
+            storeColumnsInPool(pSolver, j, initialStates);
+         }
+         (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Schedule no. " << sched << " evaluated over evaluation demand no. " << j << " (solution cost: " << currentCost << ")." << std::endl;
+         insertEvaluationCost(sched, j, currentCost);
+      }
+
+      racingSavedEvaluations_ -= schedulesInRace.size();
+      options_.nEvaluationDemands_++;
+      updateRankingsAndScores(options_.rankingStrategy_);
+   }
 }
 
 // Recompute all scores after one schedule evaluation
 void StochasticSolver::updateRankingsAndScores(RankingStrategy strategy){
-   (*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Starting the update of the scores and ranking." << std::endl;
+   (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Starting the update of the scores and ranking." << std::endl;
 
    vector<double> theNewScores(nSchedules_, 0);
 
@@ -786,13 +1254,13 @@ void StochasticSolver::updateRankingsAndScores(RankingStrategy strategy){
    switch(strategy){
    case RK_SCORE:
       for(int j=0; j<options_.nEvaluationDemands_; j++){
-         (*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Solution costs for demand no. " << j << std::endl;
+         (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Solution costs for demand no. " << j << std::endl;
          int localRank = 1;
          map<double, set<int> > localCosts = schedulesFromObjectiveByEvaluationDemand_[j];
          for(auto it = localCosts.begin(); it != localCosts.end(); ++it){
             for(int sched : it->second){
                theNewScores[sched] += (double)localRank + ((double)(it->second.size() - 1)) / ((double) it->second.size());
-               (*pLogStream_) << "#     | sched " << sched << " -> " << it->first << " (score += " << (double)localRank + ((double)(it->second.size() - 1)) / ((double) it->second.size()) << ")" << std::endl;
+               (*pEvaluationLogStream_) << "#     | sched " << sched << " -> " << it->first << " (score += " << (double)localRank + ((double)(it->second.size() - 1)) / ((double) it->second.size()) << ")" << std::endl;
             }
             localRank += it->second.size();
          }
@@ -800,12 +1268,12 @@ void StochasticSolver::updateRankingsAndScores(RankingStrategy strategy){
       break;
    case RK_MEAN:
       for(int j=0; j<options_.nEvaluationDemands_; j++){
-         (*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Solution costs for demand no. " << j << std::endl;
+         (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Solution costs for demand no. " << j << std::endl;
          map<double, set<int> > localCosts = schedulesFromObjectiveByEvaluationDemand_[j];
          for(pair<double, set<int> > p: localCosts)
             for(int sched : p.second){
                theNewScores[sched] +=(int) (p.first/(double)options_.nEvaluationDemands_);
-               (*pLogStream_) << "#     | sched " << sched << " -> " <<  p.first << std::endl;
+               (*pEvaluationLogStream_) << "#     | sched " << sched << " -> " <<  p.first << std::endl;
             }
       }
       break;
@@ -820,7 +1288,7 @@ void StochasticSolver::updateRankingsAndScores(RankingStrategy strategy){
    vector<double> theNewScoresGreedy;
    Tools::initDoubleVector(&theNewScoresGreedy, nSchedules_, 0);
    for(int j=0; j<options_.nEvaluationDemands_; j++){
-      (*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Solution costs for demand no. " << j << endl;
+      (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Solution costs for demand no. " << j << endl;
       int localRank = 1;
       map<double, set<int> > localCosts = schedulesFromObjectiveByEvaluationDemandGreedy_[j];
       for(map<double, set<int> >::iterator it = localCosts.begin(); it != localCosts.end(); ++it){
@@ -830,7 +1298,7 @@ void StochasticSolver::updateRankingsAndScores(RankingStrategy strategy){
             if((pEvaluationSolvers_[sched][j])->getStatus() == INFEASIBLE){
                theNewScoresGreedy[sched] += (double)localRank + ((double)(it->second.size() - 1)) / ((double) it->second.size());
             }
-            (*pLogStream_) << "#     | sched " << sched << " -> " << it->first << " (score += " << (double)localRank + ((double)(it->second.size() - 1)) / ((double) it->second.size()) << ")" << endl;
+            (*pEvaluationLogStream_) << "#     | sched " << sched << " -> " << it->first << " (score += " << (double)localRank + ((double)(it->second.size() - 1)) / ((double) it->second.size()) << ")" << endl;
          }
          localRank += it->second.size();
       }
@@ -838,8 +1306,15 @@ void StochasticSolver::updateRankingsAndScores(RankingStrategy strategy){
    theScoresGreedy_ = theNewScoresGreedy;
 #endif
 
+   // the schedules eliminated from the race are not evaluated on every demand,
+   // so they cannot be selected
+   for(int sched = 0; sched < nSchedules_; sched++){
+      if (sched < (int)isScheduleEliminated_.size() && isScheduleEliminated_[sched])
+         theNewScores[sched] = LARGE_SCORE;
+   }
+
    theScores_ = theNewScores;
-   (*pLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Update of the scores and ranking done!" << std::endl;
+   (*pEvaluationLogStream_) << "# [week=" << pScenario_->thisWeek() << "] Update of the scores and ranking done!" << std::endl;
 
 }
 
@@ -854,5 +1329,7 @@ Solver* StochasticSolver::setSubSolverWithInputAlgorithm(PDemand pDemand, Algori
       Tools::throwError("The algorithm is not handled yet");
       break;
    }
+   pSolver->setRandomSeed(rdm_());
+   pSolver->addInitialColumnPatterns(initialGenerationPatterns_);
    return pSolver;
 }
@@ -11,6 +11,8 @@
 
 #include "solvers/Solver.h"
 
+#include <mutex>
+
 
 enum RankingStrategy {RK_MEAN, RK_SCORE, RK_NONE};
 
@@ -75,6 +77,45 @@ public:
 	int nDaysEvaluation_ = 14;
 	int nGenerationDemandsMax_ = 100;
 
+	// Number of threads used to evaluate a schedule over the evaluation demands
+	// 1 -> the demands are evaluated sequentially with the same reusable solver
+	// >1 -> each thread evaluates a part of the demands with its own solver
+	int nEvaluationThreads_ = 1;
+
+	// True -> generate the next schedule while the previous one is evaluated
+	// by another thread
+	bool withPipelinedEvaluation_ = false;
+
+	// True -> race the schedules: the evaluation of a schedule is stopped as
+	// soon as it is statistically dominated by the best schedule over the
+	// demands evaluated so far (after at least racingMinDemands_ demands)
+	// Racing is disabled when nEvaluationThreads_ > 1, because every demand is
+	// then evaluated before the schedule can be compared with the best one
+	bool withRacing_ = false;
+	int racingMinDemands_ = 2;
+	// Confidence level of the one-sided test on the mean of the paired cost
+	// differences with the best schedule (0.90, 0.95 or 0.99): the critical
+	// value is the quantile of the Student t distribution with n-1 degrees of
+	// freedom for n demands
+	double racingConfidenceLevel_ = 0.95;
+	// The evaluations saved by the eliminated schedules are given back to the
+	// schedules still in the race: when they can pay for one evaluation of each
+	// of these schedules, a new evaluation demand is added and all of them are
+	// evaluated on it, until this maximum number of evaluation demands
+	// (0 -> no redistribution)
+	int racingMaxEvaluationDemands_ = 0;
+
+	// True -> share the columns generated during the evaluation of the schedules
+	// over the same evaluation demand for the nurses that have the same initial state
+	bool withEvaluationColumnPool_ = false;
+
+	// True -> pre-screen the schedules with the greedy algorithm before their
+	// evaluation with evaluationAlgorithm_
+	// A schedule is not evaluated if its average greedy cost over the evaluation
+	// demands exceeds the best one by more than greedyScreeningTolerance_ (relative)
+	bool withGreedyScreening_ = false;
+	double greedyScreeningTolerance_ = 0.1;
+
     std::string logfile_ = "";
 
 	SolverParam generationParameters_;
@@ -131,16 +172,50 @@ public:
 	//
 	int getNbSchedules() { return schedules_.size(); }
 
+	// Columns of the generation that can start the generation of the next week:
+	// the rotations that start after the first week of the generation demand,
+	// moved one week earlier (used when the weeks are solved by the same process)
+	//
+	vector2D<double> getNextWeekColumnPatterns() const;
+
+	// Columns added to every generation solver of the week
+	//
+	void setInitialGenerationColumns(const vector2D<double>& patterns) {
+		initialGenerationPatterns_ = patterns;
+	}
+
+	// Greedy screening: true if the greedy cost exceeds the best greedy cost by
+	// more than the relative tolerance
+	//
+	static bool isGreedyCostScreenedOut(double greedyCost, double bestGreedyCost, double tolerance);
+
+	// Racing: critical value of the one-sided Student t test at the given
+	// confidence level (0.90, 0.95 or 0.99) with nDegrees degrees of freedom
+	//
+	static double studentCriticalValue(double confidenceLevel, int nDegrees);
+
 protected:
 
 	void init();
 
+	// Columns added to every generation solver of the week
+	vector2D<double> initialGenerationPatterns_;
+
 	// Options that characterize the execution of the stochastic solver
 	StochasticSolverOptions options_;
 
 	// Log file that can be useful when calling the solver through simulator
 	Tools::LogOutput* pLogStream_;
 
+	// Log of the evaluation of the schedules: the log file, or a buffer when the
+	// evaluation runs in another thread, which the main thread copies in the log
+	// file after joining the evaluation thread
+	Tools::LogOutput* pEvaluationLogStream_;
+	std::stringstream evaluationLogBuffer_;
+
+	// copy the buffer of the evaluation log in the log file
+	void flushEvaluationLog();
+
 
 
 	//----------------------------------------------------------------------------
@@ -154,6 +229,8 @@ protected:
 	// evaluation of the score, and update of the rankings and data.
 	// Returns false if time has run out
 	bool addAndSolveNewSchedule();
+	// Update the best schedule with the current scores
+	void updateBestSchedule();
 	// Iterative solution process in which the week is first solved by itsef,
 	// before adding one perturbebd week demand and solving the new extended
 	// demand demand until no time is left
@@ -216,6 +293,10 @@ protected:
 	Solver * setGenerationSolverWithInputAlgorithm(PDemand pDemand);
 	// Generate a new schedule
 	void generateNewSchedule();
+	// Solve the generation solver until a feasible schedule is found
+	void solveNewSchedule();
+	// Store the schedule of the generation solver
+	void storeNewSchedule();
 
 
 
@@ -232,6 +313,20 @@ protected:
     std::vector<Solver*> pReusableEvaluationSolvers_;
     std::vector<std::map<double, std::set<int> > > schedulesFromObjectiveByEvaluationDemand_;
     std::vector<std::map<double, std::set<int> > > schedulesFromObjectiveByEvaluationDemandGreedy_;
+    // Costs of each schedule by evaluation demand, and schedules eliminated from the race
+    vector2D<double> theEvaluationCosts_;
+    std::vector<bool> isScheduleEliminated_;
+    // Number of evaluations saved by the schedules eliminated by the race
+    int racingSavedEvaluations_ = 0;
+    // Average greedy cost of each schedule over the evaluation demands (greedy screening)
+    std::vector<double> theGreedyCosts_;
+    // Shared column pool of the evaluation, indexed by nurse, evaluation demand,
+    // and signature of the initial state of the nurse
+    vector2D<std::map<std::vector<int>, vector2D<double> > > evaluationColumnPool_;
+    std::mutex evaluationColumnPoolMutex_;
+    // Random generator of the evaluation, which may run in another thread than
+    // the generation
+    std::minstd_rand evaluationRdm_;
 	// Scores
   std::vector<double> theScores_;
     std::vector<double> theScoresGreedy_;
@@ -241,13 +336,36 @@ protected:
 	double bestScore_;
 	double costPreviousWeeks_;
     std::vector<double> theBaseCosts_;
+    std::vector<Status> theGenerationStatuses_;
 
 	// Return a solver with the algorithm specified for schedule EVALUATION
 	Solver * setEvaluationWithInputAlgorithm(PDemand pDemand, std::vector<State> * stateEndOfSchedule);
+	Solver * setEvaluationWithInputAlgorithm(PDemand pDemand, std::vector<State> * stateEndOfSchedule, Algorithm algorithm);
 	// Initialization
 	void initScheduleEvaluation(int sched);
 	// Evaluate 1 schedule and store the corresponding detailed results (returns false if time has run out)
 	bool evaluateSchedule(int sched);
+	// Evaluate 1 schedule over the demands j>=1 with several threads, once the
+	// demand j=0 has been evaluated (returns false if time has run out)
+	bool evaluateScheduleConcurrently(int sched, std::vector<State> & initialStates, double baseCost);
+	// Insert the cost of the schedule sched over the evaluation demand j
+	void insertEvaluationCost(int sched, int j, double cost);
+	// Check if the schedule sched is statistically dominated by the best
+	// schedule over the first nDemands evaluation demands (racing mode)
+	bool isDominatedByBestSchedule(int sched, int nDemands);
+	// Remove the costs of an eliminated schedule from the rankings of the
+	// evaluation demands, so that they do not shift the ranks of the others
+	void removeEvaluationCosts(int sched);
+	// Add evaluation demands for the schedules still in the race with the
+	// evaluations saved by the eliminated ones
+	void redistributeSavedEvaluations();
+	// Evaluate the schedule sched with the greedy algorithm and check if it is
+	// too far from the best greedy cost to be evaluated (greedy screening)
+	bool isScreenedOutByGreedy(int sched, std::vector<State> & initialStates, double baseCost);
+	// Add the columns of the pool that match the initial states to the solver
+	void addColumnsFromPool(Solver* pSolver, int j, const std::vector<State>& initialStates);
+	// Store the columns of the solver in the pool
+	void storeColumnsInPool(Solver* pSolver, int j, const std::vector<State>& initialStates);
 	// Recompute all scores after one schedule evaluation
 	void updateRankingsAndScores(RankingStrategy strategy);
 	// Getter
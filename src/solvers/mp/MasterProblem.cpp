@@ -178,6 +178,19 @@ double MasterProblem::solve(vector<Roster> solution, bool rebuild) {
 
   // input an initial solution
   this->initializeSolution(solution);
+  // and the initial columns
+  // each pattern is added once, and not at all if the model already has it
+  // (e.g. when the model is solved again with another demand)
+  std::set<vector<double> > patterns;
+  if (!rebuild) {
+    for (const vector<double>& pattern: getColumnPatterns()) patterns.insert(pattern);
+  }
+  vector2D<double> newPatterns;
+  for (const vector<double>& pattern: initialColumnPatterns_) {
+    if (patterns.insert(pattern).second) newPatterns.push_back(pattern);
+  }
+  this->initializeColumns(newPatterns);
+  initialColumnPatterns_.clear();
 
   // DBG
 #ifdef  DBG
@@ -381,7 +394,12 @@ double MasterProblem::rollingSolve(const SolverParam& param, int firstDay) {
 		pModel_->setParameters(param, this);
     // add the best solution  back in the model
 		initializeSolution(solution_);
+		// add the columns of the warm start solutions
+		for (const vector<Roster>& solution: warmStartSolutions_) {
+			initializeSolution(solution);
+		}
 	}
+	warmStartSolutions_.clear();
 
 	// solve the problem
 	if (solverType_ != S_CBC ) {
@@ -406,8 +424,11 @@ double MasterProblem::rollingSolve(const SolverParam& param, int firstDay) {
 //------------------------------------------------------------------------------
 double MasterProblem::LNSSolve(const SolverParam& param) {
   // load and store the best solution
-  pModel_->loadBestSol();
-  storeSolution();
+  // if the model has no solution yet, the solution has been loaded from outside
+  // and solution_ is kept as is
+  if (pModel_->loadBestSol()) {
+    storeSolution();
+  }
   // reset the model
   pModel_->reset();
   pModel_->setParameters(param, this);
@@ -545,17 +566,55 @@ void MasterProblem::printCurrentSol(){
 		coverageToString();
 }
 
+// Get the compact patterns of the real columns of the model
+vector2D<double> MasterProblem::getColumnPatterns() const {
+  vector2D<double> patterns;
+  for(MyVar* var: pModel_->getActiveColumns())
+    if(var->getCost() < LARGE_SCORE)
+      patterns.push_back(var->getPattern());
+  return patterns;
+}
+
 /******************************************************
  * Get the duals values per day for a nurse
  ******************************************************/
+// retrieve the dual values of every nurse in the dual cache
+void MasterProblem::updateDualCosts() {
+  int nbDays = pDemand_->nbDays_, nbShifts = pScenario_->nbShifts_-1;
+  int nbNurses = theLiveNurses_.size(), nbPositions = pScenario_->nbPositions();
+
+  // the duals of the skills coverage are the same for all the nurses
+  // of a position
+  positionDuals_.resize(nbPositions*nbDays*nbShifts);
+  for(int p=0; p<nbPositions; ++p)
+    for(int k=0; k<nbDays; ++k)
+      for(int s=1; s<=nbShifts; ++s)
+        positionDuals_[(p*nbDays+k)*nbShifts+s-1] =
+            pModel_->getDual(numberOfNursesByPositionCons_[k][s-1][p], true);
+
+  shiftsDuals_.resize(nbNurses*nbDays*nbShifts);
+  startWorkDuals_.resize(nbNurses*nbDays);
+  endWorkDuals_.resize(nbNurses*nbDays);
+  workedWeekendDuals_.resize(nbNurses);
+  for(PLiveNurse pNurse: theLiveNurses_){
+    int i = pNurse->id_;
+    getShiftsDualValues(pNurse, &shiftsDuals_[i*nbDays*nbShifts]);
+    getStartWorkDualValues(pNurse, &startWorkDuals_[i*nbDays]);
+    getEndWorkDualValues(pNurse, &endWorkDuals_[i*nbDays]);
+    workedWeekendDuals_[i] = getWorkedWeekendDualValue(pNurse);
+  }
+}
+
 // build a DualCosts structure
 DualCosts MasterProblem::buildDualCosts(PLiveNurse  pNurse) const {
-  return DualCosts(getShiftsDualValues(pNurse), getStartWorkDualValues(pNurse),
-      getEndWorkDualValues(pNurse), getWorkedWeekendDualValue(pNurse));
+  int nbDays = pDemand_->nbDays_, nbShifts = pScenario_->nbShifts_-1;
+  int i = pNurse->id_;
+  return DualCosts(&shiftsDuals_[i*nbDays*nbShifts], &startWorkDuals_[i*nbDays],
+      &endWorkDuals_[i*nbDays], workedWeekendDuals_[i], nbDays, nbShifts);
 }
 
-vector2D<double> MasterProblem::getShiftsDualValues(PLiveNurse  pNurse) const {
-  vector2D<double> dualValues(pDemand_->nbDays_);
+void MasterProblem::getShiftsDualValues(PLiveNurse  pNurse, double* dualValues) const {
+  int nbDays = pDemand_->nbDays_, nbShifts = pScenario_->nbShifts_-1;
   int i = pNurse->id_;
   int p = pNurse->pContract_->id_;
 
@@ -571,38 +630,26 @@ vector2D<double> MasterProblem::getShiftsDualValues(PLiveNurse  pNurse) const {
   double maxWorkedDaysContractAvg = isMaxWorkedDaysContractAvgCons_[p] ?
                                     pModel_->getDual(maxWorkedDaysContractAvgCons_[p], true):0.0;
 
-  for(int k=0; k<pDemand_->nbDays_; ++k){
-    //initialize vector
-    vector<double> dualValues2(pScenario_->nbShifts_-1);
-
-    for(int s=1; s<pScenario_->nbShifts_; ++s){
-      /* Min/Max constraints */
-      dualValues2[s-1] = minWorkedDays + minWorkedDaysAvg + minWorkedDaysContractAvg;
-      dualValues2[s-1] += maxWorkedDays + maxWorkedDaysAvg + maxWorkedDaysContractAvg;
-
-      // pour ajuster les valeurs duales en fonction des heures travaillees
-
-      dualValues2[s-1] *= pScenario_->timeDurationToWork_[s];
-
-      /* Skills coverage */
-      dualValues2[s-1] += pModel_->getDual(
-          numberOfNursesByPositionCons_[k][s-1][pNurse->pPosition_->id_], true);
-    }
-
-    //store vector
-    dualValues[k] = dualValues2;
-  }
-
-  return dualValues;
+  double workedDual = minWorkedDays + minWorkedDaysAvg + minWorkedDaysContractAvg
+                      + maxWorkedDays + maxWorkedDaysAvg + maxWorkedDaysContractAvg;
+
+  /* Skills coverage */
+  // contiguous loops on the cache of the position of the nurse
+  // (the worked duals are adjusted to the time duration of the shifts)
+  const double* positionDuals = &positionDuals_[pNurse->pPosition_->id_*nbDays*nbShifts];
+  const int* timeDurations = &pScenario_->timeDurationToWork_[1];
+  for(int k=0; k<nbDays; ++k)
+    for(int s=0; s<nbShifts; ++s)
+      dualValues[k*nbShifts+s] = workedDual * timeDurations[s] + positionDuals[k*nbShifts+s];
 }
 
 
-vector<double> MasterProblem::getStartWorkDualValues(PLiveNurse pNurse) const {
-  return vector<double>(pDemand_->nbDays_);
+void MasterProblem::getStartWorkDualValues(PLiveNurse pNurse, double* dualValues) const {
+  std::fill(dualValues, dualValues+pDemand_->nbDays_, 0.0);
 }
 
-vector<double> MasterProblem::getEndWorkDualValues(PLiveNurse pNurse) const {
-  return vector<double>(pDemand_->nbDays_);
+void MasterProblem::getEndWorkDualValues(PLiveNurse pNurse, double* dualValues) const {
+  std::fill(dualValues, dualValues+pDemand_->nbDays_, 0.0);
 }
 
 double MasterProblem::getWorkedWeekendDualValue(PLiveNurse pNurse) const{
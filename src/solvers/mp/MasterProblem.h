@@ -24,20 +24,26 @@
 enum CostType {TOTAL_COST, CONS_SHIFTS_COST, CONS_WORKED_DAYS_COST,
     COMPLETE_WEEKEND_COST, PREFERENCE_COST, REST_COST};
 
+// The dual costs are not owned by the structure: it is a view on the dual
+// cache of the master problem (see MasterProblem::updateDualCosts), so it is
+// only valid until the next update of the cache
+//
 struct DualCosts{
 public:
 
-  DualCosts(const vector2D<double> & workedShiftsCosts,
-            const std::vector<double> & startWorkCosts,
-            const std::vector<double> & endWorkCosts,
-            double workedWeekendCost):
+  DualCosts(const double* workedShiftsCosts,
+            const double* startWorkCosts,
+            const double* endWorkCosts,
+            double workedWeekendCost,
+            int nDays, int nShifts):
               workedShiftsCosts_(workedShiftsCosts), startWorkCosts_(startWorkCosts),
-              endWorkCosts_(endWorkCosts), workedWeekendCost_(workedWeekendCost) {}
+              endWorkCosts_(endWorkCosts), workedWeekendCost_(workedWeekendCost),
+              nDays_(nDays), nShifts_(nShifts) {}
 
   // GETTERS
   //
-  inline int nDays() const { return startWorkCosts_.size(); }
-  inline double workedDayShiftCost(int day, int shift){return (workedShiftsCosts_[day][shift-1]);}
+  inline int nDays() const { return nDays_; }
+  inline double workedDayShiftCost(int day, int shift){return (workedShiftsCosts_[day*nShifts_+shift-1]);}
   inline double startWorkCost(int day){return (startWorkCosts_[day]);}
   inline double endWorkCost(int day){return (endWorkCosts_[day]);}
   inline double workedWeekendCost(){return workedWeekendCost_;}
@@ -45,18 +51,21 @@ public:
 
 protected:
 
-  // Indexed by : (day, shift) !! 0 = shift 1 !!
-  vector2D<double> workedShiftsCosts_;
+  // Indexed by : day*nShifts_ + shift-1 !! 0 = shift 1 !!
+  const double* workedShiftsCosts_;
 
   // Indexed by : day
-  std::vector<double> startWorkCosts_;
+  const double* startWorkCosts_;
 
   // Indexed by : day
-  std::vector<double> endWorkCosts_;
+  const double* endWorkCosts_;
 
   // Reduced cost of the weekends
   double workedWeekendCost_;
 
+  // Number of days and of worked shifts
+  int nDays_, nShifts_;
+
 };
 
 struct Pattern;
@@ -172,7 +181,11 @@ class MasterProblem : public Solver, public PrintSolution{
     // currently stored in the model
     vector3D<double> getFractionalRoster() ;
 
-    // build a DualCosts structure
+    // retrieve the dual values of every nurse in the dual cache
+    // must be called once per LP iteration, before the pricing
+    void updateDualCosts();
+
+    // build a DualCosts structure (a view on the dual cache)
     DualCosts buildDualCosts(PLiveNurse pNurse) const;
 
     //------------------------------------------------
@@ -194,6 +207,22 @@ class MasterProblem : public Solver, public PrintSolution{
     // Solve the problem with a method that allows for a warm start
     double rollingSolve(const SolverParam& parameters, int firstDay);
 
+    // Add a solution whose columns are added to the model at the next call to
+    // rollingSolve (e.g., the solution of a speculative window)
+    void addWarmStartSolution(const std::vector<Roster>& solution) {
+      warmStartSolutions_.push_back(solution);
+    }
+
+    // Get the compact patterns of the real columns of the model (i.e., without
+    // the artificial columns)
+    vector2D<double> getColumnPatterns() const override;
+
+    // Add columns given by their compact patterns at the next call to solve
+    // (e.g., the columns generated for another schedule)
+    void addInitialColumnPatterns(const vector2D<double>& patterns) override {
+      initialColumnPatterns_.insert(initialColumnPatterns_.end(), patterns.begin(), patterns.end());
+    }
+
     // Special solve function for LNS
     // It is a priori the same as a regular, but it might be modified if needed
     double LNSSolve(const SolverParam& parameters);
@@ -261,6 +290,17 @@ class MasterProblem : public Solver, public PrintSolution{
     MyTree* pTree_;//store the tree information
     MyBranchingRule* pRule_; //choose the variables on which we should branch
     MySolverType solverType_; //which solver is used
+    vector2D<Roster> warmStartSolutions_; //solutions added as columns at the next rolling solve
+    vector2D<double> initialColumnPatterns_; //columns added at the next solve
+
+    /*
+    * Dual cache: flat arrays filled once per LP iteration by updateDualCosts
+    */
+    std::vector<double> positionDuals_; //indexed by (position, day, shift-1): duals of the number of nurses constraints
+    std::vector<double> shiftsDuals_; //indexed by (nurse, day, shift-1)
+    std::vector<double> startWorkDuals_; //indexed by (nurse, day)
+    std::vector<double> endWorkDuals_; //indexed by (nurse, day)
+    std::vector<double> workedWeekendDuals_; //indexed by nurse
 
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //
@@ -347,6 +387,9 @@ class MasterProblem : public Solver, public PrintSolution{
     // Provide an initial solution to the solver
     virtual void initializeSolution(const std::vector<Roster>& solution) = 0;
 
+    // Add initial columns given by their compact patterns
+    virtual void initializeColumns(const vector2D<double>& patterns) = 0;
+
     //solve method to catch execption
     void solveWithCatch();
 
@@ -366,10 +409,10 @@ class MasterProblem : public Solver, public PrintSolution{
     void buildSkillsCoverageCons(const SolverParam& parameters);
     int addSkillsCoverageConsToCol(std::vector<MyCons*>& cons, std::vector<double>& coeffs, int i, int k, int s=-1);
 
-    /* retrieve the dual values */
-    virtual vector2D<double> getShiftsDualValues(PLiveNurse  pNurse) const;
-    virtual std::vector<double> getStartWorkDualValues(PLiveNurse pNurse) const;
-    virtual std::vector<double> getEndWorkDualValues(PLiveNurse pNurse) const;
+    /* retrieve the dual values of a nurse in the input arrays of the cache */
+    virtual void getShiftsDualValues(PLiveNurse  pNurse, double* dualValues) const;
+    virtual void getStartWorkDualValues(PLiveNurse pNurse, double* dualValues) const;
+    virtual void getEndWorkDualValues(PLiveNurse pNurse, double* dualValues) const;
     virtual double getWorkedWeekendDualValue(PLiveNurse pNurse) const;
 
     /* Display functions */
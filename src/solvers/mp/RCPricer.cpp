@@ -57,6 +57,9 @@ vector<MyVar*> RCPricer::pricing(double bound, bool before_fathom, bool after_fa
 	// Reset all rotations, columns, counters, etc.
 	resetSolutions();
 
+	// Retrieve the dual values of all the nurses once for this LP iteration
+	pMaster_->updateDualCosts();
+
 
 	// count and store the nurses whose subproblems produced rotations.
 	// DBG: why minDualCost? Isn't it more a reduced cost?
@@ -324,7 +327,7 @@ void RCPricer::printStatSPSolutions(){
 void RCPricer::generateRandomForbiddenStartingDays(){
 	set<int> randomForbiddenStartingDays;
 	for(int m=0; m<5; m++){
-		int k = Tools::randomInt(0, nbDays_-1);
+		int k = Tools::randomInt(pMaster_->rdm(), 0, nbDays_-1);
 		randomForbiddenStartingDays.insert(k);
 	}
 	forbiddenStartingDays_ = randomForbiddenStartingDays;
@@ -369,9 +369,21 @@ void RotationMP::initializeSolution(const vector<Roster>& solution) {
   }
 }
 
-vector<double> RotationMP::getStartWorkDualValues(PLiveNurse pNurse) const {
+void RotationMP::initializeColumns(const vector2D<double>& patterns) {
+  for (const vector<double>& pattern: patterns) {
+    // skip the rotations that end after the horizon (e.g. the columns of
+    // another week on a shorter demand)
+    if (pattern[1]+pattern[2] > pDemand_->nbDays_) continue;
+    // the cost is computed again, as it depends on the initial state
+    Rotation rotation(pattern);
+    rotation.computeCost(pScenario_, theLiveNurses_, pDemand_->nbDays_);
+    rotation.computeTimeDuration(pScenario_);
+    pModel_->addInitialColumn(addRotation(rotation, "poolRotation"));
+  }
+}
+
+void RotationMP::getStartWorkDualValues(PLiveNurse pNurse, double* dualValues) const {
   int i = pNurse->id_;
-  vector<double> dualValues(pDemand_->nbDays_);
 
   //get dual value associated to the source
   dualValues[0] =  pModel_->getDual(restFlowCons_[i][0], true);
@@ -379,13 +391,10 @@ vector<double> RotationMP::getStartWorkDualValues(PLiveNurse pNurse) const {
   //don't take into account the last which is the sink
   for(int k=1; k<pDemand_->nbDays_; ++k)
     dualValues[k] = pModel_->getDual(workFlowCons_[i][k-1], true);
-
-  return dualValues;
 }
 
-vector<double> RotationMP::getEndWorkDualValues(PLiveNurse pNurse) const {
+void RotationMP::getEndWorkDualValues(PLiveNurse pNurse, double* dualValues) const {
   int i = pNurse->id_;
-  vector<double> dualValues(pDemand_->nbDays_);
 
   //get dual values associated to the work flow constraints
   //don't take into account the first which is the source
@@ -396,8 +405,6 @@ vector<double> RotationMP::getEndWorkDualValues(PLiveNurse pNurse) const {
   //get dual value associated to the sink
   dualValues[pDemand_->nbDays_-1] =
       pModel_->getDual(workFlowCons_[i][pDemand_->nbDays_-1], true);
-
-  return dualValues;
 }
 
 //------------------------------------------------------------------------------
@@ -24,11 +24,10 @@ struct Rotation: Pattern {
     //
     Rotation(std::map<int,int> shifts, int nurseId = -1, double cost = DBL_MAX, double dualCost = DBL_MAX) :
         Pattern(nurseId, -1, shifts.size()),
-        shifts_(shifts), id_(s_count), cost_(cost),
+        shifts_(shifts), id_(s_count++), cost_(cost),
         consShiftsCost_(0), consDaysWorkedCost_(0), completeWeekendCost_(0), preferenceCost_(0), initRestCost_(0),
         dualCost_(dualCost), timeDuration_(shifts.size())
     {
-      ++s_count;
       firstDay_ = INT_MAX;
       for(auto itS = shifts.begin(); itS != shifts.end(); ++itS)
         if(itS->first < firstDay_) firstDay_ = itS->first;
@@ -36,22 +35,20 @@ struct Rotation: Pattern {
 
     Rotation(int firstDay, std::vector<int> shiftSuccession, int nurseId = -1, double cost = DBL_MAX, double dualCost = DBL_MAX) :
         Pattern(nurseId, firstDay, shiftSuccession.size()),
-        id_(s_count), cost_(cost),
+        id_(s_count++), cost_(cost),
         consShiftsCost_(0), consDaysWorkedCost_(0), completeWeekendCost_(0), preferenceCost_(0), initRestCost_(0),
         dualCost_(dualCost), timeDuration_(shiftSuccession.size())
     {
-      ++s_count;
       for(int k=0; k<length_; k++)
         shifts_[firstDay+k] = shiftSuccession[k];
     }
 
     Rotation(const std::vector<double>& compactPattern) :
         Pattern(compactPattern),
-        id_(s_count), cost_(DBL_MAX),
+        id_(s_count++), cost_(DBL_MAX),
         consShiftsCost_(0), consDaysWorkedCost_(0), completeWeekendCost_(0), preferenceCost_(0), initRestCost_(0),
         dualCost_(DBL_MAX), timeDuration_((int)compactPattern.back())
     {
-      ++s_count;
       for(int k=0; k<length_; k++)
         shifts_[firstDay_+k] = (int)compactPattern[k+3];
     }
@@ -75,9 +72,9 @@ struct Rotation: Pattern {
       return shifts_.at(day);
     }
 
-    //count rotations
+    //count rotations (atomic, as several solvers can generate rotations concurrently)
     //
-    static unsigned int s_count;
+    static std::atomic<unsigned int> s_count;
 
     // Shifts to be performed
     //
@@ -198,6 +195,9 @@ class RotationMP: public MasterProblem {
     // Provide an initial solution to the solver. If empty, add artificial columns
     void initializeSolution(const std::vector<Roster>& solution) override ;
 
+    // Add initial rotations given by their compact patterns
+    void initializeColumns(const vector2D<double>& patterns) override ;
+
     //Create a new rotation variable
     //add the correct constraints and coefficients for the nurse i working on a rotation
     //if s=-1, the nurse works on all shifts
@@ -216,8 +216,8 @@ class RotationMP: public MasterProblem {
     double getColumnsCost(CostType costType, const std::vector<MyVar*>& vars) const;
 
     /* retrieve the dual values */
-    std::vector<double> getStartWorkDualValues(PLiveNurse pNurse) const override ;
-    std::vector<double> getEndWorkDualValues(PLiveNurse pNurse) const override ;
+    void getStartWorkDualValues(PLiveNurse pNurse, double* dualValues) const override ;
+    void getEndWorkDualValues(PLiveNurse pNurse, double* dualValues) const override ;
 
     /*
     * Variables
@@ -415,7 +415,7 @@ bool DiveBranchingRule::branchOnRestingArcs(MyBranchingCandidate& candidate){
 		}
 
 		// Here : random choice to decide the order of the siblings
-		if(Tools::randomInt(0, 1) == 0){
+		if(Tools::randomInt(pMaster_->rdm(), 0, 1) == 0){
 			tree_->pushBackNewRestNode(pBestNurse, bestDay, true, restingArcs);
 			tree_->pushBackNewRestNode(pBestNurse, bestDay , false, restingArcs);
 		} else {
@@ -20,6 +20,7 @@
 #include <string>
 #include <cmath>
 #include <typeinfo>
+#include <atomic>
 #include "solvers/Solver.h"
 
 #include "tools/MyTools.h"
@@ -40,8 +41,7 @@ enum SearchStrategy { BestFirstSearch, BreadthFirstSearch, DepthFirstSearch, Hig
  * If the object is added to the vector objects_ of the Modeler, the modeler will also delete it at the end.
  */
 struct MyObject {
-	MyObject(const char* name):id_(s_count) {
-		++s_count;
+	MyObject(const char* name):id_(s_count++) {
 		char* name2 = new char[255];
 		strncpy(name2, name, 255);
 		name_ = name2;
@@ -55,8 +55,8 @@ struct MyObject {
 	}
   virtual ~MyObject(){//cout << "LP DEL : " << name_ << std::endl;
 	  delete[] name_;}
-	//count object
-	static unsigned int s_count;
+	//count object (atomic, as several solvers can build their models concurrently)
+	static std::atomic<unsigned int> s_count;
 	//for the map rotations_
 	int operator < (const MyObject& m) const { return this->id_ < m.id_; }
 
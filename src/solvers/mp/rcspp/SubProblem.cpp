@@ -584,11 +584,11 @@ void SubProblem::resetAuthorizations(){
 }
 
 // Generate random forbidden shifts
-set< pair<int,int> > SubProblem::randomForbiddenShifts(int nbForbidden){
+set< pair<int,int> > SubProblem::randomForbiddenShifts(std::minstd_rand& rdm, int nbForbidden){
 	set< pair<int,int> > ans;
 	for(int f=0; f<nbForbidden; f++){
-		int k = Tools::randomInt(0, nDays_ - 1);
-		int s = Tools::randomInt(1, pScenario_->nbShifts_ - 1);
+		int k = Tools::randomInt(rdm, 0, nDays_ - 1);
+		int s = Tools::randomInt(rdm, 1, pScenario_->nbShifts_ - 1);
 		ans.insert(std::pair<int,int>(k,s));
 	}
 	return ans;
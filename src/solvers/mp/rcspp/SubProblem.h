@@ -353,7 +353,7 @@ class SubProblem {
 
     // Given an arc, returns the normal travel time (i.e. travel time when authorized)
     // Test for random forbidden day-shift
-    std::set<std::pair<int, int> > randomForbiddenShifts(int nbForbidden);
+    std::set<std::pair<int, int> > randomForbiddenShifts(std::minstd_rand& rdm, int nbForbidden);
 
 
   public:
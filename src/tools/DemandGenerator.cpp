@@ -10,6 +10,8 @@
 #include "tools/MyTools.h"
 #include "data/Nurse.h"
 
+#include <cstdint>
+
 
 using std::string;
 using std::vector;
@@ -91,11 +93,11 @@ PDemand DemandGenerator::generateSinglePerturbatedDemand(bool checkFeasibility){
 		}
 
 		// create the first week
-		PDemand pCompleteDemand = demandHistory_[indexInHistory[0]]->randomPerturbation();
+		PDemand pCompleteDemand = demandHistory_[indexInHistory[0]]->randomPerturbation(rdm_);
 
 		// create the following weeks append them to the complete demand
 		for (int i = 0; i < nbWeeksInGeneratedDemands-1; i++) {
-			PDemand pWeekDemand = demandHistory_[indexInHistory[i]]->randomPerturbation();
+			PDemand pWeekDemand = demandHistory_[indexInHistory[i+1]]->randomPerturbation(rdm_);
 			pCompleteDemand->push_back(pWeekDemand);
 		}
 
@@ -113,6 +115,157 @@ PDemand DemandGenerator::generateSinglePerturbatedDemand(bool checkFeasibility){
 }
 
 
+//----------------------------------------------------------------------------
+// Generate nbDemandsToGenerate_ demand scenarios in one contiguous buffer
+// The perturbations are those of generateSinglePerturbatedDemand, but each
+// step is applied to the whole batch so that a large number of demands can be
+// generated for the evaluation of the schedules
+// The demands are stored one after the other in the same tables, and each
+// generated demand is a view on its days
+//----------------------------------------------------------------------------
+
+vector<PDemand> DemandGenerator::generatePerturbedDemandsBatch() {
+
+	int nbDemands = nbDemandsToGenerate_;
+	int nbShifts = pScenario_->nbShifts_, nbSkills = pScenario_->nbSkills_;
+	int nbPastDemands = demandHistory_.size();
+	int nbDaysPerWeek = demandHistory_[0]->nbDays_;
+	int nbWeeks = (nbDaysInGeneratedDemands_-1)/nbDaysPerWeek+1;
+	int nbDaysPerDemand = nbWeeks*nbDaysPerWeek;
+
+	// one reference history demand is randomly drawn for each week of each
+	// demand
+	vector<int> indexInHistory;
+	drawRandomInts(indexInHistory, nbWeeks*nbDemands, 0, nbPastDemands-1);
+
+	// copy the reference weeks in the tables of the batch
+	DemandTable minDemand, optDemand;
+	for (int k = 0; k < nbDemands; k++) {
+		for (int w = 0; w < nbWeeks; w++) {
+			PDemand pHistory = demandHistory_[indexInHistory[w*nbDemands+k]];
+			minDemand.append(pHistory->minDemand_);
+			optDemand.append(pHistory->optDemand_);
+		}
+	}
+
+	for (int w = 0; w < nbWeeks; w++) {
+		vector2D<int> highestPerSkill(nbDemands);
+		for (int k = 0; k < nbDemands; k++)
+			highestPerSkill[k] = demandHistory_[indexInHistory[w*nbDemands+k]]->minHighestPerSkill_;
+		perturbWeekBatch(minDemand, optDemand, nbDaysPerDemand, w*nbDaysPerWeek, nbDaysPerWeek, highestPerSkill);
+	}
+
+	// each demand keeps the required number of days of its part of the tables
+	vector<PDemand> generatedDemands;
+	for (int k = 0; k < nbDemands; k++) {
+		int firstDay = k*nbDaysPerDemand;
+		PDemand pFirstWeek = demandHistory_[indexInHistory[k]];
+		generatedDemands.push_back(std::make_shared<Demand>(nbDaysInGeneratedDemands_,
+			pFirstWeek->firstDay_, nbShifts, nbSkills, pFirstWeek->name_,
+			minDemand.slice(firstDay, firstDay+nbDaysInGeneratedDemands_),
+			optDemand.slice(firstDay, firstDay+nbDaysInGeneratedDemands_)));
+	}
+
+	return generatedDemands;
+}
+
+// draw nbDraws random integers in [minVal, maxVal]
+// The draws of rdm_ follow x(n+1) = a*x(n) mod m, so x(n+nbLanes) =
+// a^nbLanes*x(n) mod m: the draws are computed by blocks of nbLanes values
+// with no dependency between them, which lets the compiler vectorise the loop,
+// and rdm_ is then set to the last draw to continue the same sequence
+// As m = 2^31-1, the product modulo m is computed with shifts and additions
+void DemandGenerator::drawRandomInts(vector<int>& draws, int nbDraws, int minVal, int maxVal) {
+	draws.resize(nbDraws);
+	if (nbDraws <= 0) return;
+
+	const int nbLanes = 8;
+	const uint64_t m = std::minstd_rand::modulus, a = std::minstd_rand::multiplier;
+	uint32_t lanes[nbLanes];
+	uint64_t aLeap = 1;
+	lanes[0] = rdm_();
+	for (int l = 1; l < nbLanes; l++) lanes[l] = lanes[l-1]*a % m;
+	for (int l = 0; l < nbLanes; l++) aLeap = aLeap*a % m;
+
+	uint32_t range = maxVal-minVal+1;
+	for (int n = 0; ; n += nbLanes) {
+		int nbInBlock = std::min(nbLanes, nbDraws-n);
+		for (int l = 0; l < nbInBlock; l++) draws[n+l] = minVal+lanes[l]%range;
+		if (n+nbInBlock == nbDraws) {
+			rdm_.seed(lanes[nbInBlock-1]);
+			return;
+		}
+		for (int l = 0; l < nbLanes; l++) {
+			uint64_t product = lanes[l]*aLeap;
+			product = (product & m)+(product >> 31);
+			product = (product & m)+(product >> 31);
+			lanes[l] = (product == m) ? 0 : product;
+		}
+	}
+}
 
+// apply the perturbations of Demand::randomPerturbation to one week of every
+// demand of the batch
+void DemandGenerator::perturbWeekBatch(DemandTable& minDemand, DemandTable& optDemand, int nbDaysPerDemand,
+	int firstDay, int nbDays, const vector2D<int>& highestPerSkill) {
+
+	int nbDemands = nbDemandsToGenerate_;
+	int nbShifts = pScenario_->nbShifts_, nbSkills = pScenario_->nbSkills_;
+	vector<int> day1, day2, sh1, sh2, sk;
+
+	// swap the demand of nbDays/2 pairs of days
+	for (int i = 0; i < nbDays/2; i++) {
+		drawRandomInts(day1, nbDemands, firstDay, firstDay+nbDays-1);
+		drawRandomInts(day2, nbDemands, firstDay, firstDay+nbDays-1);
+		for (int k = 0; k < nbDemands; k++) {
+			int offset = k*nbDaysPerDemand;
+			minDemand.swapDays(offset+day1[k], offset+day2[k]);
+			optDemand.swapDays(offset+day1[k], offset+day2[k]);
+		}
+	}
 
+	// swap the demand of nbDays*nbSkills pairs of shifts with the same skill
+	// shift 0 is never taken
+	for (int i = 0; i < nbDays*nbSkills; i++) {
+		drawRandomInts(sk, nbDemands, 0, nbSkills-1);
+		drawRandomInts(day1, nbDemands, firstDay, firstDay+nbDays-1);
+		drawRandomInts(sh1, nbDemands, 1, nbShifts-1);
+		drawRandomInts(day2, nbDemands, firstDay, firstDay+nbDays-1);
+		drawRandomInts(sh2, nbDemands, 1, nbShifts-1);
+		for (int k = 0; k < nbDemands; k++) {
+			int offset = k*nbDaysPerDemand;
+			int minDemandTmp = minDemand.get(offset+day1[k], sh1[k], sk[k]);
+			int optDemandTmp = optDemand.get(offset+day1[k], sh1[k], sk[k]);
+			minDemand.set(offset+day1[k], sh1[k], sk[k], minDemand.get(offset+day2[k], sh2[k], sk[k]));
+			optDemand.set(offset+day1[k], sh1[k], sk[k], optDemand.get(offset+day2[k], sh2[k], sk[k]));
+			minDemand.set(offset+day2[k], sh2[k], sk[k], minDemandTmp);
+			optDemand.set(offset+day2[k], sh2[k], sk[k], optDemandTmp);
+		}
+	}
 
+	// add or remove demand in a random number of shifts in [-nbDays,nbDays]
+	// the demand cannot become greater than the highest demand of the week
+	vector<int> nbPerturb;
+	drawRandomInts(nbPerturb, nbDemands, -nbDays, nbDays);
+	for (int k = 0; k < nbDemands; k++) {
+		int offset = k*nbDaysPerDemand;
+		int valPerturb = (nbPerturb[k]>=0)? 1:-1;
+		int nbPerturbK = abs(nbPerturb[k]);
+		int coTrials = 0; // used to avoid infinite loop
+		for (int i = 0; i < nbPerturbK; i++) {
+			bool isAtUpperBound = true;
+			int day = 0, sh = 0, skill = 0;
+			while (isAtUpperBound && coTrials < 10*nbPerturbK) {
+				day = offset+firstDay+rdm_()%nbDays;
+				sh = 1+rdm_()%(nbShifts-1);
+				skill = rdm_()%nbSkills;
+				isAtUpperBound = (valPerturb >= 0)? (minDemand.get(day, sh, skill) >= highestPerSkill[k][skill]):false;
+				coTrials++;
+			}
+			if (coTrials >= 10*nbPerturbK) break;
+
+			minDemand.add(day, sh, skill, valPerturb);
+			optDemand.add(day, sh, skill, valPerturb);
+		}
+	}
+}
@@ -33,6 +33,11 @@ public:
 		nbDemandsToGenerate_(nbDemands), nbDaysInGeneratedDemands_(nbDays),demandHistory_(demands), pScenario_(pScenario),
 	   rdm_(Tools::getANewRandomGenerator()) {
 	}
+	// constructor with the seed of the random generator of the demands
+	DemandGenerator(int nbDemands, int nbDays, std::vector<PDemand> demands, PScenario pScenario, int rdmSeed):
+		nbDemandsToGenerate_(nbDemands), nbDaysInGeneratedDemands_(nbDays),demandHistory_(demands), pScenario_(pScenario),
+	   rdm_(rdmSeed) {
+	}
 	~DemandGenerator();
 
 public:
@@ -46,6 +51,13 @@ public:
 	// generate 1 demand through perturbations of the demand history
 	PDemand generateSinglePerturbatedDemand(bool checkFeasibility = true);
 
+	// generate nbDemandsToGenerate_ demands at once in a contiguous buffer
+	// each perturbation is applied to all the demands in the same loop, after
+	// drawing its random numbers for the whole batch
+	// The demands are drawn from the same distribution as with
+	// generatePerturbedDemands, and their tables are views on the buffer
+	std::vector<PDemand> generatePerturbedDemandsBatch();
+
 protected:
 	// number of demand scenarios that should be generated
 	int nbDemandsToGenerate_;
@@ -62,6 +74,18 @@ protected:
 
 	  //random generator
 	  std::minstd_rand rdm_;
+
+	// draw nbDraws random integers in [minVal, maxVal]
+	// the draws are the same as with nbDraws successive calls to rdm_
+	void drawRandomInts(std::vector<int>& draws, int nbDraws, int minVal, int maxVal);
+
+	// apply the perturbations of Demand::randomPerturbation to the week that
+	// starts at firstDay in every demand of the batch
+	// the demand k covers the days [k*nbDaysPerDemand, (k+1)*nbDaysPerDemand)
+	// of the tables of the batch, and highestPerSkill contains the highest
+	// demand per skill of the history week of each demand
+	void perturbWeekBatch(DemandTable& minDemand, DemandTable& optDemand, int nbDaysPerDemand,
+		int firstDay, int nbDays, const vector2D<int>& highestPerSkill);
 };
 
  #endif
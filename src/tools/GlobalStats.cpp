@@ -78,6 +78,26 @@ void GlobalStats::add(const GlobalStats& stats) {
 			nbImprovementsWithRepair_[i] += stats.nbImprovementsWithRepair_[i];
 		}
 	}
+
+	// Throughput of the operators
+	if (lnsNursesSelectionStats_.size() < stats.lnsNursesSelectionStats_.size()) {
+		lnsNursesSelectionStats_.resize(stats.lnsNursesSelectionStats_.size());
+	}
+	if (lnsDaysSelectionStats_.size() < stats.lnsDaysSelectionStats_.size()) {
+		lnsDaysSelectionStats_.resize(stats.lnsDaysSelectionStats_.size());
+	}
+	if (lnsRepairStats_.size() < stats.lnsRepairStats_.size()) {
+		lnsRepairStats_.resize(stats.lnsRepairStats_.size());
+	}
+	for (unsigned int i=0; i < stats.lnsNursesSelectionStats_.size(); i++) {
+		lnsNursesSelectionStats_[i].add(stats.lnsNursesSelectionStats_[i]);
+	}
+	for (unsigned int i=0; i < stats.lnsDaysSelectionStats_.size(); i++) {
+		lnsDaysSelectionStats_[i].add(stats.lnsDaysSelectionStats_[i]);
+	}
+	for (unsigned int i=0; i < stats.lnsRepairStats_.size(); i++) {
+		lnsRepairStats_[i].add(stats.lnsRepairStats_[i]);
+	}
 }
 
 // Print to a string the statistics of the lns
@@ -104,3 +124,26 @@ std::string GlobalStats::lnsStatsToString() {
 
 	return statStream.str();
 }
+
+// Print to a string the throughput of the operators of the lns
+// For each operator: number of iterations, cpu time, total improvement and
+// improvement per second
+//
+std::string GlobalStats::lnsThroughputToString() {
+	std::stringstream statStream;
+	statStream.precision(2);
+	statStream.setf( std::ios::fixed, std:: ios::floatfield );
+
+	statStream << "lns throughput: ";
+	for (const std::vector<LNSOperatorStats>* pOpStats:
+		{&lnsNursesSelectionStats_, &lnsDaysSelectionStats_, &lnsRepairStats_}) {
+		statStream << "&";
+		for (const LNSOperatorStats& opStats: *pOpStats) {
+			statStream << " " << opStats.nbIterations_ << " " << opStats.time_ << " ";
+			statStream << opStats.improvement_ << " " << opStats.improvementPerSecond() << " &";
+		}
+	}
+	statStream << "& ";
+
+	return statStream.str();
+}
@@ -18,6 +18,33 @@
 #include <vector>
 #include "solvers/Solver.h"
 
+//-----------------------------------------------------------------------------
+//
+//  S t r u c t   L N S O p e r a t o r S t a t s
+//
+//  Throughput of one operator of the adaptive LNS
+//
+//-----------------------------------------------------------------------------
+
+struct LNSOperatorStats{
+public:
+	// number of iterations that used the operator, cpu time spent in the repair
+	// of these iterations and total improvement of the objective they brought
+	//
+	int nbIterations_=0;
+	double time_=0.0;
+	double improvement_=0.0;
+
+	// improvement of the objective per cpu second
+	double improvementPerSecond() const {return time_ > 0.0 ? improvement_/time_ : 0.0;}
+
+	void add(const LNSOperatorStats& stats) {
+		nbIterations_ += stats.nbIterations_;
+		time_ += stats.time_;
+		improvement_ += stats.improvement_;
+	}
+};
+
 //-----------------------------------------------------------------------------
 //
 //  S t r u c t   G l o b a l S t a t s
@@ -83,6 +110,11 @@ public:
 	std::vector<int> nbImprovementsWithDaysSelection_;
 	std::vector<int> nbImprovementsWithRepair_;
 
+	// Throughput of each destroy/repair operator
+	std::vector<LNSOperatorStats> lnsNursesSelectionStats_;
+	std::vector<LNSOperatorStats> lnsDaysSelectionStats_;
+	std::vector<LNSOperatorStats> lnsRepairStats_;
+
 public:
 	// write all the stats
 	std::string toString();
@@ -90,6 +122,9 @@ public:
 	// Print to a string the statistics of the lns
 	std::string lnsStatsToString();
 
+	// Print to a string the throughput of the operators of the lns
+	std::string lnsThroughputToString();
+
 	// add the information of a stat object to this one
 	void add(const GlobalStats& stats);
 };
@@ -37,6 +37,8 @@ protected:
 	std::string solutionPath_="";
 	std::string logPath_="";
 	std::string paramFile_="";
+	std::string initialSolutionPath_="";
+	std::string snapshotPath_="";
 	int randSeed_=0;
 	double timeOut_=3600;
 	bool  shortSP_ = true;
@@ -64,6 +66,17 @@ public:
 	std::string logPath() {return logPath_;}
 	inline void logPath(std::string path) {logPath_=path;}
 
+	// directory of the solution files (sol-week<w>.txt) of a previous run that
+	// is used as initial solution
+	std::string initialSolutionPath() {return initialSolutionPath_;}
+	inline void initialSolutionPath(std::string path) {initialSolutionPath_=path;}
+	std::string initialSolutionWeek(int w) {return initialSolutionPath_+"/sol-week"+std::to_string(w)+".txt";}
+
+	// binary snapshot of the preprocessed scenario: it is read instead of the
+	// input files if it was written for the same files, and written otherwise
+	std::string snapshotPath() const {return snapshotPath_;}
+	inline void snapshotPath(std::string path) {snapshotPath_=path;}
+
 	int randSeed() {return randSeed_;}
 	inline void randSeed(int seed) {randSeed_ =  seed;}
   double timeOut() {return timeOut_;}
@@ -0,0 +1,572 @@
+/*
+ * InstanceParser.cpp
+ *
+ *  Created on: October 10, 2020
+ */
+
+#include "tools/InstanceParser.h"
+#include "tools/MyTools.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// memory mapping of the files
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::string;
+using std::vector;
+using std::map;
+using std::pair;
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   M a p p e d F i l e
+//
+//-----------------------------------------------------------------------------
+
+MappedFile::MappedFile(const string& fileName): pData_(nullptr), size_(0), isMapped_(false) {
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::cout << "While trying to read the file " << fileName << std::endl;
+		throw Tools::myException("The input file was not opened properly!",__LINE__);
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+		void* pMap = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (pMap != MAP_FAILED) {
+			pData_ = static_cast<const char*>(pMap);
+			size_ = fileStat.st_size;
+			isMapped_ = true;
+		}
+	}
+	close(fd);
+
+	// read the file in a buffer if it could not be mapped (e.g. pipes)
+	if (!isMapped_) {
+		std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+		std::stringstream content;
+		content << file.rdbuf();
+		buffer_ = content.str();
+		pData_ = buffer_.data();
+		size_ = buffer_.size();
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (isMapped_) munmap(const_cast<char*>(pData_), size_);
+}
+
+
+//-----------------------------------------------------------------------------
+//
+//  S t r u c t u r e   T o k e n
+//
+//-----------------------------------------------------------------------------
+
+bool Token::operator==(const char* str) const {
+	return !strncmp(pStr, str, length) && str[length] == '\0';
+}
+
+bool Token::isInt() const {
+	int i = (length > 1 && pStr[0] == '-') ? 1 : 0;
+	if (i == length) return false;
+	for (; i < length; i++) {
+		if (pStr[i] < '0' || pStr[i] > '9') return false;
+	}
+	return true;
+}
+
+int Token::toInt() const {
+	if (!isInt()) {
+		Tools::throwError("Token::toInt: "+toString()+" is not an integer!");
+	}
+	int i = (pStr[0] == '-') ? 1 : 0, val = 0;
+	for (int j = i; j < length; j++) val = 10*val+(pStr[j]-'0');
+	return i ? -val : val;
+}
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   T o k e n i z e r
+//
+//-----------------------------------------------------------------------------
+
+// the white spaces and the characters = ( ) , only separate the tokens
+inline bool isSeparator(char c) {
+	return c <= ' ' || c == '=' || c == '(' || c == ')' || c == ',';
+}
+
+Token Tokenizer::next() {
+	while (pCur_ < pEnd_ && isSeparator(*pCur_)) pCur_++;
+	Token token;
+	token.pStr = pCur_;
+	while (pCur_ < pEnd_ && !isSeparator(*pCur_)) pCur_++;
+	token.length = pCur_-token.pStr;
+	return token;
+}
+
+int Tokenizer::nextInt() {
+	Token token = next();
+	if (token.empty()) {
+		Tools::throwError("Tokenizer::nextInt: unexpected end of the file!");
+	}
+	return token.toInt();
+}
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   S t r i n g I n t e r n e r
+//
+//-----------------------------------------------------------------------------
+
+// FNV-1a hash of the characters
+uint32_t StringInterner::hash(const char* pStr, int length) {
+	uint32_t h = 2166136261u;
+	for (int i = 0; i < length; i++) {
+		h ^= (unsigned char) pStr[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+bool StringInterner::isEqual(int id, const char* pStr, int length) const {
+	return lengths_[id] == length && !chars_.compare(offsets_[id], length, pStr, length);
+}
+
+int StringInterner::find(const char* pStr, int length) const {
+	uint32_t mask = slots_.size()-1;
+	for (uint32_t i = hash(pStr, length) & mask; slots_[i] >= 0; i = (i+1) & mask) {
+		if (isEqual(slots_[i], pStr, length)) return slots_[i];
+	}
+	return -1;
+}
+
+int StringInterner::intern(const char* pStr, int length) {
+	uint32_t mask = slots_.size()-1;
+	uint32_t i = hash(pStr, length) & mask;
+	for (; slots_[i] >= 0; i = (i+1) & mask) {
+		if (isEqual(slots_[i], pStr, length)) return slots_[i];
+	}
+
+	// new string
+	int id = offsets_.size();
+	offsets_.push_back(chars_.size());
+	lengths_.push_back(length);
+	chars_.append(pStr, length);
+	slots_[i] = id;
+
+	// keep at least half of the slots empty
+	if (2*offsets_.size() > slots_.size()) rehash();
+	return id;
+}
+
+void StringInterner::rehash() {
+	slots_.assign(2*slots_.size(), -1);
+	uint32_t mask = slots_.size()-1;
+	for (int id = 0; id < size(); id++) {
+		uint32_t i = hash(chars_.data()+offsets_[id], lengths_[id]) & mask;
+		while (slots_[i] >= 0) i = (i+1) & mask;
+		slots_[i] = id;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   I n s t a n c e P a r s e r
+//
+//-----------------------------------------------------------------------------
+
+// day of the week of a token, -1 if it is not a day
+static int tokenToDay(const Token& token) {
+	static const char* days[7] = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
+	for (int day = 0; day < 7; day++) {
+		if (token == days[day]) return day;
+	}
+	return -1;
+}
+
+InstanceParser::InstanceParser(PScenario pScenario): pScenario_(pScenario) {
+	if (pScenario_) internScenarioNames();
+}
+
+// intern the names of the scenario
+void InstanceParser::internScenarioNames() {
+	skills_ = StringInterner();
+	shiftTypes_ = StringInterner();
+	shifts_ = StringInterner();
+	nurses_ = StringInterner();
+	for (const string& name: pScenario_->intToSkill_) skills_.intern(name);
+	for (const string& name: pScenario_->intToShiftType_) shiftTypes_.intern(name);
+	for (const string& name: pScenario_->intToShift_) shifts_.intern(name);
+	for (PNurse pNurse: pScenario_->theNurses_) nurses_.intern(pNurse->name_);
+}
+
+// id of the name read in the input, an error is raised if it is unknown
+int InstanceParser::idOf(const StringInterner& names, const Token& token, const char* type) const {
+	int id = names.find(token);
+	if (id < 0) {
+		Tools::throwError("InstanceParser: unknown "+string(type)+" "+token.toString()+"!");
+	}
+	return id;
+}
+
+// Read the scenario file and build the scenario
+//
+PScenario InstanceParser::readScenario(const string& fileName) {
+	MappedFile file(fileName);
+	Tokenizer tokenizer(file.begin(), file.end());
+
+	// declare the attributes that will initialize the Scenario instance
+	//
+	string name;
+	int nbWeeks=-1, nbSkills=-1, nbShifts=-1, nbShiftsType=-1, nbContracts=-1, nbNurses=-1;
+	vector<string> intToSkill, intToShift, intToShiftType, intToContract;
+	map<string,int> skillToInt, shiftToInt, shiftTypeToInt, nurseNameToInt;
+	vector<int> minConsShiftType, maxConsShiftType, nbForbiddenSuccessors, hoursInShift, shiftIDToShiftTypeID;
+	vector2D<int> shiftTypeIDToShiftID;
+	vector2D<int> forbiddenSuccessors;
+	map<string,PConstContract> contracts;
+	vector<PConstContract> contractsById;
+	vector<PNurse> theNurses;
+	StringInterner contractNames;
+
+	skills_ = StringInterner();
+	shiftTypes_ = StringInterner();
+	shifts_ = StringInterner();
+	nurses_ = StringInterner();
+	bool foundShift = false;
+
+	// fill the attributes of the scenario structure
+	// the tokens that are not the title of a section are skipped
+	//
+	for (Token title = tokenizer.next(); !title.empty(); title = tokenizer.next()) {
+
+		// Read the name of the scenario
+		//
+		if (title == "SCENARIO") {
+			name = tokenizer.next().toString();
+		}
+
+		// Read the number of weeks in scenario
+		//
+		else if (title == "WEEKS") {
+			nbWeeks = tokenizer.nextInt();
+		}
+
+		// Read the skills
+		//
+		else if (title == "SKILLS") {
+			nbSkills = tokenizer.nextInt();
+			for (int i=0; i<nbSkills; i++) {
+				Token skill = tokenizer.next();
+				skills_.intern(skill);
+				intToSkill.push_back(skill.toString());
+				skillToInt.insert(pair<string,int>(intToSkill.back(),i));
+			}
+		}
+
+		// Read the different shift types
+		//
+		else if (title == "SHIFT_TYPES") {
+
+			// Number of shifts : Given number + REST_SHIFT
+			nbShiftsType = tokenizer.nextInt()+1;
+
+			// IMPORTANT : INSERT REST SHIFT !!!!!!
+			// It is given 0 and 99 as bounds so that they never perturbate the cost
+			//
+			shiftTypes_.intern(REST_SHIFT);
+			intToShiftType.push_back(REST_SHIFT);
+			shiftTypeToInt.insert(pair<string,int>(REST_SHIFT,0));
+			minConsShiftType.push_back(0);
+			maxConsShiftType.push_back(99);
+
+			// Other shift types: name (min consecutive, max consecutive)
+			//
+			for (int i=1; i<nbShiftsType; i++) {
+				Token shiftType = tokenizer.next();
+				shiftTypes_.intern(shiftType);
+				intToShiftType.push_back(shiftType.toString());
+				shiftTypeToInt.insert(pair<string,int>(intToShiftType.back(),i));
+				minConsShiftType.push_back(tokenizer.nextInt());
+				maxConsShiftType.push_back(tokenizer.nextInt());
+			}
+
+			forbiddenSuccessors.assign(nbShiftsType, vector<int>());
+			nbForbiddenSuccessors.assign(nbShiftsType, 0);
+		}
+
+		// Read the forbidden successions of shift types
+		//
+		else if (title == "FORBIDDEN_SHIFT_TYPES_SUCCESSIONS") {
+			for (int i=1; i<nbShiftsType; i++) {
+				// Which current shift type ? How many forbidden after it ?
+				int currentShiftTypeId = idOf(shiftTypes_, tokenizer.next(), "shift type");
+				nbForbiddenSuccessors[currentShiftTypeId] = tokenizer.nextInt();
+				// Which ones are forbidden ?
+				for (int j=0; j<nbForbiddenSuccessors[currentShiftTypeId]; j++) {
+					forbiddenSuccessors[currentShiftTypeId].push_back(idOf(shiftTypes_, tokenizer.next(), "shift type"));
+				}
+			}
+		}
+
+		// Read the different shifts
+		//
+		else if (title == "SHIFTS") {
+			foundShift = true;
+
+			// IMPORTANT : INSERT REST SHIFT !!!!!!
+			//
+			shifts_.intern(REST_SHIFT);
+			intToShift.push_back(REST_SHIFT);
+			shiftToInt.insert(pair<string,int>(REST_SHIFT,0));
+			hoursInShift.push_back(0);
+			shiftIDToShiftTypeID.push_back(0);
+			shiftTypeIDToShiftID.resize(nbShiftsType);
+			shiftTypeIDToShiftID[0].push_back(0);
+
+			// Number of shifts
+			nbShifts = tokenizer.nextInt()+1;
+
+			// Shifts: name, hours, shift type
+			//
+			for (int i=1; i<nbShifts; i++) {
+				Token shift = tokenizer.next();
+				shifts_.intern(shift);
+				intToShift.push_back(shift.toString());
+				shiftToInt.insert(pair<string,int>(intToShift.back(),i));
+				hoursInShift.push_back(tokenizer.nextInt());
+
+				int currentShiftTypeId = idOf(shiftTypes_, tokenizer.next(), "shift type");
+				shiftIDToShiftTypeID.push_back(currentShiftTypeId);
+				shiftTypeIDToShiftID[currentShiftTypeId].push_back(i);
+			}
+		}
+
+		// Read the different contracts type
+		// name (min days, max days) (min/max cons. work) (min/max cons. rest)
+		// max week-ends, complete week-ends
+		//
+		else if (title == "CONTRACTS") {
+			nbContracts = tokenizer.nextInt();
+			for (int i=0; i<nbContracts; i++) {
+				Token contract = tokenizer.next();
+				contractNames.intern(contract);
+				string contractName = contract.toString();
+				int minDays = tokenizer.nextInt(), maxDays = tokenizer.nextInt();
+				int minConsWork = tokenizer.nextInt(), maxConsWork = tokenizer.nextInt();
+				int minConsRest = tokenizer.nextInt(), maxConsRest = tokenizer.nextInt();
+				int maxWeekends = tokenizer.nextInt(), isTotalWeekend = tokenizer.nextInt();
+
+				PConstContract pContract =
+					std::make_shared<Contract>(i, contractName, minDays, maxDays, minConsWork, maxConsWork,
+						minConsRest, maxConsRest, maxWeekends, isTotalWeekend);
+				contracts[contractName] = pContract;
+				contractsById.push_back(pContract);
+				intToContract.push_back(contractName);
+			}
+		}
+
+		// Read all nurses: name, contract, number of skills, skills
+		//
+		else if (title == "NURSES") {
+			nbNurses = tokenizer.nextInt();
+			for (int i=0; i<nbNurses; i++) {
+				Token nurse = tokenizer.next();
+				nurses_.intern(nurse);
+				string nurseName = nurse.toString();
+				PConstContract pContract = contractsById[idOf(contractNames, tokenizer.next(), "contract")];
+				int nbSkillsNurse = tokenizer.nextInt();
+				vector<int> skills;
+				for (int j=0; j<nbSkillsNurse; j++) {
+					skills.push_back(idOf(skills_, tokenizer.next(), "skill"));
+				}
+				// sort the skill indices before initializing the nurse
+				std::sort(skills.begin(), skills.end());
+
+				theNurses.emplace_back(std::make_shared<Nurse>(i, nurseName, nbSkillsNurse, skills, pContract));
+				nurseNameToInt.insert(pair<string,int>(nurseName,i));
+			}
+		}
+	}
+
+	//  to be backward compatible with old style of input file (without the SHIFTS section)
+	//  set default shifts
+	//
+	if (!foundShift) {
+		nbShifts = nbShiftsType;
+		intToShift = intToShiftType;
+		shiftToInt = shiftTypeToInt;
+		shifts_ = shiftTypes_;
+		shiftTypeIDToShiftID.resize(nbShiftsType);
+		for (int i=0; i<nbShiftsType; i++) {
+			hoursInShift.push_back(1); // 1 as default (could be days, hours, ...)
+			shiftIDToShiftTypeID.push_back(i);
+			shiftTypeIDToShiftID[i].push_back(i);
+		}
+	}
+
+	// Check that all fields were initialized before initializing the scenario
+	//
+	if ( nbWeeks==-1 || nbSkills==-1 || nbShifts==-1 || nbContracts==-1 || nbNurses==-1 ) {
+		Tools::throwError("In readScenario: missing fields in the initialization");
+	}
+
+	pScenario_ = std::make_shared<Scenario>(name, nbWeeks, nbSkills, intToSkill, skillToInt, nbShifts,
+		intToShift, shiftToInt, hoursInShift, shiftIDToShiftTypeID,
+		nbShiftsType, intToShiftType, shiftTypeToInt, shiftTypeIDToShiftID,
+		minConsShiftType, maxConsShiftType, nbForbiddenSuccessors,forbiddenSuccessors,
+		nbContracts, intToContract, contracts, nbNurses, theNurses, nurseNameToInt);
+	return pScenario_;
+}
+
+// Read the week file and build its demand and its preferences
+//
+void InstanceParser::readWeek(const string& fileName, PDemand* pDemand, PPreferences* pPref) {
+	if (!pScenario_) {
+		Tools::throwError("InstanceParser::readWeek: the scenario must be read before the weeks!");
+	}
+	MappedFile file(fileName);
+	Tokenizer tokenizer(file.begin(), file.end());
+
+	int nbShifts = pScenario_->nbShifts_, nbSkills = pScenario_->nbSkills_;
+	string weekName;
+	DemandTable minWeekDemand(7, nbShifts, nbSkills), optWeekDemand(7, nbShifts, nbSkills);
+	if (!*pPref) {
+		*pPref = std::make_shared<Preferences>(pScenario_->nbNurses_, 7, nbShifts);
+	}
+
+	// fill the attributes when reading the week file
+	//
+	for (Token title = tokenizer.next(); !title.empty(); title = tokenizer.next()) {
+
+		// Read the name of the week
+		//
+		if (title == "WEEK_DATA") {
+			weekName = tokenizer.next().toString();
+		}
+
+		// Read the requirements: shift, skill and (min,opt) for every day
+		// the rest shift is not in the file, its requirements remain at 0
+		//
+		else if (title == "REQUIREMENTS") {
+			for (int i=1; i<nbShifts; i++) {
+				for (int j=0; j<nbSkills; j++) {
+					int shiftId = idOf(shifts_, tokenizer.next(), "shift");
+					int skillId = idOf(skills_, tokenizer.next(), "skill");
+					for (int day = 0; day<7; day++) {
+						minWeekDemand.set(day, shiftId, skillId, tokenizer.nextInt());
+						optWeekDemand.set(day, shiftId, skillId, tokenizer.nextInt());
+					}
+				}
+			}
+		}
+
+		// Read the shift off and on requests
+		//
+		else if (title == "SHIFT_OFF_REQUESTS") {
+			readRequests(tokenizer, *pPref, true);
+		}
+		else if (title == "SHIFT_ON_REQUESTS") {
+			readRequests(tokenizer, *pPref, false);
+		}
+	}
+
+	// Define a new instance of demand
+	*pDemand = std::make_shared<Demand>(7, 0, nbShifts, nbSkills, weekName, minWeekDemand, optWeekDemand);
+}
+
+// read the requests of a week file: nurse, shift (or Any), day and level
+// if there is no level, the level of the previous request is kept
+//
+void InstanceParser::readRequests(Tokenizer& tokenizer, PPreferences pPref, bool isOff) {
+	int nbRequests = tokenizer.nextInt();
+	PREF_LEVEL level = WEAK;
+	for (int i=0; i<nbRequests; i++) {
+		int nurseId = idOf(nurses_, tokenizer.next(), "nurse");
+		Token shift = tokenizer.next();
+		Token day = tokenizer.next();
+		int dayId = tokenToDay(day);
+		if (dayId < 0) {
+			Tools::throwError("InstanceParser: unknown day "+day.toString()+"!");
+		}
+		if (tokenizer.peek().isInt()) {
+			level = (PREF_LEVEL) tokenizer.nextInt();
+		}
+
+		if (shift == "Any") {
+			if (isOff) pPref->addDayOff(nurseId, dayId, level);
+			else pPref->addDayOn(nurseId, dayId, level);
+		}
+		else {
+			int shiftId = idOf(shifts_, shift, "shift");
+			if (isOff) pPref->addShiftOff(nurseId, dayId, shiftId, level);
+			else pPref->addShiftOn(nurseId, dayId, shiftId, level);
+		}
+	}
+}
+
+// Read the history file and set the initial states of the scenario
+//
+void InstanceParser::readHistory(const string& fileName) {
+	if (!pScenario_) {
+		Tools::throwError("InstanceParser::readHistory: the scenario must be read before the history!");
+	}
+	MappedFile file(fileName);
+	Tokenizer tokenizer(file.begin(), file.end());
+
+	int thisWeek = 0;
+	vector<State> initialState;
+
+	for (Token title = tokenizer.next(); !title.empty(); title = tokenizer.next()) {
+
+		// Read the index and name of the week
+		//
+		if (title == "HISTORY") {
+			thisWeek = tokenizer.nextInt();
+			Token weekName = tokenizer.next();
+			// Raise exception if it does not match the week previously read !
+			if (weekName != pScenario_->weekName().c_str()) {
+				std::cout << "The given history file requires week " << weekName.toString() << std::endl;
+				std::cout << " but a different one (" << pScenario_->weekName() << ") has been given!" << std::endl;
+				Tools::throwError("History file and week data file do not match!");
+			}
+		}
+
+		// Read each nurse's initial state: name, total time worked, total
+		// week-ends worked, last shift type, consecutive shifts, consecutive
+		// days worked and consecutive days of rest
+		//
+		else if (title == "NURSE_HISTORY") {
+			for (int n=0; n<pScenario_->nbNurses_; n++) {
+				Token nurseName = tokenizer.next();
+				int totalTimeWorked = tokenizer.nextInt();
+				int totalWeekendsWorked = tokenizer.nextInt();
+				int shiftTypeId = idOf(shiftTypes_, tokenizer.next(), "shift type");
+				int consShiftWorked = tokenizer.nextInt();
+				int consDaysWorked = tokenizer.nextInt();
+				int consRest = tokenizer.nextInt();
+
+				if (consRest == 0 && consDaysWorked == 0)
+					Tools::throwError("History of nurse " + nurseName.toString() + " is invalid as one must either work or rest.");
+
+				int shiftID = pScenario_->shiftTypeIDToShiftID_[shiftTypeId].front();
+				int consShifts = (shiftTypeId == 0) ? consRest : consShiftWorked;
+				initialState.emplace_back(0, totalTimeWorked, totalWeekendsWorked,
+					consDaysWorked, consShifts, consRest, shiftTypeId, shiftID);
+			}
+		}
+	}
+	pScenario_->setThisWeek(thisWeek);
+	pScenario_->setInitialState(initialState);
+}
@@ -0,0 +1,183 @@
+/*
+ * InstanceParser.h
+ *
+ *  Created on: October 10, 2020
+ */
+
+#ifndef __InstanceParser__
+#define __InstanceParser__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "data/Demand.h"
+#include "data/Nurse.h"
+#include "data/Scenario.h"
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   M a p p e d F i l e
+//
+//  Read-only view on the content of a file: the file is mapped in memory when
+//  possible and read in a buffer otherwise
+//
+//-----------------------------------------------------------------------------
+
+class MappedFile {
+
+public:
+	explicit MappedFile(const std::string& fileName);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* begin() const {return pData_;}
+	const char* end() const {return pData_+size_;}
+
+protected:
+	const char* pData_;
+	size_t size_;
+	bool isMapped_;
+
+	// content of the file when it could not be mapped
+	std::string buffer_;
+};
+
+
+//-----------------------------------------------------------------------------
+//
+//  S t r u c t u r e   T o k e n
+//
+//  View on the characters of a word of the input: no string is built
+//
+//-----------------------------------------------------------------------------
+
+struct Token {
+	const char* pStr = nullptr;
+	int length = 0;
+
+	bool empty() const {return length == 0;}
+	bool operator==(const char* str) const;
+	bool operator!=(const char* str) const {return !(*this == str);}
+	bool isInt() const;
+	int toInt() const;
+	std::string toString() const {return std::string(pStr, length);}
+};
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   T o k e n i z e r
+//
+//  Single pass over the characters of an input: the white spaces and the
+//  characters = ( ) , only separate the tokens
+//
+//-----------------------------------------------------------------------------
+
+class Tokenizer {
+
+public:
+	Tokenizer(const char* begin, const char* end): pCur_(begin), pEnd_(end) {}
+
+	// next token of the input, empty at the end of the input
+	Token next();
+
+	// next token without consuming it
+	Token peek() const {Tokenizer tokenizer(*this); return tokenizer.next();}
+
+	// next token that must be an integer
+	int nextInt();
+
+protected:
+	const char* pCur_;
+	const char* pEnd_;
+};
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   S t r i n g I n t e r n e r
+//
+//  Give consecutive ids to strings: the ids of the tokens are then found
+//  without building any string with an open-addressing hash table
+//
+//-----------------------------------------------------------------------------
+
+class StringInterner {
+
+public:
+	StringInterner(): slots_(16, -1) {}
+
+	// id of the string, a new id is given if the string was never met
+	int intern(const char* pStr, int length);
+	int intern(const Token& token) {return intern(token.pStr, token.length);}
+	int intern(const std::string& str) {return intern(str.c_str(), str.size());}
+
+	// id of the string, -1 if the string was never met
+	int find(const char* pStr, int length) const;
+	int find(const Token& token) const {return find(token.pStr, token.length);}
+
+	int size() const {return offsets_.size();}
+	std::string str(int id) const {return chars_.substr(offsets_[id], lengths_[id]);}
+
+protected:
+	// characters of all the strings and position of each string
+	std::string chars_;
+	std::vector<int> offsets_, lengths_;
+
+	// hash table: id of the string in each slot, -1 if the slot is empty
+	std::vector<int> slots_;
+
+	static uint32_t hash(const char* pStr, int length);
+	bool isEqual(int id, const char* pStr, int length) const;
+	void rehash();
+};
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   I n s t a n c e P a r s e r
+//
+//  Read the scenario, week and history files of the INRC-II in one pass each
+//  The names of the scenario are interned once, so that a parser can read
+//  many week and history files of the same scenario without any map lookup
+//
+//-----------------------------------------------------------------------------
+
+class InstanceParser {
+
+public:
+	// the scenario is given if it was already read
+	explicit InstanceParser(PScenario pScenario = nullptr);
+
+	// read the scenario file and build the scenario
+	PScenario readScenario(const std::string& fileName);
+
+	// read the week file and build its demand and its preferences
+	void readWeek(const std::string& fileName, PDemand* pDemand, PPreferences* pPref);
+
+	// read the history file and set the initial states of the scenario
+	void readHistory(const std::string& fileName);
+
+	PScenario pScenario() const {return pScenario_;}
+
+protected:
+	PScenario pScenario_;
+
+	// ids of the names of the scenario (same ids as in the scenario)
+	StringInterner skills_, shiftTypes_, shifts_, nurses_;
+
+	// intern the names of the scenario
+	void internScenarioNames();
+
+	// id of the name read in the input, an error is raised if it is unknown
+	int idOf(const StringInterner& names, const Token& token, const char* type) const;
+
+	// read the requests of a week file
+	void readRequests(Tokenizer& tokenizer, PPreferences pPref, bool isOff);
+};
+
+#endif
@@ -123,7 +123,12 @@ std::vector<int> parseList(std::string strList, char delimiter) {
 }
 
 //random generator of tools
-std::minstd_rand rdm0(0);
+//there is one generator per thread
+thread_local std::minstd_rand rdm0(0);
+
+std::minstd_rand& randomGenerator() {
+	return rdm0;
+}
 
 // Initialize the random generator with a given seed
 void initializeRandomGenerator(){
@@ -137,9 +142,9 @@ void initializeRandomGenerator(int rdmSeed){
 //the objective is to be sure to have always the same sequence of number
 //
 minstd_rand getANewRandomGenerator(){
-	int rdmSeed = rand();
+	int rdmSeed = rdm0();
 	std::cout << "The new random seed of random generator is " << rdmSeed << std::endl;
-   minstd_rand rdm(rand());
+   minstd_rand rdm(rdmSeed);
    return rdm;
 }
 minstd_rand getANewRandomGenerator(int rdmSeed){
@@ -159,16 +164,22 @@ int roundWithProbability(double number) {
 // Returns an integer with random value (uniform) within [minVal, maxVal]
 //
 int randomInt(int minVal, int maxVal) {
+	return randomInt(rdm0, minVal, maxVal);
+}
+int randomInt(std::minstd_rand& rdm, int minVal, int maxVal) {
 	if (minVal > maxVal) {
 		throwError("Tools::randomInt: minVal must be smaller than maxVal");
 	}
-	return minVal+rdm0()%(maxVal-minVal+1);
+	return minVal+rdm()%(maxVal-minVal+1);
 }
 
 // Returns a double with random value (uniform) within [minVal, maxVal]
 //
 double randomDouble(double minVal, double maxVal){
-	return ( (maxVal - minVal) * ( (double)rdm0() / (double)RAND_MAX ) + minVal );
+	return randomDouble(rdm0, minVal, maxVal);
+}
+double randomDouble(std::minstd_rand& rdm, double minVal, double maxVal){
+	return ( (maxVal - minVal) * ( (double)rdm() / (double)RAND_MAX ) + minVal );
 }
 
 // Initializes a vector< double > of size m with random values (uniform) within [minVal, maxVal]
@@ -197,6 +208,9 @@ std::vector< std::vector<double> > randomDoubleVector2D(int m, int n, double min
 // the probability of each index is w_i/sum{w_i}
 //
 int drawRandomWithWeights(std::vector<double> weights) {
+	return drawRandomWithWeights(rdm0, weights);
+}
+int drawRandomWithWeights(std::minstd_rand& rdm, std::vector<double> weights) {
 	if (weights.empty()) {
 		throwError("Tools::drawRandomWithWeights: the weight vector cannot be empty!");
 	}
@@ -208,7 +222,7 @@ int drawRandomWithWeights(std::vector<double> weights) {
 	}
 
 	// draw the index
-	double randNumber = randomDouble(0,sumWeights);
+	double randNumber = randomDouble(rdm, 0,sumWeights);
 	int index = 0;
 	double partialSum=weights[0];
 	for (unsigned int i=0; i < weights.size()-1; i++) {
@@ -226,6 +240,9 @@ int drawRandomWithWeights(std::vector<double> weights) {
 // Draw randomly nbInd different indices between indMin and indMax
 //
 std::vector<int> drawRandomIndices(int nbInd, int indMin, int indMax) {
+	return drawRandomIndices(rdm0, nbInd, indMin, indMax);
+}
+std::vector<int> drawRandomIndices(std::minstd_rand& rdm, int nbInd, int indMin, int indMax) {
 	//return value
 	std::vector<int> randIndVector;
 
@@ -244,7 +261,7 @@ std::vector<int> drawRandomIndices(int nbInd, int indMin, int indMax) {
 	else {
 		// draw sequentially the indices
 		for (int i=0; i < nbInd; i++) {
-			int randint = rdm0()%indWidth;
+			int randint = rdm()%indWidth;
 			randIndVector.push_back(indVector[randint]);
 			indVector.erase(indVector.begin()+randint);
 			indWidth--;
@@ -305,10 +322,27 @@ int containsWeekend(int start, int end){
 
 // constructor of Timer
 //
-Timer::Timer():isInit_(0), isStarted_(0), isStopped_(0) {
+Timer::Timer(TimerClock clock):clock_(clock), isInit_(0), isStarted_(0), isStopped_(0) {
 	this->init();
 }
 
+// read the current time of the clock
+//
+void Timer::now(timespec& time) const {
+#ifdef __MACH__ // OS X does not have clock_gettime, use clock_get_time
+	clock_serv_t cclock;
+	mach_timespec_t mts;
+	host_get_clock_service(mach_host_self(), CALENDAR_CLOCK, &cclock);
+	clock_get_time(cclock, &mts);
+	mach_port_deallocate(mach_task_self(), cclock);
+	time.tv_sec = mts.tv_sec;
+	time.tv_nsec = mts.tv_nsec;
+
+#else
+	clock_gettime(clock_ == WALL_CLOCK ? CLOCK_MONOTONIC : CLOCK_PROCESS_CPUTIME_ID, &time);
+#endif
+}
+
 // initialize the timer
 //
 void Timer::init()	{
@@ -331,18 +365,7 @@ void Timer::start()  {
 	if (isStarted_)
 		throwError("Trying to start an already started timer!");
 
-#ifdef __MACH__ // OS X does not have clock_gettime, use clock_get_time
-	clock_serv_t cclock;
-	mach_timespec_t mts;
-	host_get_clock_service(mach_host_self(), CALENDAR_CLOCK, &cclock);
-	clock_get_time(cclock, &mts);
-	mach_port_deallocate(mach_task_self(), cclock);
-	cpuInit_.tv_sec = mts.tv_sec;
-	cpuInit_.tv_nsec = mts.tv_nsec;
-
-#else
-	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuInit_);
-#endif
+	now(cpuInit_);
 
 	cpuSinceStart_.tv_sec   = 0;
 	cpuSinceStart_.tv_nsec  = 0;
@@ -361,18 +384,7 @@ void Timer::stop() {
 
 	timespec cpuNow;
 
-#ifdef __MACH__ // OS X does not have clock_gettime, use clock_get_time
-	clock_serv_t cclock;
-	mach_timespec_t mts;
-	host_get_clock_service(mach_host_self(), CALENDAR_CLOCK, &cclock);
-	clock_get_time(cclock, &mts);
-	mach_port_deallocate(mach_task_self(), cclock);
-	cpuNow.tv_sec = mts.tv_sec;
-	cpuNow.tv_nsec = mts.tv_nsec;
-
-#else
-	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuNow);
-#endif
+	now(cpuNow);
 
 	if ( cpuNow.tv_nsec-cpuInit_.tv_nsec < 0 ) {
 		cpuSinceStart_.tv_sec   = cpuNow.tv_sec - cpuInit_.tv_sec - 1;
@@ -403,18 +415,7 @@ const double Timer::dSinceInit() {
 	if (isStarted_) {
 		timespec cpuNow;
 
-#ifdef __MACH__ // OS X does not have clock_gettime, use clock_get_time
-		clock_serv_t cclock;
-		mach_timespec_t mts;
-		host_get_clock_service(mach_host_self(), CALENDAR_CLOCK, &cclock);
-		clock_get_time(cclock, &mts);
-		mach_port_deallocate(mach_task_self(), cclock);
-		cpuNow.tv_sec = mts.tv_sec;
-		cpuNow.tv_nsec = mts.tv_nsec;
-
-#else
-		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuNow);
-#endif
+		now(cpuNow);
 
 		timespec cpuTmp;
 		if ( cpuNow.tv_nsec-cpuInit_.tv_nsec < 0 ) {
@@ -456,18 +457,7 @@ const double Timer::dSinceStart() {
 	else if (isStarted_) {
 		timespec cpuNow;
 
-#ifdef __MACH__ // OS X does not have clock_gettime, use clock_get_time
-		clock_serv_t cclock;
-		mach_timespec_t mts;
-		host_get_clock_service(mach_host_self(), CALENDAR_CLOCK, &cclock);
-		clock_get_time(cclock, &mts);
-		mach_port_deallocate(mach_task_self(), cclock);
-		cpuNow.tv_sec = mts.tv_sec;
-		cpuNow.tv_nsec = mts.tv_nsec;
-
-#else
-		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuNow);
-#endif
+		now(cpuNow);
 
 		if ( cpuNow.tv_nsec-cpuInit_.tv_nsec < 0 ) {
 			cpuSinceStart_.tv_sec   = cpuNow.tv_sec - cpuInit_.tv_sec - 1;
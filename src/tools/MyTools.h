@@ -115,6 +115,12 @@ std::minstd_rand getANewRandomGenerator(int rdmSeed);
 void initializeRandomGenerator();
 void initializeRandomGenerator(int rdmSeed);
 
+// Random generator of the current thread
+// It is used by the random functions below when no generator is given, so the
+// threads never share a random generator. The solvers own their generator and
+// give it explicitly to these functions
+std::minstd_rand& randomGenerator();
+
 
 //round with probability
 int roundWithProbability(double number);
@@ -166,10 +172,12 @@ template<class T> const T& get(const std::vector<T>& v, int i) {
   // Returns an integer with random value (uniform) within [minVal, maxVal]
 //
 int randomInt(int minVal, int maxVal);
+int randomInt(std::minstd_rand& rdm, int minVal, int maxVal);
 
 // Returns a double with random value (uniform) within [minVal, maxVal]
 //
 double randomDouble(double minVal, double maxVal);
+double randomDouble(std::minstd_rand& rdm, double minVal, double maxVal);
 
 // Creates 1D/2D vectors with random values (uniform) within a given range.
 //
@@ -180,10 +188,12 @@ std::vector<std::vector<double> > randomDoubleVector2D(int m, int n, double minV
 // the probability of each index is w_i/sum{w_i}
 //
 int drawRandomWithWeights(std::vector<double> weights);
+int drawRandomWithWeights(std::minstd_rand& rdm, std::vector<double> weights);
 
 // Draw randomly nbInd different indices between indMin and indMax
 //
 std::vector<int> drawRandomIndices(int nbInd, int indMin, int indMax);
+std::vector<int> drawRandomIndices(std::minstd_rand& rdm, int nbInd, int indMin, int indMax);
 
 // Appends the values of v2 to at the end of v1
 //
@@ -209,17 +219,29 @@ int containsWeekend(int startDate, int endDate);
 // Warning : the timer class of the stl to not seem to be portable I observed
 // problems on windows for instance and it requires some precompiler
 // instructions to work on mac
+// The timer measures the cpu time of the process by default; the time limits
+// of solvers that run several threads must be measured on the wall clock,
+// because the cpu time of the process runs as many times faster as there are
+// busy threads
+// (on mac, the timer always measures the wall clock)
 //
+enum TimerClock {CPU_CLOCK, WALL_CLOCK};
+
 class Timer
 {
 public:
 
 	//constructor and destructor
 	//
-	Timer();
+	explicit Timer(TimerClock clock = CPU_CLOCK);
 	~Timer() {}
 
 private:
+	TimerClock clock_;
+
+	// read the current time of the clock
+	void now(timespec& time) const;
+
 	timespec cpuInit_;
 	timespec cpuSinceStart_;
 	timespec cpuSinceInit_;
@@ -283,6 +305,10 @@ public:
 	   // logStream_.open(logName.c_str(), std::fstream::out);
 	}
 
+	// write in an existing stream, e.g. a buffer that is copied in another log
+	// later on
+	explicit LogOutput(std::ostream& stream):pLogStream_(&stream), width_(0), precision_(5) {}
+
 	~LogOutput() {
 		if (!logName_.empty() && pLogStream_)
 			delete pLogStream_;
@@ -1,4 +1,5 @@
 #include "tools/ReadWrite.h"
+#include "tools/InstanceParser.h"
 #include "tools/MyTools.h"
 #include "data/Scenario.h"
 #include "solvers/Solver.h"
@@ -40,254 +41,9 @@ std::map<std::string, RankingStrategy> stringToRankingStrategy =
 // Read the scenario file and store the content in a Scenario instance
 //
 PScenario ReadWrite::readScenario(string fileName) {
-	// open the file
-	std::fstream file;
 	std::cout << "Reading " << fileName << std::endl;
-	file.open(fileName.c_str(), std::fstream::in);
-	if (!file.is_open()) {
-		std::cout << "While trying to read the file " << fileName << std::endl;
-		std::cout << "The input file was not opened properly!" << std::endl;
-
-		throw Tools::myException("The input file was not opened properly!",__LINE__);
-	}
-
-	string title;
-	string strTmp;
-	int intTmp;
-	// declare the attributes that will initialize the Scenario instance
-	//
-	string name;
-	int nbWeeks=-1, nbSkills=-1, nbShifts=-1, nbShiftsType=-1, nbContracts=-1, nbNurses=-1;
-	vector<string> intToSkill, intToShift, intToShiftType, intToContract;
-	map<string,int> skillToInt, shiftToInt, shiftTypeToInt, nurseNameToInt;
-	vector<int> minConsShiftType, maxConsShiftType, nbForbiddenSuccessors, hoursInShift, shiftIDToShiftTypeID;
-        vector2D<int> shiftTypeIDToShiftID;
-	vector2D<int> forbiddenSuccessors;
-	map<string,PConstContract> contracts;
-	vector<PNurse> theNurses;
-
-	bool  foundShift = false;
-
-	// fill the attributes of the scenario structure
-	//
-	while(file.good()){
-		readUntilChar(file, '=', title);
-
-		// Read the name of the scenario
-		//
-		if(strEndsWith(title, "SCENARIO ")){
-			file >> name;
-		}
-
-		// Read the number of weeks in scenario
-		//
-		else if (strEndsWith(title, "WEEKS ")) {
-			file >> nbWeeks;
-		}
-
-		// Read the number of weeks in scenario
-		//
-		else if (strEndsWith(title, "SKILLS ")) {
-			file >> nbSkills;
-			for(int i=0; i<nbSkills; i++){
-				file >> strTmp;
-				intToSkill.push_back(strTmp);
-				skillToInt.insert(pair<string,int>(strTmp,i));
-			}
-		}
-
-		// Read the different shift types and forbidden successions
-		//
-		else if (strEndsWith(title, "SHIFT_TYPES ")) {
-
-			// Number of shifts : Given number + REST_SHIFT
-			file >> intTmp;
-			nbShiftsType = intTmp+1;
-
-			// IMPORTANT : INSERT REST SHIFT !!!!!!
-			// It is given 0 and 99 as bounds so that they never perturbate the cost
-			//
-			intToShiftType.push_back(REST_SHIFT);
-			shiftTypeToInt.insert(pair<string,int>(REST_SHIFT,0));
-			minConsShiftType.push_back(0);
-			maxConsShiftType.push_back(99);
-
-			// Other shift types
-			//
-			for(int i=1; i<nbShiftsType; i++){
-				// Name
-				file >> strTmp;
-				intToShiftType.push_back(strTmp);
-				shiftTypeToInt.insert(pair<string,int>(strTmp,i));
-				readUntilChar(file,'(',strTmp);
-				// Min consecutive
-				file >> intTmp;
-				minConsShiftType.push_back(intTmp);
-				readUntilChar(file, ',', strTmp);
-				// Max consecutive
-				file >> intTmp;
-				maxConsShiftType.push_back(intTmp);
-				readUntilChar(file,'\n',strTmp);
-			}
-
-
-			// Forbidden successions
-			//
-			for(int i=0; i<nbShiftsType; i++){
-				vector<int> v;
-				forbiddenSuccessors.push_back(v);
-				nbForbiddenSuccessors.push_back(0);
-			}
-			while(!strEndsWith(title,"FORBIDDEN_SHIFT_TYPES_SUCCESSIONS"))
-				file >> title;
-			// Reading all lines
-			for(int i=1; i<nbShiftsType; i++){
-				// Which current shift type ?
-				string currentShiftType;
-				file >> currentShiftType;
-				int currentShiftTypeId = shiftTypeToInt.at(currentShiftType);
-				// How many forbidden after it ?
-				file >> intTmp;
-				nbForbiddenSuccessors[currentShiftTypeId] = intTmp;
-				// Which ones are forbidden ?
-				for(int j=0; j<nbForbiddenSuccessors[currentShiftTypeId]; j++){
-					file >> strTmp;
-					forbiddenSuccessors[currentShiftTypeId].push_back(shiftTypeToInt.at(strTmp));
-				}
-				readUntilChar(file,'\n',strTmp);
-
-			}
-		}
-
-		// Read the different shifts
-		//
-		else if (strEndsWith(title, "SHIFTS ")) {
-		  foundShift = true;
-
-			// IMPORTANT : INSERT REST SHIFT !!!!!!
-			//
-			intToShift.push_back(REST_SHIFT);
-			shiftToInt.insert(pair<string,int>(REST_SHIFT,0));
-			hoursInShift.push_back(0);
-			int currentShiftTypeId = shiftTypeToInt.at(REST_SHIFT);
-			shiftIDToShiftTypeID.push_back(currentShiftTypeId);
-
-			shiftTypeIDToShiftID.resize(nbShiftsType);
-			shiftTypeIDToShiftID[0].push_back(0);
-	
-			// Number of shifts 
-			file >> intTmp;
-			nbShifts = intTmp+1;
-
-			// Shifts
-			//
-			for(int i=1; i<nbShifts; i++){
-				// Name
-				file >> strTmp;
-				intToShift.push_back(strTmp);
-				shiftToInt.insert(pair<string,int>(strTmp,i));
-
-				int hours;
-				file >> hours;
-				hoursInShift.push_back(hours);
-
-				string  currentShiftType;
-				file >> currentShiftType;
-
-				int currentShiftTypeId = shiftTypeToInt.at(currentShiftType);
-				shiftIDToShiftTypeID.push_back(currentShiftTypeId);
-				shiftTypeIDToShiftID[currentShiftTypeId].push_back(i);
-			}
-		}
-
-		// Read the different contracts type
-		//
-		else if (strEndsWith(title, "CONTRACTS ")) {
-			file >> intTmp;
-			nbContracts = intTmp;
-			// Read each contract type
-			for(int i=0; i<nbContracts; i++){
-				string contractName;
-				int minDays, maxDays, minConsWork, maxConsWork, minConsRest, maxConsRest, maxWeekends, isTotalWeekend;
-				file >> contractName;
-				readUntilChar(file,'(',strTmp);
-				file >> minDays;
-				readUntilChar(file,',',strTmp);
-				file >> maxDays;
-				readUntilChar(file,'(',strTmp);
-				file >> minConsWork;
-				readUntilChar(file,',',strTmp);
-				file >> maxConsWork;
-				readUntilChar(file,'(',strTmp);
-				file >> minConsRest;
-				readUntilChar(file,',',strTmp);
-				file >> maxConsRest;
-				readUntilChar(file,' ',strTmp);
-				file >> maxWeekends;
-				readUntilChar(file,' ',strTmp);
-				file >> isTotalWeekend;
-				readUntilChar(file,'\n',strTmp);
-
-        PConstContract pContract =
-            std::make_shared<Contract>(i, contractName, minDays, maxDays, minConsWork, maxConsWork,
-                minConsRest, maxConsRest, maxWeekends, isTotalWeekend);
-				contracts[contractName] = pContract;
-				intToContract.push_back(contractName);
-			}
-		}
-
-		// Read all nurses
-		//
-		else if (strEndsWith(title, "NURSES ")) {
-			file >> nbNurses;
-			for(int i=0; i<nbNurses; i++){
-				string nurseName, contractName;
-				int nbSkills;
-				vector<int> skills;
-				// Read everything on the line
-				file >> nurseName;
-				file >> contractName;
-				file >> nbSkills;
-				for(int j=0; j<nbSkills; j++){
-					file >> strTmp;
-					skills.push_back(skillToInt.at(strTmp));
-				}
-				// sort the skill indices before initializing the nurse
-				std::sort (skills.begin(), skills.end());
-
-				theNurses.emplace_back(std::make_shared<Nurse>(i, nurseName, nbSkills, skills, contracts.at(contractName)));
-				nurseNameToInt.insert(pair<string,int>(nurseName,i));
-			}
-
-		}
-	}
-
-	//  to be backward compatible with old style of input file (without the SHIFTS section)
-	//  set default shifts
-	
-	if (!foundShift) {
-	  nbShifts=nbShiftsType;
-    intToShift = intToShiftType;
-    shiftToInt = shiftTypeToInt;
-    shiftTypeIDToShiftID.resize(nbShiftsType);
-    for(int i=0; i<nbShiftsType; i++){
-	    hoursInShift.push_back(1); // 1 as default (could be days, hours, ...)
-	    shiftIDToShiftTypeID.push_back(i);
-      shiftTypeIDToShiftID[i].push_back(i);
-	  }
-	}
-
-	// Check that all fields were initialized before initializing the scenario
-	//
-	if ( nbWeeks==-1 || nbSkills==-1 || nbShifts==-1 || nbContracts==-1 || nbNurses==-1 ) {
-		Tools::throwError("In readScenario: missing fields in the initialization");
-	}
-
-	return std::make_shared<Scenario>(name, nbWeeks, nbSkills, intToSkill, skillToInt, nbShifts,
-			    intToShift, shiftToInt, hoursInShift, shiftIDToShiftTypeID,
-			    nbShiftsType, intToShiftType, shiftTypeToInt, shiftTypeIDToShiftID, 
-			    minConsShiftType, maxConsShiftType, nbForbiddenSuccessors,forbiddenSuccessors,
-			    nbContracts, intToContract, contracts, nbNurses, theNurses, nurseNameToInt) ;
+	InstanceParser parser;
+	return parser.readScenario(fileName);
 }
 
 PDemand ReadWrite::readWeeks(std::vector<std::string> strWeekFiles, PScenario pScenario)
@@ -296,15 +52,20 @@ PDemand ReadWrite::readWeeks(std::vector<std::string> strWeekFiles, PScenario pS
 	PDemand pDemand;
 	PPreferences pPref;
 
+	// the names of the scenario are interned once for all the weeks
+	InstanceParser parser(pScenario);
+
 	for(string strWeekFile: strWeekFiles)
 		if(!pDemand){
-			ReadWrite::readWeek(strWeekFile, pScenario,&pDemand,&pPref);
+			std::cout << "Reading " << strWeekFile << std::endl;
+			parser.readWeek(strWeekFile, &pDemand, &pPref);
 		}
 		else{
 			//load the next week
 			PDemand nextDemand;
 			PPreferences nextPref;
-			ReadWrite::readWeek(strWeekFile, pScenario, &nextDemand, &nextPref);
+			std::cout << "Reading " << strWeekFile << std::endl;
+			parser.readWeek(strWeekFile, &nextDemand, &nextPref);
 			//update the current weeks
 			pDemand->push_back(nextDemand);
 			pPref->push_back(nextPref);
@@ -322,226 +83,18 @@ PDemand ReadWrite::readWeeks(std::vector<std::string> strWeekFiles, PScenario pS
 //
 void ReadWrite::readWeek(std::string strWeekFile, PScenario pScenario,
   PDemand* pDemand, PPreferences* pPref){
-	// open the file
-	std::fstream file;
 	std::cout << "Reading " << strWeekFile << std::endl;
-	file.open(strWeekFile.c_str(), std::fstream::in);
-	if (!file.is_open()) {
-		std::cout << "While trying to read the file " << strWeekFile << std::endl;
-		std::cout << "The input file was not opened properly!" << std::endl;
-		throw Tools::myException("The input file was not opened properly!",__LINE__);
-	}
-
-	string title;
-	string strTmp;
-	int intTmp;
-
-	// declare the attributes to be updated in the PScenario
-	//
-	string weekName;
-	vector3D<int> minWeekDemand;
-	vector3D<int> optWeekDemand;
-
-
-	// fill the attributes when reading the week file
-	//
-	while(file.good()){
-		readUntilOneOfTwoChar(file, '\n', '=', title);
-
-		// Read the name of the week
-		//
-		if(strEndsWith(title, "WEEK_DATA")){
-			file >> weekName;
-		}
-
-		// Read the requirements
-		//
-		else if (strEndsWith(title, "REQUIREMENTS")) {
-			string shiftName, skillName;
-			int shiftId, skillId;
-			// init the vectors
-			Tools::initVector3D(minWeekDemand, 7, pScenario->nbShifts_, pScenario->nbSkills_, 0);
-			Tools::initVector3D(optWeekDemand, 7, pScenario->nbShifts_, pScenario->nbSkills_, 0);
-
-			// Do not take the rest shift into account here (by initialization, requirements already at 0
-			for(int i=1; i<pScenario->nbShifts_; i++){
-				for(int j=0; j<pScenario->nbSkills_; j++){
-					// Read shift and skill
-					file >> shiftName;
-					file >> skillName;
-					shiftId = pScenario->shiftToInt_.at(shiftName);
-					skillId = pScenario->skillToInt_.at(skillName);
-					// For every day in the week, read min and opt values
-					for (int day = 0; day<7; day++){
-						readUntilChar(file,'(',strTmp);
-						file >> intTmp;
-						minWeekDemand[day][shiftId][skillId] = intTmp;
-						readUntilChar(file,',',strTmp);
-						file >> intTmp;
-						optWeekDemand[day][shiftId][skillId] = intTmp;
-					}
-					readUntilChar(file,')',strTmp);
-				}
-			}
-		}
-
-		// Read the shift off requests
-		//
-		else if(strEndsWith(title,"SHIFT_OFF_REQUESTS ")){
-      if(!*pPref)
-        *pPref = std::make_shared<Preferences>(pScenario->nbNurses_, 7, pScenario->nbShifts_);
-			// Temporary vars
-			string nurseName, shift, day, strLevel;
-			int nbShifts, nurseId, dayId;
-			PREF_LEVEL level = WEAK;
-			file >> nbShifts;
-			for (int i=0; i<nbShifts; i++){
-				if(nurseName.empty())
-				  file >> nurseName;
-        nurseId = pScenario->nurseNameToInt_.at(nurseName);
-        nurseName.clear();
-				file >> shift;
-				file >> day;
-        dayId = Tools::dayToInt(day);
-				// in case there is no level defined for the preferences
-        file >> strLevel;
-        try {
-          level = (PREF_LEVEL) std::stoi(strLevel);
-        } catch (std::invalid_argument) { // has read the next line: strLevel contains the next nurse name
-          nurseName = strLevel;
-        }
-
-				if(shift == "Any")
-				  (*pPref)->addDayOff(nurseId, dayId, level);
-				else {
-					// shiftId = pScenario->shiftTypeToInt_.at(shift);
-					int shiftId = pScenario->shiftToInt_.at(shift);
-					(*pPref)->addShiftOff(nurseId, dayId, shiftId, level);
-				}
-			}
-		}
-
-		// Read the shift on requests
-		//
-		else if(strEndsWith(title,"SHIFT_ON_REQUESTS ")){
-			if(!*pPref)
-			  *pPref = std::make_shared<Preferences>(pScenario->nbNurses_, 7, pScenario->nbShifts_);
-			// Temporary vars
-      string nurseName, shift, day, strLevel;
-      int nbShifts, nurseId, dayId;
-      PREF_LEVEL level = WEAK;
-      file >> nbShifts;
-      for (int i=0; i<nbShifts; i++){
-        if(nurseName.empty())
-          file >> nurseName;
-        nurseId = pScenario->nurseNameToInt_.at(nurseName);
-        nurseName.clear();
-        file >> shift;
-        file >> day;
-        dayId = Tools::dayToInt(day);
-        // in case there is no level defined for the preferences
-        file >> strLevel;
-        try {
-          level = (PREF_LEVEL) std::stoi(strLevel);
-        } catch (std::invalid_argument) { // has read the next line: strLevel contains the next nurse name
-          nurseName = strLevel;
-        }
-
-				if(shift == "Any")
-				  (*pPref)->addDayOn(nurseId, dayId, level);
-				else {
-					// shiftId = pScenario->shiftTypeToInt_.at(shift);
-					int shiftId = pScenario->shiftToInt_.at(shift);
-					(*pPref)->addShiftOn(nurseId, dayId, shiftId, level);
-				}
-			}
-		}
-	}
-
-	// Define a new instance of demand
-	*pDemand = std::make_shared<Demand>(7, 0, pScenario->nbShifts_,pScenario->nbSkills_, weekName,
-		minWeekDemand, optWeekDemand);
-  std::cout << "Demand created" << std::endl;
-
-	// Now, add all these objects to the Scenario
-  //  pScenario->linkWithDemand(pDemand);
-  //  pScenario->linkWithPreferences(weekPreferences);
-
-	// return the demand
-  //  return pDemand;
-
+	InstanceParser parser(pScenario);
+	parser.readWeek(strWeekFile, pDemand, pPref);
+	std::cout << "Demand created" << std::endl;
 }
 
 // Read the history file
 //
 void ReadWrite::readHistory(std::string strHistoryFile, PScenario pScenario){
-	// open the file
-	std::fstream file;
 	std::cout << "Reading " << strHistoryFile << std::endl;
-	file.open(strHistoryFile.c_str(), std::fstream::in);
-	if (!file.is_open()) {
-		std::cout << "While trying to read " << strHistoryFile << std::endl;
-		Tools::throwError("The input file was not opened properly!");
-	}
-
-	string title;
-	string strTmp;
-
-	// declare the attributes to be updated in the PScenario
-	//
-	int thisWeek;
-	string weekName;
-	vector<State> initialState;
-
-
-	// fill the attributes of the week structure
-	//
-	while(file.good()){
-		readUntilChar(file,'\n', title);
-
-		// Read the index and name of the week
-		//
-		if(!strcmp(title.c_str(), "HISTORY")){
-			file >> thisWeek;
-			file >> weekName;
-			// Raise exception if it does not match the week previously read !
-			if (strcmp(weekName.c_str(),(pScenario->weekName()).c_str())) {
-				std::cout << "The given history file requires week " << weekName << std::endl;
-				std::cout << " but a different one (" << pScenario->weekName() << ") has been given!" << std::endl;
-				Tools::throwError("History file and week data file do not match!");
-			}
-		}
-
-		// Read each nurse's initial state
-		//
-		else if (strEndsWith(title, "NURSE_HISTORY")) {
-			for(int n=0; n<pScenario->nbNurses_; n++){
-				string nurseName, shiftTypeName;
-				// int nurseId;
-				int shiftTypeId, totalTimeWorked, totalWeekendsWorked, consDaysWorked, consShiftWorked, consRest, consShifts;
-				file >> nurseName;
-				// nurseId = pScenario->nurseNameToInt_.at(nurseName);
-				file >> totalTimeWorked;
-				file >> totalWeekendsWorked;
-				file >> shiftTypeName;
-				shiftTypeId = pScenario->shiftTypeToInt_.at(shiftTypeName);
-				file >> consShiftWorked;
-				file >> consDaysWorked;
-				file >> consRest;
-
-				if(consRest == 0 && consDaysWorked == 0)
-                    Tools::throwError("History of nurse " + nurseName + " is invalid as one must either work or rest.");
-
-				int  shiftID = pScenario->shiftTypeIDToShiftID_[shiftTypeId].front();
-				consShifts = (shiftTypeId == 0) ? consRest : consShiftWorked;
-				State nurseState (0, totalTimeWorked, totalWeekendsWorked,
-						  consDaysWorked, consShifts, consRest, shiftTypeId, shiftID);
-				initialState.push_back(nurseState);
-			}
-		}
-	}
-	pScenario->setThisWeek(thisWeek);
-	pScenario->setInitialState(initialState);
+	InstanceParser parser(pScenario);
+	parser.readHistory(strHistoryFile);
 }
 
 
@@ -692,6 +245,33 @@ std::string ReadWrite::readStochasticSolverOptions(string strOptionFile, Stochas
 		if(!strcmp(title.c_str(), "nGenerationDemandsMax")){
 			file >> options.nGenerationDemandsMax_;
 		}
+		if(!strcmp(title.c_str(), "nEvaluationThreads")){
+			file >> options.nEvaluationThreads_;
+		}
+		if(!strcmp(title.c_str(), "withPipelinedEvaluation")){
+			file >> options.withPipelinedEvaluation_;
+		}
+		if(!strcmp(title.c_str(), "withRacing")){
+			file >> options.withRacing_;
+		}
+		if(!strcmp(title.c_str(), "racingMinDemands")){
+			file >> options.racingMinDemands_;
+		}
+		if(!strcmp(title.c_str(), "racingConfidenceLevel")){
+			file >> options.racingConfidenceLevel_;
+		}
+		if(!strcmp(title.c_str(), "racingMaxEvaluationDemands")){
+			file >> options.racingMaxEvaluationDemands_;
+		}
+		if(!strcmp(title.c_str(), "withEvaluationColumnPool")){
+			file >> options.withEvaluationColumnPool_;
+		}
+		if(!strcmp(title.c_str(), "withGreedyScreening")){
+			file >> options.withGreedyScreening_;
+		}
+		if(!strcmp(title.c_str(), "greedyScreeningTolerance")){
+			file >> options.greedyScreeningTolerance_;
+		}
 	}
 
   std::ifstream fin(strOptionFile.c_str());
@@ -797,7 +377,7 @@ vector<Roster> ReadWrite::readSolutionMultipleWeeks(vector<std::string> strWeekS
 
 		// parse the file until reaching the number of assignments
 		std::size_t found = title.find("ASSIGNMENTS");
-		while (found!=std::string::npos) {
+		while (found==std::string::npos) {
 			readUntilOneOfTwoChar(file, '\n', '=', title);
 			found = title.find("ASSIGNMENTS");
 			if (!file.good()) {
@@ -807,8 +387,7 @@ vector<Roster> ReadWrite::readSolutionMultipleWeeks(vector<std::string> strWeekS
 		readUntilOneOfTwoChar(file, '\n', '\n', title);
 
 		// parse the assignments
-		while (file.good()) {
-			file >> strNurse >> strDay >> strShift >> strSkill;
+		while (file >> strNurse >> strDay >> strShift >> strSkill) {
 			nurse = pScenario->nurseNameToInt_.at(strNurse);
 			day = firstDay+Tools::dayToInt(strDay);
 			shift = pScenario->shiftToInt_.at(strShift);
@@ -850,6 +429,7 @@ void ReadWrite::compareDemands(string inputDir, string logFile) {
   string historyFile = inputDir + "/H0-" + instanceName + "-0.txt";
 
   PScenario pScen = ReadWrite::readScenario(scenFile);
+  InstanceParser parser(pScen);
 
   // Go through all the demand files of the directory
   int coDemand = 0;
@@ -864,7 +444,8 @@ void ReadWrite::compareDemands(string inputDir, string logFile) {
 
     PDemand pDemand;
     PPreferences pPref;
-    ReadWrite::readWeek(filepath, pScen, &pDemand, &pPref);
+    std::cout << "Reading " << filepath << std::endl;
+    parser.readWeek(filepath, &pDemand, &pPref);
 
     logStream << "#####################################\n";
     logStream << "# DEMAND FILE: " << filepath << std::endl;
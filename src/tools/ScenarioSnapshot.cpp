@@ -0,0 +1,502 @@
+/*
+ * ScenarioSnapshot.cpp
+ *
+ *  Created on: October 12, 2020
+ */
+
+#include "tools/ScenarioSnapshot.h"
+#include "tools/InstanceParser.h"
+#include "tools/MyTools.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+using std::string;
+using std::vector;
+using std::map;
+using std::pair;
+
+// first bytes of every snapshot and mark used to detect another byte order
+static const char SNAPSHOT_MAGIC[8] = {'N','S','S','N','A','P','\0','\0'};
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+const uint32_t ScenarioSnapshot::VERSION;
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s e s   S n a p s h o t W r i t e r / R e a d e r
+//
+//  Raw binary encoding of the values: the sizes of the strings and vectors
+//  precede their content
+//
+//-----------------------------------------------------------------------------
+
+class SnapshotWriter {
+
+public:
+	explicit SnapshotWriter(const string& fileName):
+		file_(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc) {
+		if (!file_.is_open()) {
+			std::cout << "While trying to write " << fileName << std::endl;
+			Tools::throwError("The snapshot file was not opened properly!");
+		}
+	}
+
+	template<typename T> void write(const T& val) {
+		file_.write(reinterpret_cast<const char*>(&val), sizeof(T));
+	}
+	void write(const string& str) {
+		write<uint32_t>(str.size());
+		file_.write(str.data(), str.size());
+	}
+	template<typename T> void write(const vector<T>& vec) {
+		write<uint32_t>(vec.size());
+		for (const T& val: vec) write(val);
+	}
+	void writeRaw(const void* pData, size_t size) {
+		file_.write(static_cast<const char*>(pData), size);
+	}
+
+	bool good() const {return file_.good();}
+
+	// close the file, false if some of the content could not be written
+	bool close() {
+		file_.close();
+		return !file_.fail();
+	}
+
+protected:
+	std::ofstream file_;
+};
+
+class SnapshotReader {
+
+public:
+	SnapshotReader(const char* begin, const char* end): pCur_(begin), pEnd_(end) {}
+
+	template<typename T> void read(T& val) {
+		readRaw(&val, sizeof(T));
+	}
+	void read(string& str) {
+		uint32_t size = readSize();
+		checkSize(size);
+		str.assign(pCur_, size);
+		pCur_ += size;
+	}
+	template<typename T> void read(vector<T>& vec) {
+		// every element takes at least one byte: a corrupted size is detected
+		// before allocating the vector
+		uint32_t size = readSize();
+		checkSize(size);
+		vec.resize(size);
+		for (T& val: vec) read(val);
+	}
+	template<typename T> T get() {
+		T val;
+		read(val);
+		return val;
+	}
+	void readRaw(void* pData, size_t size) {
+		checkSize(size);
+		memcpy(pData, pCur_, size);
+		pCur_ += size;
+	}
+
+protected:
+	const char* pCur_;
+	const char* pEnd_;
+
+	uint32_t readSize() {return get<uint32_t>();}
+	void checkSize(size_t size) const {
+		if (size > (size_t) (pEnd_-pCur_)) Tools::throwError("ScenarioSnapshot: the snapshot is truncated!");
+	}
+};
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   S c e n a r i o S n a p s h o t
+//
+//-----------------------------------------------------------------------------
+
+// Write the snapshot of the scenario
+// The snapshot is written in a temporary file that then replaces the previous
+// one, so that a reader never maps a partially written snapshot
+//
+void ScenarioSnapshot::write(PScenario pScenario, const string& fileName, const string& key) {
+	string tmpFileName = fileName+".tmp";
+	SnapshotWriter writer(tmpFileName);
+
+	// header
+	writer.writeRaw(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	writer.write(VERSION);
+	writer.write(SNAPSHOT_BYTE_ORDER);
+	writer.write(key);
+
+	writeScenario(writer, pScenario);
+
+	if (!writer.close()) {
+		std::remove(tmpFileName.c_str());
+		Tools::throwError("ScenarioSnapshot: the snapshot "+fileName+" could not be written!");
+	}
+	if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+		std::remove(tmpFileName.c_str());
+		Tools::throwError("ScenarioSnapshot: the snapshot "+fileName+" could not be replaced!");
+	}
+}
+
+// Read the snapshot and restore the scenario
+//
+PScenario ScenarioSnapshot::read(const string& fileName, const string& key) {
+	struct stat fileStat;
+	if (stat(fileName.c_str(), &fileStat) != 0) return nullptr;
+
+	MappedFile file(fileName);
+	SnapshotReader reader(file.begin(), file.end());
+
+	// check the header: any other version or architecture is ignored
+	char magic[sizeof(SNAPSHOT_MAGIC)];
+	if ((size_t) (file.end()-file.begin()) < sizeof(magic)+2*sizeof(uint32_t)) return nullptr;
+	reader.readRaw(magic, sizeof(magic));
+	if (memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic))) return nullptr;
+	if (reader.get<uint32_t>() != VERSION) return nullptr;
+	if (reader.get<uint32_t>() != SNAPSHOT_BYTE_ORDER) return nullptr;
+
+	// a truncated or corrupted snapshot is ignored as well: the scenario is then
+	// read from the input files
+	try {
+		if (reader.get<string>() != key) return nullptr;
+		return readScenario(reader);
+	}
+	catch (const string& ex) {}
+	catch (const std::exception& ex) {}
+	std::cout << "The snapshot " << fileName << " is invalid: it is ignored" << std::endl;
+	return nullptr;
+}
+
+// Scenario: definition, positions of the nurses, week data and history
+//
+void ScenarioSnapshot::writeScenario(SnapshotWriter& writer, PScenario pScenario) {
+	const Scenario& scen = *pScenario;
+
+	// definition of the scenario
+	writer.write(scen.name_);
+	writer.write(scen.nbWeeks_);
+	writer.write(scen.intToSkill_);
+	writer.write(scen.intToShift_);
+	writer.write(scen.timeDurationToWork_);
+	writer.write(scen.shiftIDToShiftTypeID_);
+	writer.write(scen.intToShiftType_);
+	writer.write(scen.shiftTypeIDToShiftID_);
+	writer.write(scen.minConsShiftType_);
+	writer.write(scen.maxConsShiftType_);
+	writer.write(scen.nbForbiddenSuccessors_);
+	writer.write(scen.forbiddenSuccessors_);
+
+	// contracts
+	writer.write(scen.intToContract_);
+	for (const string& contractName: scen.intToContract_) {
+		PConstContract pContract = scen.contracts_.at(contractName);
+		writer.write(pContract->id_);
+		writer.write(pContract->minTotalShifts_);
+		writer.write(pContract->maxTotalShifts_);
+		writer.write(pContract->minConsDaysWork_);
+		writer.write(pContract->maxConsDaysWork_);
+		writer.write(pContract->minConsDaysOff_);
+		writer.write(pContract->maxConsDaysOff_);
+		writer.write(pContract->maxTotalWeekends_);
+		writer.write(pContract->needCompleteWeekends_);
+	}
+
+	// nurses
+	writer.write<uint32_t>(scen.theNurses_.size());
+	for (PNurse pNurse: scen.theNurses_) {
+		writer.write(pNurse->id_);
+		writer.write(pNurse->name_);
+		writer.write(pNurse->skills_);
+		writer.write(pNurse->pContract_->name_);
+	}
+	writer.write<uint32_t>(scen.nurseNameToInt_.size());
+	for (const pair<const string,int>& p: scen.nurseNameToInt_) {
+		writer.write(p.first);
+		writer.write(p.second);
+	}
+
+	// positions and their connex components (the nurses and the positions are
+	// given by their ids)
+	writer.write(scen.nbPositions_);
+	for (PPosition pPos: scen.pPositions_) {
+		writer.write(pPos->skills_);
+		writer.write(pPos->rank_);
+		writer.write(pPos->skillRarity_);
+		vector<int> below, above;
+		for (PPosition p: pPos->positionsBelow_) below.push_back(p->id_);
+		for (PPosition p: pPos->positionsAbove_) above.push_back(p->id_);
+		writer.write(below);
+		writer.write(above);
+	}
+	auto writeNurseIds = [&writer](const vector2D<PNurse>& nurses) {
+		writer.write<uint32_t>(nurses.size());
+		for (const vector<PNurse>& v: nurses) {
+			vector<int> ids;
+			for (PNurse pNurse: v) ids.push_back(pNurse->id_);
+			writer.write(ids);
+		}
+	};
+	writeNurseIds(scen.nursesPerPosition_);
+	writer.write<uint32_t>(scen.componentsOfConnexPositions_.size());
+	for (const vector<PPosition>& component: scen.componentsOfConnexPositions_) {
+		vector<int> ids;
+		for (PPosition pPos: component) ids.push_back(pPos->id_);
+		writer.write(ids);
+	}
+	writeNurseIds(scen.nursesPerConnexComponentOfPositions_);
+
+	// week data and history
+	writer.write(scen.weekName_);
+	writer.write(scen.thisWeek_);
+	writer.write(scen.nbWeeksLoaded_);
+	writer.write(scen.nbShiftOffRequests_);
+	writer.write(scen.nbShiftOnRequests_);
+	writer.write<uint8_t>(scen.pWeekDemand_ != nullptr);
+	if (scen.pWeekDemand_) writeDemand(writer, scen.pWeekDemand_);
+	writer.write<uint8_t>(scen.pWeekPreferences_ != nullptr);
+	if (scen.pWeekPreferences_) writePreferences(writer, scen.pWeekPreferences_);
+
+	writer.write<uint32_t>(scen.initialState_.size());
+	for (const State& state: scen.initialState_) {
+		writer.write(state.dayId_);
+		writer.write(state.totalTimeWorked_);
+		writer.write(state.totalWeekendsWorked_);
+		writer.write(state.consDaysWorked_);
+		writer.write(state.consShifts_);
+		writer.write(state.consDaysOff_);
+		writer.write(state.shiftType_);
+		writer.write(state.shift_);
+	}
+}
+
+PScenario ScenarioSnapshot::readScenario(SnapshotReader& reader) {
+	// definition of the scenario
+	string name = reader.get<string>();
+	int nbWeeks = reader.get<int>();
+	vector<string> intToSkill, intToShift, intToShiftType, intToContract;
+	vector<int> hoursInShift, shiftIDToShiftTypeID, minConsShiftType, maxConsShiftType, nbForbiddenSuccessors;
+	vector2D<int> shiftTypeIDToShiftID, forbiddenSuccessors;
+	reader.read(intToSkill);
+	reader.read(intToShift);
+	reader.read(hoursInShift);
+	reader.read(shiftIDToShiftTypeID);
+	reader.read(intToShiftType);
+	reader.read(shiftTypeIDToShiftID);
+	reader.read(minConsShiftType);
+	reader.read(maxConsShiftType);
+	reader.read(nbForbiddenSuccessors);
+	reader.read(forbiddenSuccessors);
+
+	map<string,int> skillToInt, shiftToInt, shiftTypeToInt, nurseNameToInt;
+	for (unsigned int i=0; i<intToSkill.size(); i++) skillToInt[intToSkill[i]] = i;
+	for (unsigned int i=0; i<intToShift.size(); i++) shiftToInt[intToShift[i]] = i;
+	for (unsigned int i=0; i<intToShiftType.size(); i++) shiftTypeToInt[intToShiftType[i]] = i;
+
+	// contracts
+	reader.read(intToContract);
+	map<string,PConstContract> contracts;
+	for (const string& contractName: intToContract) {
+		int values[9];
+		for (int& val: values) reader.read(val);
+		contracts[contractName] = std::make_shared<Contract>(values[0], contractName, values[1], values[2],
+			values[3], values[4], values[5], values[6], values[7], values[8]);
+	}
+
+	// nurses
+	vector<PNurse> theNurses(reader.get<uint32_t>());
+	map<int,PNurse> nursesById;
+	for (PNurse& pNurse: theNurses) {
+		int id = reader.get<int>();
+		string nurseName = reader.get<string>();
+		vector<int> skills = reader.get<vector<int>>();
+		PConstContract pContract = contracts.at(reader.get<string>());
+		pNurse = std::make_shared<Nurse>(id, nurseName, skills.size(), skills, pContract);
+		nursesById[id] = pNurse;
+	}
+	uint32_t nbNames = reader.get<uint32_t>();
+	for (uint32_t i=0; i<nbNames; i++) {
+		string nurseName = reader.get<string>();
+		nurseNameToInt[nurseName] = reader.get<int>();
+	}
+
+	// the positions are restored below: the nurses are not preprocessed
+	PScenario pScenario = std::make_shared<Scenario>(name, nbWeeks, intToSkill.size(), intToSkill, skillToInt,
+		intToShift.size(), intToShift, shiftToInt, hoursInShift, shiftIDToShiftTypeID,
+		intToShiftType.size(), intToShiftType, shiftTypeToInt, shiftTypeIDToShiftID,
+		minConsShiftType, maxConsShiftType, nbForbiddenSuccessors, forbiddenSuccessors,
+		intToContract.size(), intToContract, contracts, theNurses.size(), theNurses, nurseNameToInt, false);
+	Scenario& scen = *pScenario;
+
+	// positions and their connex components
+	scen.nbPositions_ = reader.get<int>();
+	vector2D<int> below(scen.nbPositions_), above(scen.nbPositions_);
+	for (int p=0; p<scen.nbPositions_; p++) {
+		vector<int> skills = reader.get<vector<int>>();
+		PPosition pPos = std::make_shared<Position>(p, skills.size(), skills);
+		reader.read(pPos->rank_);
+		reader.read(pPos->skillRarity_);
+		reader.read(below[p]);
+		reader.read(above[p]);
+		scen.pPositions_.push_back(pPos);
+	}
+	for (int p=0; p<scen.nbPositions_; p++) {
+		for (int id: below[p]) scen.pPositions_[p]->addBelow(scen.pPositions_.at(id));
+		for (int id: above[p]) scen.pPositions_[p]->addAbove(scen.pPositions_.at(id));
+	}
+	auto readNurseIds = [&reader, &nursesById](vector2D<PNurse>& nurses) {
+		nurses.resize(reader.get<uint32_t>());
+		for (vector<PNurse>& v: nurses) {
+			for (int id: reader.get<vector<int>>()) v.push_back(nursesById.at(id));
+		}
+	};
+	readNurseIds(scen.nursesPerPosition_);
+	scen.componentsOfConnexPositions_.resize(reader.get<uint32_t>());
+	for (vector<PPosition>& component: scen.componentsOfConnexPositions_) {
+		for (int id: reader.get<vector<int>>()) component.push_back(scen.pPositions_.at(id));
+	}
+	readNurseIds(scen.nursesPerConnexComponentOfPositions_);
+
+	// week data and history
+	reader.read(scen.weekName_);
+	reader.read(scen.thisWeek_);
+	reader.read(scen.nbWeeksLoaded_);
+	reader.read(scen.nbShiftOffRequests_);
+	reader.read(scen.nbShiftOnRequests_);
+	if (reader.get<uint8_t>()) scen.pWeekDemand_ = readDemand(reader);
+	if (reader.get<uint8_t>()) scen.pWeekPreferences_ = readPreferences(reader);
+
+	scen.initialState_.resize(reader.get<uint32_t>());
+	for (State& state: scen.initialState_) {
+		reader.read(state.dayId_);
+		reader.read(state.totalTimeWorked_);
+		reader.read(state.totalWeekendsWorked_);
+		reader.read(state.consDaysWorked_);
+		reader.read(state.consShifts_);
+		reader.read(state.consDaysOff_);
+		reader.read(state.shiftType_);
+		reader.read(state.shift_);
+	}
+
+	return pScenario;
+}
+
+// Demand: tables and aggregated attributes
+//
+void ScenarioSnapshot::writeDemand(SnapshotWriter& writer, PDemand pDemand) {
+	const Demand& demand = *pDemand;
+	writer.write(demand.name_);
+	writer.write(demand.nbDays_);
+	writer.write(demand.firstDay_);
+	writer.write(demand.nbShifts_);
+	writer.write(demand.nbSkills_);
+	for (const DemandTable* pTable: {&demand.minDemand_, &demand.optDemand_}) {
+		writer.write(pTable->nbDays());
+		writer.writeRaw(pTable->data(), pTable->nbDays()*pTable->dayStride()*sizeof(int));
+	}
+
+	writer.write(demand.minTotal_);
+	writer.write(demand.optTotal_);
+	writer.write<uint8_t>(demand.isPreprocessed_);
+	writer.write(demand.minPerSkill_);
+	writer.write(demand.optPerSkill_);
+	writer.write(demand.minPerShift_);
+	writer.write(demand.optPerShift_);
+	writer.write(demand.minPerDay_);
+	writer.write(demand.optPerDay_);
+	writer.write(demand.minHighestPerSkill_);
+	writer.write(demand.optHighestPerSkill_);
+}
+
+PDemand ScenarioSnapshot::readDemand(SnapshotReader& reader) {
+	string name = reader.get<string>();
+	int nbDays = reader.get<int>(), firstDay = reader.get<int>();
+	int nbShifts = reader.get<int>(), nbSkills = reader.get<int>();
+	DemandTable tables[2];
+	for (DemandTable& table: tables) {
+		table = DemandTable(reader.get<int>(), nbShifts, nbSkills);
+		vector<int> values(table.nbDays()*table.dayStride());
+		reader.readRaw(values.data(), values.size()*sizeof(int));
+		for (int day=0, i=0; day<table.nbDays(); day++)
+			for (int sh=0; sh<nbShifts; sh++)
+				for (int sk=0; sk<nbSkills; sk++, i++)
+					table.set(day, sh, sk, values[i]);
+	}
+
+	// the aggregated attributes are restored instead of being preprocessed
+	PDemand pDemand(new Demand(nbDays, firstDay, nbShifts, nbSkills, name, tables[0], tables[1], false));
+	Demand& demand = *pDemand;
+	reader.read(demand.minTotal_);
+	reader.read(demand.optTotal_);
+	demand.isPreprocessed_ = reader.get<uint8_t>();
+	reader.read(demand.minPerSkill_);
+	reader.read(demand.optPerSkill_);
+	reader.read(demand.minPerShift_);
+	reader.read(demand.optPerShift_);
+	reader.read(demand.minPerDay_);
+	reader.read(demand.optPerDay_);
+	reader.read(demand.minHighestPerSkill_);
+	reader.read(demand.optHighestPerSkill_);
+	return pDemand;
+}
+
+// Preferences: sparse index and dense tables of the wishes
+//
+void ScenarioSnapshot::writePreferences(SnapshotWriter& writer, PPreferences pPref) {
+	const Preferences& pref = *pPref;
+	writer.write(pref.nbNurses_);
+	writer.write(pref.nbDays_);
+	writer.write(pref.nbShifts_);
+	for (const map<int, map<int,vector<Wish>>>* pWishes: {&pref.wishesOff_, &pref.wishesOn_}) {
+		writer.write<uint32_t>(pWishes->size());
+		for (const auto& nurseWishes: *pWishes) {
+			writer.write(nurseWishes.first);
+			writer.write<uint32_t>(nurseWishes.second.size());
+			for (const auto& dayWishes: nurseWishes.second) {
+				writer.write(dayWishes.first);
+				writer.write<uint32_t>(dayWishes.second.size());
+				for (const Wish& wish: dayWishes.second) {
+					writer.write(wish.shift);
+					writer.write<int>(wish.level);
+				}
+			}
+		}
+	}
+	writer.write(pref.levelsOff_);
+	writer.write(pref.levelsOn_);
+}
+
+PPreferences ScenarioSnapshot::readPreferences(SnapshotReader& reader) {
+	PPreferences pPref = std::make_shared<Preferences>();
+	Preferences& pref = *pPref;
+	reader.read(pref.nbNurses_);
+	reader.read(pref.nbDays_);
+	reader.read(pref.nbShifts_);
+	for (map<int, map<int,vector<Wish>>>* pWishes: {&pref.wishesOff_, &pref.wishesOn_}) {
+		uint32_t nbNurses = reader.get<uint32_t>();
+		for (uint32_t n=0; n<nbNurses; n++) {
+			map<int,vector<Wish>>& nurseWishes = (*pWishes)[reader.get<int>()];
+			uint32_t nbDays = reader.get<uint32_t>();
+			for (uint32_t d=0; d<nbDays; d++) {
+				vector<Wish>& dayWishes = nurseWishes[reader.get<int>()];
+				dayWishes.resize(reader.get<uint32_t>());
+				for (Wish& wish: dayWishes) {
+					reader.read(wish.shift);
+					wish.level = (PREF_LEVEL) reader.get<int>();
+				}
+			}
+		}
+	}
+	reader.read(pref.levelsOff_);
+	reader.read(pref.levelsOn_);
+	return pPref;
+}
@@ -0,0 +1,62 @@
+/*
+ * ScenarioSnapshot.h
+ *
+ *  Created on: October 12, 2020
+ */
+
+#ifndef __ScenarioSnapshot__
+#define __ScenarioSnapshot__
+
+#include <cstdint>
+#include <string>
+
+#include "data/Demand.h"
+#include "data/Nurse.h"
+#include "data/Scenario.h"
+
+
+class SnapshotWriter;
+class SnapshotReader;
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   S c e n a r i o S n a p s h o t
+//
+//  Binary image of a preprocessed scenario with its demand, its preferences
+//  and the initial states of the nurses
+//  The positions of the nurses, their connex components and the aggregated
+//  attributes of the demand are saved as well, so that a scenario restored
+//  from a snapshot is neither parsed nor preprocessed again
+//  The file is memory-mapped when it is read. It starts with a version and a
+//  byte-order mark: a snapshot is only read back by the same version of the
+//  code on the same architecture, otherwise it is ignored as a truncated or
+//  corrupted snapshot
+//
+//-----------------------------------------------------------------------------
+
+class ScenarioSnapshot {
+
+public:
+	// version of the format, to increment whenever the layout changes
+	static const uint32_t VERSION = 1;
+
+	// write the snapshot of the scenario in a temporary file renamed at the end
+	// the key identifies the input files the scenario was read from
+	static void write(PScenario pScenario, const std::string& fileName, const std::string& key = "");
+
+	// read the snapshot and restore the scenario
+	// return nullptr if there is no valid snapshot for this key and this version
+	static PScenario read(const std::string& fileName, const std::string& key = "");
+
+protected:
+	static void writeScenario(SnapshotWriter& writer, PScenario pScenario);
+	static PScenario readScenario(SnapshotReader& reader);
+
+	static void writeDemand(SnapshotWriter& writer, PDemand pDemand);
+	static PDemand readDemand(SnapshotReader& reader);
+
+	static void writePreferences(SnapshotWriter& writer, PPreferences pPref);
+	static PPreferences readPreferences(SnapshotReader& reader);
+};
+
+#endif
@@ -0,0 +1,340 @@
+/*
+ * SolutionLog.cpp
+ *
+ *  Created on: October 14, 2020
+ */
+
+#include "tools/SolutionLog.h"
+#include "tools/MyTools.h"
+
+#include <cstring>
+
+using std::string;
+using std::vector;
+
+// first bytes of every solution log and mark used to detect another byte order
+static const char SOLUTION_LOG_MAGIC[8] = {'N','S','S','O','L','L','O','G'};
+static const uint32_t SOLUTION_LOG_BYTE_ORDER = 0x01020304;
+
+const uint32_t SolutionLogWriter::VERSION;
+
+
+//-----------------------------------------------------------------------------
+//
+//  Raw binary encoding of the values: the sizes of the strings and vectors
+//  precede their content
+//
+//-----------------------------------------------------------------------------
+
+template<typename T> static void encode(string& buffer, const T& val) {
+	buffer.append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+static void encode(string& buffer, const string& str) {
+	encode<uint32_t>(buffer, str.size());
+	buffer.append(str);
+}
+static void encode(string& buffer, const LNSOperatorStats& stats) {
+	encode<int32_t>(buffer, stats.nbIterations_);
+	encode(buffer, stats.time_);
+	encode(buffer, stats.improvement_);
+}
+template<typename T> static void encode(string& buffer, const vector<T>& vec) {
+	encode<uint32_t>(buffer, vec.size());
+	for (const T& val: vec) encode(buffer, val);
+}
+
+class SolutionLogDecoder {
+
+public:
+	SolutionLogDecoder(const char* begin, const char* end): pCur_(begin), pEnd_(end) {}
+
+	template<typename T> void decode(T& val) {
+		checkSize(sizeof(T));
+		memcpy(&val, pCur_, sizeof(T));
+		pCur_ += sizeof(T);
+	}
+	void decode(string& str) {
+		uint32_t size = get<uint32_t>();
+		checkSize(size);
+		str.assign(pCur_, size);
+		pCur_ += size;
+	}
+	template<typename T> void decode(vector<T>& vec) {
+		vec.resize(get<uint32_t>());
+		for (T& val: vec) decode(val);
+	}
+	void decode(LNSOperatorStats& stats) {
+		decode(stats.nbIterations_);
+		decode(stats.time_);
+		decode(stats.improvement_);
+	}
+	template<typename T> T get() {
+		T val;
+		decode(val);
+		return val;
+	}
+
+	const char* pCur() const {return pCur_;}
+
+	void checkSize(size_t size) const {
+		if (size > (size_t) (pEnd_-pCur_)) Tools::throwError("SolutionLog: the solution log is truncated!");
+	}
+
+protected:
+	const char* pCur_;
+	const char* pEnd_;
+};
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   S o l u t i o n L o g W r i t e r
+//
+//-----------------------------------------------------------------------------
+
+SolutionLogWriter::SolutionLogWriter(const string& fileName, PScenario pScenario, int firstDay, int nbDays):
+	fileName_(fileName), file_(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc),
+	nbNurses_(pScenario->nbNurses_), nbDays_(nbDays) {
+
+	if (!file_.is_open()) {
+		std::cout << "While trying to write " << fileName << std::endl;
+		Tools::throwError("The solution log was not opened properly!");
+	}
+	// the shifts and skills are stored on one byte
+	if (pScenario->nbShifts_ > INT8_MAX || pScenario->nbSkills_ > INT8_MAX) {
+		Tools::throwError("SolutionLogWriter: there are too many shifts or skills to log the solutions!");
+	}
+
+	string header(SOLUTION_LOG_MAGIC, sizeof(SOLUTION_LOG_MAGIC));
+	encode(header, VERSION);
+	encode(header, SOLUTION_LOG_BYTE_ORDER);
+	encode(header, pScenario->name_);
+	for (int val: {nbNurses_, nbDays_, firstDay, pScenario->nbShifts_, pScenario->nbSkills_}) {
+		encode<int32_t>(header, val);
+	}
+	for (int n = 0; n < nbNurses_; n++) encode(header, pScenario->theNurses_[n]->name_);
+	for (const string& shift: pScenario->intToShift_) encode(header, shift);
+	for (const string& skill: pScenario->intToSkill_) encode(header, skill);
+
+	file_.write(header.data(), header.size());
+	file_.flush();
+}
+
+// Append a solution: only the rosters that changed since the previous solution
+// are written, the ids of their nurses first, then their shifts and skills
+//
+void SolutionLogWriter::appendSolution(const vector<Roster>& solution, const CostBreakdown& costs,
+	double time, const string& phase, int iteration) {
+
+	if ((int) solution.size() != nbNurses_) {
+		Tools::throwError("SolutionLogWriter::appendSolution: there is not one roster per nurse in the solution!");
+	}
+
+	vector<int> changedNurses;
+	for (int n = 0; n < nbNurses_; n++) {
+		const Roster& roster = solution[n];
+		bool isChanged = nbSolutions_ == 0;
+		for (int day = 0; day < nbDays_ && !isChanged; day++) {
+			isChanged = roster.shift(day) != shifts_[n][day] || roster.skill(day) != skills_[n][day];
+		}
+		if (isChanged) changedNurses.push_back(n);
+	}
+	if (nbSolutions_ == 0) {
+		Tools::initVector2D(shifts_, nbNurses_, nbDays_, 0);
+		Tools::initVector2D(skills_, nbNurses_, nbDays_, 0);
+	}
+
+	string payload;
+	encode<int32_t>(payload, nbSolutions_);
+	encode(payload, time);
+	encode(payload, phase);
+	encode<int32_t>(payload, iteration);
+	for (int viol: {costs.violMinCover, costs.violReqSkill, costs.violForbiddenSucc}) {
+		encode<int32_t>(payload, viol);
+	}
+	for (double cost: {costs.costOptCover, costs.costTotalDays, costs.costTotalWeekEnds,
+		costs.costConsDays, costs.costConsDaysOff, costs.costConsShifts, costs.costPref,
+		costs.costWeekEnds, costs.totalCost}) {
+		encode(payload, cost);
+	}
+
+	// columns of the changed rosters
+	encode<uint32_t>(payload, changedNurses.size());
+	for (int n: changedNurses) encode<uint32_t>(payload, n);
+	for (int n: changedNurses) {
+		for (int day = 0; day < nbDays_; day++) {
+			shifts_[n][day] = solution[n].shift(day);
+			encode<int8_t>(payload, shifts_[n][day]);
+		}
+	}
+	for (int n: changedNurses) {
+		for (int day = 0; day < nbDays_; day++) {
+			skills_[n][day] = solution[n].skill(day);
+			encode<int8_t>(payload, skills_[n][day]);
+		}
+	}
+
+	writeRecord(LOG_SOLUTION, payload);
+	nbSolutions_++;
+}
+
+// Append the statistics of the run
+//
+void SolutionLogWriter::appendStats(const GlobalStats& stats) {
+	string payload;
+	encode<int32_t>(payload, stats.status_);
+	for (double val: {stats.bestUB_, stats.bestUBInitial_, stats.rootLB_, stats.bestLB_,
+		stats.timeTotal_, stats.timeInitialSol_, stats.timeImproveSol_,
+		stats.timeGenColRoot_, stats.timeGenColMaster_, stats.timeGenSubProblems_}) {
+		encode(payload, val);
+	}
+	for (int val: {stats.itGenColInitial_, stats.itGenColImprove_, stats.nodesBBInitial_,
+		stats.nodesBBImprove_, stats.itInitialSol_, stats.itImproveSol_}) {
+		encode<int32_t>(payload, val);
+	}
+	encode(payload, stats.lnsImprovementValueTotal_);
+	encode<int32_t>(payload, stats.lnsNbIterations_);
+	encode<int32_t>(payload, stats.lnsNbIterationsWithImprovement_);
+	for (const vector<int>* pCounters: {&stats.nbImprovementsWithNursesSelection_,
+		&stats.nbImprovementsWithDaysSelection_, &stats.nbImprovementsWithRepair_}) {
+		encode<uint32_t>(payload, pCounters->size());
+		for (int val: *pCounters) encode<int32_t>(payload, val);
+	}
+	encode(payload, stats.lnsNursesSelectionStats_);
+	encode(payload, stats.lnsDaysSelectionStats_);
+	encode(payload, stats.lnsRepairStats_);
+
+	writeRecord(LOG_STATS, payload);
+}
+
+// Write a record: its type, the size of its content and its content
+//
+void SolutionLogWriter::writeRecord(SolutionLogRecordType type, const string& payload) {
+	string record;
+	encode<uint8_t>(record, type);
+	encode<uint32_t>(record, payload.size());
+	file_.write(record.data(), record.size());
+	file_.write(payload.data(), payload.size());
+	file_.flush();
+
+	if (!file_.good()) {
+		Tools::throwError("SolutionLogWriter: the solution log "+fileName_+" could not be written!");
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   S o l u t i o n L o g R e a d e r
+//
+//-----------------------------------------------------------------------------
+
+SolutionLogReader::SolutionLogReader(const string& fileName):
+	pFile_(new MappedFile(fileName)) {
+
+	SolutionLogDecoder decoder(pFile_->begin(), pFile_->end());
+	char magic[sizeof(SOLUTION_LOG_MAGIC)];
+	decoder.checkSize(sizeof(magic));
+	memcpy(magic, pFile_->begin(), sizeof(magic));
+	if (memcmp(magic, SOLUTION_LOG_MAGIC, sizeof(magic))) {
+		Tools::throwError("SolutionLogReader: "+fileName+" is not a solution log!");
+	}
+	decoder = SolutionLogDecoder(pFile_->begin()+sizeof(magic), pFile_->end());
+	if (decoder.get<uint32_t>() != SolutionLogWriter::VERSION
+		|| decoder.get<uint32_t>() != SOLUTION_LOG_BYTE_ORDER) {
+		Tools::throwError("SolutionLogReader: the solution log "+fileName
+			+" was written by another version or on another architecture!");
+	}
+
+	decoder.decode(scenarioName_);
+	for (int* pVal: {&nbNurses_, &nbDays_, &firstDay_, &nbShifts_, &nbSkills_}) {
+		decoder.decode(*pVal);
+	}
+	nurseNames_.resize(nbNurses_);
+	for (string& name: nurseNames_) decoder.decode(name);
+	shiftNames_.resize(nbShifts_);
+	for (string& name: shiftNames_) decoder.decode(name);
+	skillNames_.resize(nbSkills_);
+	for (string& name: skillNames_) decoder.decode(name);
+
+	Tools::initVector2D(shifts_, nbNurses_, nbDays_, 0);
+	Tools::initVector2D(skills_, nbNurses_, nbDays_, 0);
+	pCur_ = decoder.pCur();
+}
+
+// Read the next record and rebuild the complete solution
+// The records of an unknown type are skipped, and an incomplete record at the
+// end of the log (run interrupted while writing it) is the end of the log
+//
+bool SolutionLogReader::next(SolutionLogRecord& record) {
+	while (pCur_ != pFile_->end()) {
+		size_t sizeLeft = pFile_->end()-pCur_;
+		if (sizeLeft < sizeof(uint8_t)+sizeof(uint32_t)) break;
+		SolutionLogDecoder decoder(pCur_, pFile_->end());
+		uint8_t type = decoder.get<uint8_t>();
+		uint32_t size = decoder.get<uint32_t>();
+		if (size > sizeLeft-sizeof(uint8_t)-sizeof(uint32_t)) break;
+		const char* pPayload = decoder.pCur();
+		pCur_ = pPayload+size;
+		decoder = SolutionLogDecoder(pPayload, pCur_);
+
+		if (type == LOG_SOLUTION) {
+			record.type = LOG_SOLUTION;
+			decoder.decode(record.index);
+			decoder.decode(record.time);
+			decoder.decode(record.phase);
+			decoder.decode(record.iteration);
+			CostBreakdown& costs = record.costs;
+			for (int* pViol: {&costs.violMinCover, &costs.violReqSkill, &costs.violForbiddenSucc}) {
+				decoder.decode(*pViol);
+			}
+			for (double* pCost: {&costs.costOptCover, &costs.costTotalDays, &costs.costTotalWeekEnds,
+				&costs.costConsDays, &costs.costConsDaysOff, &costs.costConsShifts, &costs.costPref,
+				&costs.costWeekEnds, &costs.totalCost}) {
+				decoder.decode(*pCost);
+			}
+
+			vector<int> changedNurses(decoder.get<uint32_t>());
+			for (int& n: changedNurses) {
+				n = decoder.get<uint32_t>();
+				if (n < 0 || n >= nbNurses_) Tools::throwError("SolutionLogReader: unknown nurse in the solution log!");
+			}
+			decoder.checkSize(2*changedNurses.size()*nbDays_);
+			for (int n: changedNurses) {
+				for (int day = 0; day < nbDays_; day++) shifts_[n][day] = decoder.get<int8_t>();
+			}
+			for (int n: changedNurses) {
+				for (int day = 0; day < nbDays_; day++) skills_[n][day] = decoder.get<int8_t>();
+			}
+			record.shifts = shifts_;
+			record.skills = skills_;
+			return true;
+		}
+		else if (type == LOG_STATS) {
+			record.type = LOG_STATS;
+			GlobalStats& stats = record.stats;
+			stats.status_ = (Status) decoder.get<int32_t>();
+			for (double* pVal: {&stats.bestUB_, &stats.bestUBInitial_, &stats.rootLB_, &stats.bestLB_,
+				&stats.timeTotal_, &stats.timeInitialSol_, &stats.timeImproveSol_,
+				&stats.timeGenColRoot_, &stats.timeGenColMaster_, &stats.timeGenSubProblems_}) {
+				decoder.decode(*pVal);
+			}
+			for (int* pVal: {&stats.itGenColInitial_, &stats.itGenColImprove_, &stats.nodesBBInitial_,
+				&stats.nodesBBImprove_, &stats.itInitialSol_, &stats.itImproveSol_}) {
+				decoder.decode(*pVal);
+			}
+			decoder.decode(stats.lnsImprovementValueTotal_);
+			decoder.decode(stats.lnsNbIterations_);
+			decoder.decode(stats.lnsNbIterationsWithImprovement_);
+			decoder.decode(stats.nbImprovementsWithNursesSelection_);
+			decoder.decode(stats.nbImprovementsWithDaysSelection_);
+			decoder.decode(stats.nbImprovementsWithRepair_);
+			decoder.decode(stats.lnsNursesSelectionStats_);
+			decoder.decode(stats.lnsDaysSelectionStats_);
+			decoder.decode(stats.lnsRepairStats_);
+			return true;
+		}
+	}
+	pCur_ = pFile_->end();
+	return false;
+}
@@ -0,0 +1,131 @@
+/*
+ * SolutionLog.h
+ *
+ *  Created on: October 14, 2020
+ */
+
+#ifndef __SolutionLog__
+#define __SolutionLog__
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "data/Roster.h"
+#include "data/Scenario.h"
+#include "solvers/Solver.h"
+#include "tools/GlobalStats.h"
+#include "tools/InstanceParser.h"
+
+
+// Types of the records of a solution log
+//
+enum SolutionLogRecordType {LOG_SOLUTION = 1, LOG_STATS = 2};
+
+//-----------------------------------------------------------------------------
+//
+//  S t r u c t   S o l u t i o n L o g R e c o r d
+//
+//  Content of one record of a solution log: a solution with its cost
+//  breakdown, or the statistics of the run
+//
+//-----------------------------------------------------------------------------
+
+struct SolutionLogRecord {
+	SolutionLogRecordType type = LOG_SOLUTION;
+
+	// solution: rank in the log, cpu time, phase of the solution process and
+	// iteration of this phase when the solution was found
+	int index = 0;
+	double time = 0.0;
+	std::string phase;
+	int iteration = 0;
+	CostBreakdown costs;
+
+	// complete solution: shift and skill of each nurse on each day
+	vector2D<int> shifts, skills;
+
+	// statistics
+	GlobalStats stats;
+};
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   S o l u t i o n L o g W r i t e r
+//
+//  Compact binary log of the solutions of a run, to follow the incumbents of
+//  the LNS without writing the text files of the validator at each of them
+//  The header gives the dimensions and the names of the scenario, then each
+//  record is appended and flushed, so that the log of an interrupted run can
+//  still be read
+//  A solution only stores the nurses whose roster changed since the previous
+//  one, with a column of shifts followed by a column of skills on one byte
+//  per day
+//
+//-----------------------------------------------------------------------------
+
+class SolutionLogWriter {
+
+public:
+	// version of the format, to increment whenever the layout changes
+	static const uint32_t VERSION = 1;
+
+	// the file is truncated and starts with the header of the scenario
+	SolutionLogWriter(const std::string& fileName, PScenario pScenario, int firstDay, int nbDays);
+
+	// append a solution, i.e. one roster per nurse
+	void appendSolution(const std::vector<Roster>& solution, const CostBreakdown& costs,
+		double time, const std::string& phase, int iteration = 0);
+
+	// append the statistics of the run
+	void appendStats(const GlobalStats& stats);
+
+	int nbSolutions() const {return nbSolutions_;}
+
+protected:
+	std::string fileName_;
+	std::ofstream file_;
+	int nbNurses_, nbDays_;
+
+	// solution of the previous record
+	int nbSolutions_ = 0;
+	vector2D<int> shifts_, skills_;
+
+	// write a record and flush the file
+	void writeRecord(SolutionLogRecordType type, const std::string& payload);
+};
+
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   S o l u t i o n L o g R e a d e r
+//
+//  Memory-mapped reader of a solution log: each record is returned with the
+//  complete solution rebuilt from the previous ones
+//
+//-----------------------------------------------------------------------------
+
+class SolutionLogReader {
+
+public:
+	explicit SolutionLogReader(const std::string& fileName);
+
+	// read the next record, false at the end of the log or at an incomplete
+	// record at its end
+	bool next(SolutionLogRecord& record);
+
+	// header of the log
+	std::string scenarioName_;
+	int nbNurses_ = 0, nbDays_ = 0, firstDay_ = 0, nbShifts_ = 0, nbSkills_ = 0;
+	std::vector<std::string> nurseNames_, shiftNames_, skillNames_;
+
+protected:
+	std::unique_ptr<MappedFile> pFile_;
+	const char* pCur_;
+
+	// solution of the previous record
+	vector2D<int> shifts_, skills_;
+};
+
+#endif